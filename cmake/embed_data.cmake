@@ -0,0 +1,198 @@
+# Generates css/embedded_data.hpp: constexpr tables of the default reference
+# data in data/, so the library runs without locating or parsing any file.
+#
+# Run at build time:
+#   cmake -DDATA_DIR=<repo>/data -DOUTPUT=<build>/generated/css/embedded_data.hpp -P embed_data.cmake
+
+cmake_policy(VERSION 3.15)
+
+if(NOT DATA_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "embed_data.cmake: DATA_DIR and OUTPUT are required")
+endif()
+
+# Rows of a CSV file without its header, each row's fields joined with '|'.
+# Lines starting with '#' are comments.
+function(read_csv path expected_fields out_rows)
+    if(NOT EXISTS "${path}")
+        message(FATAL_ERROR "embed_data.cmake: missing ${path}")
+    endif()
+    file(STRINGS "${path}" lines)
+    list(FILTER lines EXCLUDE REGEX "^#")
+    list(REMOVE_AT lines 0)
+    set(rows "")
+    foreach(line IN LISTS lines)
+        string(STRIP "${line}" line)
+        if(line STREQUAL "")
+            continue()
+        endif()
+        string(REPLACE "," ";" fields "${line}")
+        list(LENGTH fields n)
+        if(NOT n EQUAL expected_fields)
+            message(FATAL_ERROR "embed_data.cmake: expected ${expected_fields} fields in ${path}: ${line}")
+        endif()
+        string(REPLACE ";" "|" packed "${fields}")
+        list(APPEND rows "${packed}")
+    endforeach()
+    set(${out_rows} "${rows}" PARENT_SCOPE)
+endfunction()
+
+# Numeric CSV field as a float literal.
+function(float_literal value out)
+    string(STRIP "${value}" value)
+    if(NOT value MATCHES "[.eE]")
+        set(value "${value}.0")
+    endif()
+    set(${out} "${value}f" PARENT_SCOPE)
+endfunction()
+
+# ColorChecker 24 reference (index,name,R,G,B in linear sRGB).
+read_csv("${DATA_DIR}/colorchecker_24_D65.csv" 5 patches)
+set(patch_rows "")
+set(patch_count 0)
+foreach(row IN LISTS patches)
+    string(REPLACE "|" ";" f "${row}")
+    list(GET f 0 index)
+    list(GET f 1 name)
+    list(GET f 2 r)
+    list(GET f 3 g)
+    list(GET f 4 b)
+    float_literal("${r}" r)
+    float_literal("${g}" g)
+    float_literal("${b}" b)
+    string(APPEND patch_rows "        { ${index}, \"${name}\", ${r}, ${g}, ${b} },\n")
+    math(EXPR patch_count "${patch_count} + 1")
+endforeach()
+
+# CIE daylight basis (wavelength_nm,S0,S1,S2), uniformly spaced.
+read_csv("${DATA_DIR}/cie_daylight_basis.csv" 4 basis)
+set(basis_rows "")
+set(basis_count 0)
+foreach(row IN LISTS basis)
+    string(REPLACE "|" ";" f "${row}")
+    list(GET f 0 wl)
+    list(GET f 1 s0)
+    list(GET f 2 s1)
+    list(GET f 3 s2)
+    if(basis_count EQUAL 0)
+        set(basis_start "${wl}")
+    elseif(basis_count EQUAL 1)
+        math(EXPR basis_step "${wl} - ${basis_start}")
+    endif()
+    float_literal("${s0}" s0)
+    float_literal("${s1}" s1)
+    float_literal("${s2}" s2)
+    string(APPEND basis_rows "        { ${s0}, ${s1}, ${s2} }, // ${wl}\n")
+    math(EXPR basis_count "${basis_count} + 1")
+endforeach()
+float_literal("${basis_start}" basis_start)
+float_literal("${basis_step}" basis_step)
+
+# Tabulated illuminant family (wavelength_nm,<member>,...), uniformly spaced.
+# Sets <prefix>_members (quoted, comma separated), _count, _bands, _start,
+# _step and _rows in the caller's scope.
+function(read_spd_table path prefix)
+    if(NOT EXISTS "${path}")
+        message(FATAL_ERROR "embed_data.cmake: missing ${path}")
+    endif()
+    file(STRINGS "${path}" lines)
+    list(FILTER lines EXCLUDE REGEX "^#")
+    list(GET lines 0 header)
+    string(STRIP "${header}" header)
+    string(REPLACE "," ";" names "${header}")
+    list(LENGTH names fields)
+    list(REMOVE_AT names 0)
+    math(EXPR count "${fields} - 1")
+    set(members "")
+    foreach(name IN LISTS names)
+        if(NOT members STREQUAL "")
+            string(APPEND members ", ")
+        endif()
+        string(APPEND members "\"${name}\"")
+    endforeach()
+
+    read_csv("${path}" ${fields} table)
+    set(rows "")
+    set(bands 0)
+    foreach(row IN LISTS table)
+        string(REPLACE "|" ";" f "${row}")
+        list(GET f 0 wl)
+        list(REMOVE_AT f 0)
+        if(bands EQUAL 0)
+            set(start "${wl}")
+        elseif(bands EQUAL 1)
+            math(EXPR step "${wl} - ${start}")
+        endif()
+        set(values "")
+        foreach(v IN LISTS f)
+            float_literal("${v}" v)
+            if(NOT values STREQUAL "")
+                string(APPEND values ", ")
+            endif()
+            string(APPEND values "${v}")
+        endforeach()
+        string(APPEND rows "        { ${values} }, // ${wl}\n")
+        math(EXPR bands "${bands} + 1")
+    endforeach()
+    float_literal("${start}" start)
+    float_literal("${step}" step)
+
+    set(${prefix}_members "${members}" PARENT_SCOPE)
+    set(${prefix}_count ${count} PARENT_SCOPE)
+    set(${prefix}_bands ${bands} PARENT_SCOPE)
+    set(${prefix}_start ${start} PARENT_SCOPE)
+    set(${prefix}_step ${step} PARENT_SCOPE)
+    set(${prefix}_rows "${rows}" PARENT_SCOPE)
+endfunction()
+
+# CIE F1-F12 (CIE 15:2004 Table T.6) and the synthetic LED model LEDm-B1-B5.
+read_spd_table("${DATA_DIR}/cie_f_series.csv" fseries)
+read_spd_table("${DATA_DIR}/led_model.csv" ledmodel)
+
+set(content "// Generated by cmake/embed_data.cmake from data/. Do not edit.
+#pragma once
+
+namespace css::embedded
+{
+    struct PatchRow
+    {
+        int index;
+        const char* name;
+        float r, g, b; // linear sRGB
+    };
+
+    // data/colorchecker_24_D65.csv
+    inline constexpr int kColorChecker24Count = ${patch_count};
+    inline constexpr PatchRow kColorChecker24D65[${patch_count}] = {
+${patch_rows}    };
+
+    // data/cie_daylight_basis.csv: S0, S1, S2
+    inline constexpr int kDaylightBasisBands = ${basis_count};
+    inline constexpr float kDaylightBasisStart = ${basis_start};
+    inline constexpr float kDaylightBasisStep = ${basis_step};
+    inline constexpr float kDaylightBasis[${basis_count}][3] = {
+${basis_rows}    };
+
+    // data/cie_f_series.csv: one column per member
+    inline constexpr int kFSeriesCount = ${fseries_count};
+    inline constexpr const char* kFSeriesNames[${fseries_count}] = { ${fseries_members} };
+    inline constexpr int kFSeriesBands = ${fseries_bands};
+    inline constexpr float kFSeriesStart = ${fseries_start};
+    inline constexpr float kFSeriesStep = ${fseries_step};
+    inline constexpr float kFSeries[${fseries_bands}][${fseries_count}] = {
+${fseries_rows}    };
+
+    // data/led_model.csv: one column per member
+    inline constexpr int kLedModelCount = ${ledmodel_count};
+    inline constexpr const char* kLedModelNames[${ledmodel_count}] = { ${ledmodel_members} };
+    inline constexpr int kLedModelBands = ${ledmodel_bands};
+    inline constexpr float kLedModelStart = ${ledmodel_start};
+    inline constexpr float kLedModelStep = ${ledmodel_step};
+    inline constexpr float kLedModel[${ledmodel_bands}][${ledmodel_count}] = {
+${ledmodel_rows}    };
+} // namespace css::embedded
+")
+
+# Only touch the header when it changes, so unrelated data edits don't rebuild.
+file(WRITE "${OUTPUT}.tmp" "${content}")
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
@@ -3,6 +3,9 @@
 #include <vector>
 #include <Eigen/Core>
 
+#include "css/profile.hpp"
+#include "css/tikhonov.hpp"
+
 namespace css::calib
 {
     struct CalibResult
@@ -10,7 +13,13 @@ namespace css::calib
         Eigen::Matrix3f colorMatrix = Eigen::Matrix3f::Identity(); // camera RGB -> target (linear sRGB)
         Eigen::Vector3f whiteBalance = Eigen::Vector3f::Ones();    // per-channel gains
         float rmsError = 0.0f;
+        float regularization = 0.0f;                               // lambda used by the solve
         std::vector<float> perPatchError;                          // same order as inputs
+
+        // Root-polynomial part, as in profile::Profile.
+        profile::Model model = profile::Model::Linear;
+        Eigen::Matrix<float, 3, profile::kMaxRootTerms> rootMatrix =
+            Eigen::Matrix<float, 3, profile::kMaxRootTerms>::Zero();
     };
 
     /**
@@ -25,10 +34,25 @@ namespace css::calib
      *
      * measured  - camera-space linear RGB samples (after applying white balance, if desired)
      * reference - target-space linear RGB reference values
+     * model     - root-polynomial models fit a 3x6 / 3x13 map over
+     *             profile::rootTerms() with the same ridge penalty; they
+     *             need more patches than terms to be worth it
      */
     CalibResult solveColorMatrix(const std::vector<Eigen::Vector3f>& measured,
                                  const std::vector<Eigen::Vector3f>& reference,
                                  bool estimateWb = true,
-                                 float regularization = 1e-4f);
+                                 float regularization = 1e-4f,
+                                 profile::Model model = profile::Model::Linear);
+
+    /**
+     * Same as above, with lambda chosen automatically on the Tikhonov path of
+     * the white-balanced system (GCV or L-curve corner). The chosen value is
+     * reported in CalibResult::regularization.
+     */
+    CalibResult solveColorMatrix(const std::vector<Eigen::Vector3f>& measured,
+                                 const std::vector<Eigen::Vector3f>& reference,
+                                 bool estimateWb,
+                                 tikhonov::LambdaSelection selection,
+                                 profile::Model model = profile::Model::Linear);
 } // namespace css::calib
 
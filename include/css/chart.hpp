@@ -25,6 +25,8 @@ namespace css::chart
         int index = 0;          // 0..(rows*cols-1), row-major
         cv::Vec3f meanBgr{};    // mean of sampled pixels
         cv::Vec3f medianBgr{};  // median (approximate) of sampled pixels
+        cv::Vec3f stdBgr{};     // standard deviation of sampled pixels
+        int pixelCount = 0;     // number of sampled pixels
     };
 
     /**
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/profile.hpp"
+#include "css/transfer.hpp"
+
+namespace css::kernel
+{
+    enum class Isa
+    {
+        Scalar,
+        SSE42,   // 4 pixels per iteration
+        AVX2,    // 8 pixels per iteration, FMA
+        AVX512   // 16 pixels per iteration, FMA
+    };
+
+    /**
+     * Widest instruction set that is both compiled in and supported by this
+     * CPU, detected once. The CAMSPEC_ISA environment variable
+     * (scalar|sse4.2|avx2|avx512) caps it, e.g. to compare kernels.
+     */
+    Isa detectIsa();
+    const char* isaName(Isa isa);
+
+    /**
+     * Camera -> target transform for interleaved BGR float rows, with the
+     * white balance folded into the matrix and the channel order reversed,
+     * so a pixel costs one 3x3 product: out = matrix * in. Root-polynomial
+     * profiles add roots * profile::rootTerms(in as RGB); each term is a
+     * monomial of degree one, so the white balance folds into its column.
+     */
+    struct ColorTransform
+    {
+        Eigen::Matrix3f matrix = Eigen::Matrix3f::Identity(); // BGR -> BGR
+        transfer::TransferFunction encoding{transfer::Curve::Linear};
+
+        profile::Model model = profile::Model::Linear;
+        Eigen::Matrix<float, 3, profile::kMaxRootTerms> roots =
+            Eigen::Matrix<float, 3, profile::kMaxRootTerms>::Zero(); // root terms -> BGR
+
+        // Table for the scalar path; without it the scalar path evaluates
+        // transfer::encodeReference().
+        std::shared_ptr<const transfer::EncodeLut> lut;
+    };
+
+    /** M * diag(wb) of `prof`, in BGR order, followed by `encoding`. */
+    ColorTransform makeTransform(const profile::Profile& prof, const transfer::TransferFunction& encoding);
+
+    /**
+     * Transform `count` interleaved BGR pixels. `in` and `out` may be the same
+     * buffer. SIMD kernels deinterleave 4/8/16 pixels into planes, run the
+     * matrix and the transfer curve as minimax polynomials (Cephes log/exp),
+     * and reinterleave; the ragged tail goes through the same kernel on a
+     * padded copy, so a pixel's result never depends on its position in the
+     * row. Curve errors stay below 1e-6 against transfer::encodeReference()
+     * (PQ takes its 78.8th power from a log1p of the base, so float rounding
+     * is not amplified); half a 16-bit LSB is 7.6e-6. The scalar path uses
+     * transfer::EncodeLut, as does SSE4.2 for every curve but HLG (where its
+     * polynomials still win). Each model order has its own kernel, unrolled
+     * at compile time: the linear one is the plain 3x3 product, rp2 adds
+     * three square roots per pixel and rp3 three cube roots on top (one
+     * log and exp each). `isa` is capped at detectIsa().
+     */
+    void applyRow(const ColorTransform& t, const float* in, float* out, size_t count,
+                  Isa isa = detectIsa());
+
+    /**
+     * applyRow() quantized to 16 / 8 bits: clamp to [0, 1], scale to 65535 /
+     * 255, round to nearest. The row runs through the float kernel in chunks
+     * that stay in L1, so no float output is ever written to memory; the
+     * codes equal quantizing the float result. `out` must not alias `in`.
+     */
+    void applyRow(const ColorTransform& t, const float* in, std::uint16_t* out, size_t count,
+                  Isa isa = detectIsa());
+    void applyRow(const ColorTransform& t, const float* in, std::uint8_t* out, size_t count,
+                  Isa isa = detectIsa());
+
+    /**
+     * Fixed-point transform for black-subtracted uint16 BGR rows, for
+     * display-referred output where float precision is not needed. Inputs
+     * clip at the white level; the matrix (white balance and 1 / whiteLevel
+     * folded in) takes them straight to 16-bit linear codes with Q`fracBits`
+     * int16 coefficients, as many fractional bits as keep every 32-bit sum
+     * from overflowing. Linear codes land within about 10 (of 65535) of
+     * the float path; `lut` maps them to output codes.
+     */
+    struct FixedTransform
+    {
+        std::int16_t matrix[9] = {};  // BGR -> BGR, row-major
+        std::uint16_t inputMax = 65535;
+        int inputShift = 0;           // min(input, inputMax) >> inputShift fits a signed 16-bit lane
+        int fracBits = 1;
+        int outputBits = 16;          // 16 or 8
+
+        // 65536 output codes; null for linear 16-bit output.
+        std::shared_ptr<const std::vector<std::uint16_t>> lut;
+    };
+
+    /**
+     * `whiteLevel`: input code of linear 1.0 (DNG white minus black level).
+     * Linear profiles only; root-polynomial ones throw std::runtime_error.
+     */
+    FixedTransform makeFixedTransform(const profile::Profile& prof, const transfer::TransferFunction& encoding,
+                                      float whiteLevel, int outputBits);
+
+    /** Fixed-point version of a float transform (its matrix and encoding); linear models only. */
+    FixedTransform makeFixedTransform(const ColorTransform& transform, float whiteLevel, int outputBits);
+
+    /**
+     * Transform `count` interleaved uint16 BGR pixels. SSE4.2 and AVX2 run
+     * 8 / 16 pixels per iteration, twice the float lanes, with pmaddwd
+     * multiply-accumulates (AVX-512 uses the AVX2 kernel); the table lookup
+     * is scalar. Every ISA gives identical codes. The 16-bit overload needs
+     * t.outputBits == 16 and may work in place, the 8-bit one t.outputBits
+     * == 8; otherwise std::runtime_error.
+     */
+    void applyRowFixed(const FixedTransform& t, const std::uint16_t* in, std::uint16_t* out, size_t count,
+                       Isa isa = detectIsa());
+    void applyRowFixed(const FixedTransform& t, const std::uint16_t* in, std::uint8_t* out, size_t count,
+                       Isa isa = detectIsa());
+} // namespace css::kernel
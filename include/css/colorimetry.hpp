@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "css/grid.hpp"
+
+namespace css::colorimetry
+{
+    /** Sampling of the built-in color-matching functions (380-780nm @ 10nm). */
+    spectral::SpectralGrid cmfGrid();
+
+    /**
+     * CIE 1931 2° standard observer x̄, ȳ, z̄ as a (grid.count x 3) matrix,
+     * resampled from the built-in 10nm table.
+     */
+    Eigen::MatrixXf cie1931(const spectral::SpectralGrid& grid = {});
+
+    /** Linear sRGB (D65 white) from CIE XYZ, IEC 61966-2-1. */
+    Eigen::Matrix3f xyzToLinearSrgb();
+
+    /** XYZ of a perfect reflector under `spd`, scaled to Y = 1. */
+    Eigen::Vector3f whitePoint(const Eigen::VectorXf& spd, const spectral::SpectralGrid& grid = {});
+
+    /** XYZ (Y = 1) of the D65 white of sRGB and the D50 white of the ICC PCS. */
+    Eigen::Vector3f d65White();
+    Eigen::Vector3f d50White();
+
+    /** Bradford chromatic adaptation taking XYZ under `srcWhite` to `dstWhite`. */
+    Eigen::Matrix3f bradfordAdaptation(const Eigen::Vector3f& srcWhite, const Eigen::Vector3f& dstWhite);
+
+    /** CIE 1931 xy chromaticity of an XYZ triple. */
+    Eigen::Vector2f chromaticity(const Eigen::Vector3f& xyz);
+} // namespace css::colorimetry
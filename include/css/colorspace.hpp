@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/profile.hpp"
+
+namespace css::colorspace
+{
+    /**
+     * A linear RGB (or XYZ) color space: its white and the matrices to and
+     * from CIE XYZ (Y = 1 at white). Built from xy primaries per SMPTE RP 177;
+     * linear_srgb keeps colorimetry::xyzToLinearSrgb() exactly, so profiles
+     * fitted against it round-trip unchanged.
+     */
+    struct ColorSpace
+    {
+        std::string name;
+        Eigen::Vector3f white = Eigen::Vector3f::Ones();     // XYZ, Y = 1
+        Eigen::Matrix3f toXyz = Eigen::Matrix3f::Identity();
+        Eigen::Matrix3f fromXyz = Eigen::Matrix3f::Identity();
+    };
+
+    /** XYZ (Y = 1) of chromaticity xy. */
+    Eigen::Vector3f whiteFromXy(const Eigen::Vector2f& xy);
+
+    /** Normalized primary matrix: RGB -> XYZ for xy primaries and an XYZ white. */
+    Eigen::Matrix3f primariesToXyz(const Eigen::Vector2f& red, const Eigen::Vector2f& green,
+                                   const Eigen::Vector2f& blue, const Eigen::Vector3f& white);
+
+    /**
+     * Built-in spaces: linear_srgb (Rec.709 primaries), linear_rec2020,
+     * linear_p3 (Display P3), aces_ap0 (ACES2065-1), aces_ap1 (ACEScg),
+     * xyz_d65 and xyz_d50. Unknown names throw std::runtime_error.
+     */
+    ColorSpace find(const std::string& name);
+    std::vector<std::string> names();
+
+    enum class Cat
+    {
+        None,     // no adaptation: XYZ passes through between whites
+        Bradford, // Lam 1985, as in colorimetry::bradfordAdaptation
+        Cat16     // Li et al. 2017 (CAM16), complete adaptation
+    };
+
+    /** "none", "bradford", "cat16"; parseCat throws std::runtime_error on anything else. */
+    Cat parseCat(const std::string& name);
+    const char* catName(Cat cat);
+
+    /** von Kries transform taking XYZ under `srcWhite` to `dstWhite`. */
+    Eigen::Matrix3f adaptation(const Eigen::Vector3f& srcWhite, const Eigen::Vector3f& dstWhite, Cat cat);
+
+    /** Linear RGB of `from` -> linear RGB of `to`; the identity for the same space. */
+    Eigen::Matrix3f conversion(const ColorSpace& from, const ColorSpace& to, Cat cat = Cat::Bradford);
+
+    /**
+     * `prof` re-targeted to `space`: the conversion from its targetColorSpace
+     * (linear_srgb if empty) is multiplied into the color matrix and the
+     * root-polynomial coefficients, so every apply path (float, fixed point,
+     * LUT) renders straight into `space` for the cost of linear sRGB.
+     * Throws std::runtime_error for an unknown space.
+     */
+    profile::Profile retarget(const profile::Profile& prof, const std::string& space, Cat cat = Cat::Bradford);
+} // namespace css::colorspace
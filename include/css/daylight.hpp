@@ -2,6 +2,8 @@
 
 #include <Eigen/Core>
 
+#include "css/grid.hpp"
+
 namespace css::daylight
 {
     /**
@@ -9,11 +11,27 @@ namespace css::daylight
      * Uses the Judd et al. basis vectors (S0, S1, S2).
      * Output range is 400nm - 720nm @ 10nm steps (33 values),
      * matching the project's standard spectral range.
+     *
+     * Daylight-locus SPDs (and their basis weights) are tabulated once over a
+     * CCT range; lookups interpolate linearly between entries and fall back to
+     * the closed form outside the table or off the locus.
      */
     class DaylightGenerator
     {
     public:
-        DaylightGenerator();
+        static constexpr int kNumBands = 33;
+
+        /** Sampling of the built-in basis and every generated SPD (400-720nm @ 10nm). */
+        static spectral::SpectralGrid grid() { return spectral::SpectralGrid::standard(); }
+
+        /**
+         * @param cctMin  First tabulated CCT in Kelvin
+         * @param cctMax  Last tabulated CCT (rounded down to a whole step)
+         * @param cctStep Table spacing in Kelvin
+         */
+        explicit DaylightGenerator(float cctMin = 4000.0f,
+                                   float cctMax = 27000.0f,
+                                   float cctStep = 50.0f);
 
         /**
          * Generate Relative Spectral Power Distribution for a given CCT.
@@ -24,10 +42,62 @@ namespace css::daylight
          */
         Eigen::VectorXf generate(float cct) const;
 
+        /**
+         * Generate an off-locus SPD: the daylight chromaticity for `cct` is moved
+         * by `duv` along the locus normal in CIE 1960 (u, v) before the basis
+         * weights are derived. Positive duv points towards green (+v).
+         */
+        Eigen::VectorXf generate(float cct, float duv) const;
+
+        /**
+         * Allocation-free variants of generate(): write the 33 values into
+         * caller storage (e.g. a column of a preallocated matrix).
+         */
+        void generate(float cct, Eigen::Ref<Eigen::VectorXf> out) const;
+        void generate(float cct, float duv, Eigen::Ref<Eigen::VectorXf> out) const;
+
+        /**
+         * weights(cct, duv) served from the table when on the locus and inside
+         * its range; exact at table entries.
+         */
+        Eigen::Vector3f weightsAt(float cct, float duv = 0.0f) const;
+
+        /**
+         * Basis weights (1, M1, M2) such that SPD = getBasis() * weights.
+         * Cheap (no SPD reconstruction); used by estimators that precompute
+         * per-basis systems.
+         */
+        static Eigen::Vector3f weights(float cct, float duv = 0.0f);
+
+        /**
+         * Basis weights (1, M1, M2) for an arbitrary CIE 1931 (x, y) chromaticity.
+         */
+        static Eigen::Vector3f weightsForChromaticity(double x, double y);
+
+        /**
+         * CIE 1931 (x, y) chromaticity of the daylight locus at `cct`.
+         */
+        static Eigen::Vector2d locusChromaticity(double cct);
+
         const Eigen::MatrixXf& getBasis() const { return m_basis; }
 
+        /** Tabulated SPDs: column i is the locus SPD at tableMin() + i * tableStep(). */
+        const Eigen::MatrixXf& getTable() const { return m_table; }
+        float tableMin() const { return m_tableMin; }
+        float tableMax() const { return m_tableMax; }
+        float tableStep() const { return m_tableStep; }
+
     private:
+        // Table cell containing `cct` and the interpolation weight within it.
+        bool lookup(float cct, Eigen::Index& index, float& t) const;
+
         // 33 rows (wavelengths 400..720), 3 cols (S0, S1, S2)
         Eigen::MatrixXf m_basis;
+
+        Eigen::Matrix3Xf m_weightTable; // 3 x N basis weights on the locus
+        Eigen::MatrixXf m_table;        // 33 x N SPDs, m_basis * m_weightTable
+        float m_tableMin = 0.0f;
+        float m_tableMax = 0.0f;
+        float m_tableStep = 1.0f;
     };
 }
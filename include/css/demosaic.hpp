@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <opencv2/core.hpp>
+
+#include "css/color_kernel.hpp"
+
+namespace css::demosaic
+{
+    enum class Method
+    {
+        Bilinear,        // average of the nearest samples of each color
+        MalvarHeCutler   // bilinear corrected by the center channel's Laplacian (5x5)
+    };
+
+    /** Colors of the top-left 2x2 block of the sensor. */
+    enum class Cfa
+    {
+        RGGB,
+        BGGR,
+        GRBG,
+        GBRG
+    };
+
+    /** "bilinear" or "mhc"; throws std::runtime_error otherwise. */
+    Method parseMethod(const std::string& name);
+    const char* methodName(Method method);
+
+    /**
+     * Pattern of an io::RawMosaic::bayerCode (cv::COLOR_Bayer*2BGR as set
+     * by io::loadDngMosaic). Codes mean what they mean to cv::cvtColor, which
+     * names a pattern by its second row: COLOR_BayerBG2BGR is an RGGB sensor.
+     * Throws std::runtime_error for anything else.
+     */
+    Cfa cfaFromBayerCode(int bayerCode);
+
+    /** Rows and columns each output pixel reads on either side. */
+    constexpr int kHalo = 2;
+
+    /** A CFA mosaic in memory, and how its codes map to linear values. */
+    struct MosaicView
+    {
+        const std::uint16_t* data = nullptr;
+        size_t stride = 0;    // in samples
+        int width = 0;
+        int height = 0;
+        Cfa cfa = Cfa::RGGB;
+        float black = 0.0f;   // value = max(code - black, 0) * scale
+        float scale = 1.0f;
+    };
+
+    /** Receives output row y (image coordinates) as interleaved BGR floats. */
+    using RowSink = std::function<void(int y, const float* bgr)>;
+
+    /**
+     * Demosaic the window of `cols` x `rows` pixels at (x0, y0), one row at
+     * a time, handing each to `sink` while it is in L1.
+     *
+     * Five converted input rows (the window plus kHalo on every side) live
+     * in a small ring, so memory use is a few rows whatever the window;
+     * outside the mosaic, rows and columns are mirrored about the edge
+     * sample, which keeps the Bayer phase. A pixel's value depends only on
+     * its neighborhood, never on the window: tiles, bands and the full
+     * frame agree exactly. Rows run through SIMD kernels (4/8/16 pixels per
+     * iteration) up to `isa`. Outputs are clamped at zero, not above.
+     * The mosaic must be at least 2x2; throws std::runtime_error.
+     */
+    void demosaicRows(const MosaicView& mosaic, Method method, int x0, int y0, int cols, int rows,
+                      const RowSink& sink, kernel::Isa isa = kernel::detectIsa());
+
+    /**
+     * Whole-image demosaic of a CV_16UC1 mosaic to BGR, in row bands over
+     * the shared thread pool (`threads` as in pipeline::ApplyOptions).
+     * depth CV_32F gives the linear values; CV_16U rounds them to codes
+     * (so with scale 1, black-subtracted sensor codes).
+     */
+    cv::Mat demosaicImage(const cv::Mat& mosaic, Cfa cfa, Method method, float black, float scale,
+                          int depth = CV_32F, unsigned threads = 0);
+} // namespace css::demosaic
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cmath>
+#include <Eigen/Core>
+
+namespace css::spectral
+{
+    /**
+     * Uniform wavelength sampling: `count` samples from `start` nm every `step` nm.
+     * Spectral matrices in this project store one sample per row, so a grid
+     * describes the rows of every curve, basis and SPD it is attached to.
+     */
+    struct SpectralGrid
+    {
+        float start = 400.0f;  // nm
+        float step = 10.0f;    // nm
+        int count = 33;
+
+        /** The project default: 400-720nm @ 10nm (33 values). */
+        static SpectralGrid standard() { return {}; }
+
+        /** Grid covering [first, last] inclusive; `last` is rounded to a whole step. */
+        static SpectralGrid range(float first, float last, float step)
+        {
+            SpectralGrid g;
+            g.start = first;
+            g.step = step;
+            g.count = static_cast<int>(std::lround((last - first) / step)) + 1;
+            return g;
+        }
+
+        float wavelength(int i) const { return start + step * static_cast<float>(i); }
+        float end() const { return wavelength(count - 1); }
+
+        Eigen::VectorXf wavelengths() const
+        {
+            return Eigen::VectorXf::LinSpaced(count, start, end());
+        }
+
+        bool operator==(const SpectralGrid& o) const
+        {
+            return count == o.count && std::abs(start - o.start) < 1e-3f && std::abs(step - o.step) < 1e-3f;
+        }
+        bool operator!=(const SpectralGrid& o) const { return !(*this == o); }
+    };
+} // namespace css::spectral
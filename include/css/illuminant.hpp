@@ -0,0 +1,112 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/grid.hpp"
+
+namespace css::illuminant
+{
+    /**
+     * A family of illuminant SPDs sampled on a spectral grid, computed once.
+     * Every spectrum is normalized to 100 at 560nm. Parametric families
+     * (blackbody, daylight) record the CCT of each member; tabulated ones
+     * record 0.
+     */
+    struct IlluminantSet
+    {
+        std::string family;               // e.g. "blackbody", "F", "LED-model"
+        std::vector<std::string> labels;  // one per member, e.g. "3200K", "F2"
+        std::vector<float> cct;           // Kelvin per member, 0 if not parametric
+        Eigen::MatrixXf spectra;          // grid.count rows x one column per member
+        spectral::SpectralGrid grid;
+
+        size_t size() const { return labels.size(); }
+
+        /** Column of `label`, or -1 if the family has no such member. */
+        Eigen::Index find(const std::string& label) const;
+    };
+
+    /**
+     * Blackbody radiator (Planck's law) at `cct` Kelvin, normalized to 100 at
+     * 560nm. The Ref overload writes grid.count values into caller storage.
+     */
+    Eigen::VectorXf planck(float cct, const spectral::SpectralGrid& grid = {});
+    void planck(float cct, const spectral::SpectralGrid& grid, Eigen::Ref<Eigen::VectorXf> out);
+
+    /** Blackbody spectra every `cctStep` K over [cctMin, cctMax]. */
+    IlluminantSet blackbodySet(float cctMin = 1000.0f, float cctMax = 20000.0f, float cctStep = 50.0f,
+                               const spectral::SpectralGrid& grid = {});
+
+    /** CIE daylight spectra every `cctStep` K over [cctMin, cctMax], labeled "D6500K" etc. */
+    IlluminantSet daylightSet(float cctMin = 4000.0f, float cctMax = 25000.0f, float cctStep = 50.0f,
+                              const spectral::SpectralGrid& grid = {});
+
+    /**
+     * CIE standard illuminants A (from its defining formula) and D50, D55,
+     * D65, D75 (daylight basis at their nominal CCTs).
+     */
+    IlluminantSet cieStandardSet(const spectral::SpectralGrid& grid = {});
+
+    /** CIE fluorescent illuminants F1-F12 (family "F"), from data/cie_f_series.csv. */
+    IlluminantSet fSeriesSet(const spectral::SpectralGrid& grid = {});
+
+    /**
+     * Synthetic phosphor-converted white LEDs LEDm-B1-B5 (family "LED-model"),
+     * from data/led_model.csv: a three-band model (blue die, green and red
+     * phosphor) fitted to the CIE 15:2018 chromaticities of LED-B1-B5. It is
+     * not the published CIE table; load that with loadIlluminantCsv().
+     */
+    IlluminantSet ledModelSet(const spectral::SpectralGrid& grid = {});
+
+    /**
+     * Load measured or published SPDs (e.g. the CIE F1-F12 or LED-B1-B5 tables)
+     * from a CSV file.
+     *
+     * Expected CSV format (header required, it names the members):
+     *   wavelength_nm,<name1>,<name2>,...
+     * Lines starting with '#' are comments.
+     * Uniformly spaced samples go through the resampling engine (Sprague /
+     * rebinning); irregular ones are linearly interpolated. Samples must cover
+     * the grid. Throws std::runtime_error on failure.
+     */
+    IlluminantSet loadIlluminantCsv(const std::string& path, const std::string& family,
+                                    const spectral::SpectralGrid& grid = {});
+
+    /**
+     * Registry of illuminant families that estimators and reference-data code
+     * query by family or member label. Starts with the "blackbody", "daylight",
+     * "cie", "F" and "LED-model" families; others are added from CSV. Every family
+     * is held on the library's grid. Lookups return cached spectra and never
+     * recompute them.
+     */
+    class IlluminantLibrary
+    {
+    public:
+        explicit IlluminantLibrary(const spectral::SpectralGrid& grid = {});
+
+        const spectral::SpectralGrid& grid() const { return m_grid; }
+
+        /** Add a family (resampled to the library grid), replacing any family with the same name. */
+        void add(IlluminantSet set);
+
+        /** loadIlluminantCsv() + add(). */
+        void loadCsv(const std::string& path, const std::string& family);
+
+        bool hasFamily(const std::string& family) const;
+        const IlluminantSet& family(const std::string& family) const;
+        std::vector<std::string> families() const;
+
+        /**
+         * SPD of a member from any family ("D65", "F11", "3200K", ...). A Kelvin
+         * label off the blackbody grid is evaluated directly.
+         */
+        Eigen::VectorXf spectrum(const std::string& label) const;
+
+    private:
+        spectral::SpectralGrid m_grid;
+        std::map<std::string, IlluminantSet> m_families;
+    };
+} // namespace css::illuminant
@@ -3,6 +3,8 @@
 #include <string>
 #include <opencv2/core.hpp>
 
+#include "css/demosaic.hpp"
+
 namespace css::io
 {
     /**
@@ -11,16 +13,44 @@ namespace css::io
      * - Uses cv::imread with IMREAD_UNCHANGED.
      * - Converts to 32-bit float.
      * - Normalizes by an estimated black/white level if metadata is unavailable.
+     * - Demosaics CFA data with `method` (demosaic::demosaicImage), straight
+     *   from the raw codes to floats.
      *
      * The returned image uses OpenCV's default channel order (BGR).
      */
-    cv::Mat loadDngAsLinearRgb(const std::string& path);
+    cv::Mat loadDngAsLinearRgb(const std::string& path,
+                               demosaic::Method method = demosaic::Method::MalvarHeCutler);
+
+    /** DNG samples as stored, before black subtraction and demosaicing. */
+    struct RawMosaic
+    {
+        cv::Mat data;             // CV_16UC1 CFA, or CV_16UC3 RGB for linear DNGs
+        int bayerCode = -1;       // cv::COLOR_Bayer*2BGR for CFA data, -1 for RGB
+        float black = 0.0f;
+        float whiteLevel = 1.0f;  // white minus black level
+    };
+
+    /** Decode a DNG without processing it (8-bit samples are widened to 16). */
+    RawMosaic loadDngMosaic(const std::string& path);
+
+    /** A DNG decoded to integers: what loadDngAsLinearRgb has before its float conversion. */
+    struct RawImage16
+    {
+        cv::Mat image;            // CV_16UC3, black level subtracted, same channel order
+        float whiteLevel = 1.0f;  // code of linear 1.0 (white minus black level)
+    };
+
+    /** loadDngAsLinearRgb without the float conversion, for pipeline::applyProfileFixed. */
+    RawImage16 loadDngAsRgb16(const std::string& path,
+                              demosaic::Method method = demosaic::Method::MalvarHeCutler);
 
     /**
      * Save a linear RGB/BGR float image in [0,1] to disk.
      *
      * - Optionally converts to 8-bit or 16-bit before writing.
      * - Clamps values to [0,1].
+     * - 8-bit and 16-bit images (e.g. from applyProfile with a quantized
+     *   depth) are written as they are; bitDepth is ignored.
      */
     void saveImage(const std::string& path,
                    const cv::Mat& image,
@@ -1,36 +1,252 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 #include <Eigen/Core>
 #include "css/priors.hpp"
 #include "css/daylight.hpp"
+#include "css/illuminant.hpp"
+#include "css/tikhonov.hpp"
 
 namespace css::jiang
 {
+    enum class IlluminantModel
+    {
+        DaylightLocus, // 1D search over CCT on the CIE daylight locus
+        OffPlanckian   // 2D search over CCT x Duv (LED / fluorescent rooms)
+    };
+
+    struct SearchOptions
+    {
+        IlluminantModel model = IlluminantModel::DaylightLocus;
+
+        // CCT range in Kelvin. For DaylightLocus every step is evaluated.
+        float cctMin = 4000.0f;
+        float cctMax = 27000.0f;
+        float cctStep = 100.0f;
+
+        // OffPlanckian only: coarse grid, then `refineLevels` halvings of both
+        // steps around the best `refineSeeds` coarse cells.
+        float coarseCctStep = 500.0f;
+        float duvMin = -0.03f;
+        float duvMax = 0.03f;
+        float duvStep = 0.005f;
+        int refineLevels = 4;
+        int refineSeeds = 3;
+
+        // Tikhonov regularization of the per-channel basis-coefficient fits.
+        // Candidates are ranked by their residual at `lambda`; at the chosen
+        // illuminant each channel's lambda is then picked by `regularization`
+        // (GCV or L-curve) from the same SVD before the CSS is reconstructed.
+        tikhonov::LambdaSelection regularization = tikhonov::LambdaSelection::Fixed;
+        float lambda = 0.0f;
+    };
+
     struct JiangResult
     {
         float estimatedCct = 0.0f;
+        float estimatedDuv = 0.0f;    // offset from the daylight locus in CIE 1960 uv (0 for DaylightLocus)
         float rmsError = 0.0f;
-        Eigen::MatrixXf css;          // Recovered CSS (33 rows x 3 cols), normalized to max 1.0
-        Eigen::VectorXf illuminant;   // Recovered Illuminant SPD (33x1)
+        Eigen::Vector3f illuminantWeights = Eigen::Vector3f(1.0f, 0.0f, 0.0f); // (1, M1, M2) on S0, S1, S2; zero for solveFamily()
+        std::string illuminantLabel;  // family member chosen by solveFamily(), empty otherwise
+        Eigen::Vector3f lambda = Eigen::Vector3f::Zero(); // per-channel Tikhonov lambda used for the CSS
+        Eigen::MatrixXf css;          // Recovered CSS (grid.count rows x 3 cols), normalized to max 1.0
+        Eigen::VectorXf illuminant;   // Recovered Illuminant SPD (grid.count x 1)
+        spectral::SpectralGrid grid;  // sampling of css and illuminant (the priors' grid)
+    };
+
+    struct CaptureIlluminant
+    {
+        float estimatedCct = 0.0f;
+        float estimatedDuv = 0.0f;
+        float exposure = 1.0f;        // relative to the first capture
+        float rmsError = 0.0f;        // this capture's residual under the shared CSS
+        Eigen::Vector3f illuminantWeights = Eigen::Vector3f(1.0f, 0.0f, 0.0f);
+        Eigen::VectorXf illuminant;   // grid.count x 1
+    };
+
+    struct JointJiangResult
+    {
+        float rmsError = 0.0f;        // over all captures
+        int iterations = 0;
+        Eigen::Vector3f lambda = Eigen::Vector3f::Zero(); // per-channel Tikhonov lambda of the shared CSS
+        Eigen::MatrixXf css;          // Shared CSS (grid.count rows x 3 cols), normalized to max 1.0
+        spectral::SpectralGrid grid;  // sampling of css and every capture illuminant
+        std::vector<CaptureIlluminant> captures; // same order as the input captures
     };
 
     class JiangEstimator
     {
     public:
+        /** Keeps its own copy of `priors`, shared by copies of the estimator. */
         explicit JiangEstimator(const priors::CameraPriors& priors);
+
+        /** Uses binary priors in place; the estimator and its copies keep the mapping open. */
+        explicit JiangEstimator(std::shared_ptr<const priors::MappedPriors> priors);
+
+        const priors::PriorsView& priors() const { return m_priors; }
         
         /**
          * Solve for CSS using Jiang et al. method.
          * 
          * @param rgbPatches Observed linear RGB values (vector of size 24)
          *                   Order must match the reflectance data (Dark Skin -> Black)
+         * @param options    Illuminant search space (daylight locus by default)
          * @return Optimization result
          */
-        JiangResult solve(const std::vector<Eigen::Vector3f>& rgbPatches);
+        JiangResult solve(const std::vector<Eigen::Vector3f>& rgbPatches,
+                          const SearchOptions& options = {}) const;
+
+        /**
+         * Same as solve(), but the illuminant is searched over the members of
+         * an illuminant family (blackbody, CIE F-series, measured LEDs, ...)
+         * instead of the daylight locus. Members are evaluated in parallel from
+         * the family's cached spectra; only the regularization fields of
+         * `options` are used.
+         */
+        JiangResult solveFamily(const std::vector<Eigen::Vector3f>& rgbPatches,
+                                const illuminant::IlluminantSet& family,
+                                const SearchOptions& options = {}) const;
+
+        /**
+         * Joint recovery of one CSS from several captures of the chart, each
+         * under its own illuminant.
+         *
+         * Alternates between (a) per-capture illuminant + exposure searches
+         * against the current CSS, run in parallel on the shared pool, and
+         * (b) a shared CSS + per-capture exposure solve (Gauss-Newton) from
+         * normal equations accumulated capture by capture. Initial
+         * illuminants come from independent solve() calls.
+         *
+         * The shared CSS is regularized as in solve(): `options.lambda`, or a
+         * per-channel lambda picked by GCV / L-curve on the captures' stacked
+         * system (evaluated from the accumulated normal equations), re-picked
+         * whenever illuminants or exposures change.
+         *
+         * @param captures      One 24-patch observation per capture
+         * @param maxIterations Upper bound on alternation rounds
+         */
+        JointJiangResult solveJoint(const std::vector<std::vector<Eigen::Vector3f>>& captures,
+                                    const SearchOptions& options = {},
+                                    int maxIterations = 10) const;
 
     private:
-        priors::CameraPriors m_priors;
+        friend class JiangBatchSolver;
+
+        using ChannelSystems = std::array<Eigen::MatrixXf, 3>;
+
+        explicit JiangEstimator(std::shared_ptr<const priors::CameraPriors> priors);
+        JiangEstimator(std::shared_ptr<const void> storage, const priors::PriorsView& priors);
+
+        Eigen::MatrixXf toObservations(const std::vector<Eigen::Vector3f>& rgbPatches) const;
+
+        // Per-channel systems (24 x K) for a daylight-basis illuminant or an arbitrary SPD.
+        ChannelSystems daylightSystems(const Eigen::Vector3f& weights) const;
+        ChannelSystems spdSystems(const Eigen::VectorXf& spd) const;
+
+        // Squared residual of the per-channel least-squares fit (Tikhonov with
+        // `lambda` when positive) for an illuminant given as daylight-basis
+        // weights. Optionally writes the CSS (grid.count x 3).
+        float evaluate(const Eigen::MatrixXf& observations,
+                       const Eigen::Vector3f& weights,
+                       float lambda,
+                       Eigen::MatrixXf* css) const;
+        float evaluate(const Eigen::MatrixXf& observations,
+                       const ChannelSystems& systems,
+                       float lambda,
+                       Eigen::MatrixXf* css) const;
+
+        // Unnormalized CSS at a fixed illuminant with the lambda selection of
+        // `options`; returns the per-channel lambdas used.
+        Eigen::Vector3f fitCss(const Eigen::MatrixXf& observations,
+                               const ChannelSystems& systems,
+                               const SearchOptions& options,
+                               Eigen::MatrixXf& css) const;
+
+        std::shared_ptr<const void> m_storage; // the CameraPriors or MappedPriors m_priors views
+        priors::PriorsView m_priors;
         daylight::DaylightGenerator m_daylight;
+        Eigen::MatrixXf m_daylightBasis; // S0, S1, S2 resampled to m_priors.grid
+
+        // Illuminant-independent systems: m_systems[ch][k] = R^T diag(S_k) E_ch * dLambda (24 x K).
+        // The system for any daylight-basis illuminant is sum_k w_k * m_systems[ch][k].
+        std::array<std::array<Eigen::MatrixXf, 3>, 3> m_systems;
+    };
+
+    struct BootstrapOptions
+    {
+        int resamples = 2000;
+        uint64_t seed = 0x5eedULL;
+        bool resamplePatches = true;   // draw 24 patches with replacement per resample
+        float noiseScale = 1.0f;       // multiplier on the per-patch sigma (0 = no perturbation)
+        std::vector<float> percentiles = {2.5f, 50.0f, 97.5f};
+        unsigned threads = 0;          // 0 = every thread of the shared pool, 1 = serial
+    };
+
+    struct BootstrapResult
+    {
+        int resamples = 0;
+        std::vector<float> percentiles;
+        std::vector<Eigen::MatrixXf> bands; // one grid.count x 3 CSS per percentile, same order
+        Eigen::MatrixXf mean;               // grid.count x 3
+        Eigen::MatrixXf stddev;             // grid.count x 3
+        spectral::SpectralGrid grid;
+        std::vector<float> cct;             // estimated CCT per resample
+        std::vector<float> duv;             // estimated Duv per resample
+    };
+
+    /**
+     * Solves many observation sets against one CameraPriors (fleet calibration).
+     *
+     * The channel systems for every grid illuminant of `options` are factorized
+     * once (thin SVD); each chart then costs two small matrix-vector products
+     * per channel and candidate, and automatic lambda selection at the chosen
+     * illuminant reuses the same singular values. OffPlanckian refinement points are not on a
+     * fixed grid and fall back to per-candidate solves.
+     */
+    class JiangBatchSolver
+    {
+    public:
+        explicit JiangBatchSolver(const priors::CameraPriors& priors,
+                                  const SearchOptions& options = {});
+        explicit JiangBatchSolver(JiangEstimator estimator, const SearchOptions& options = {});
+
+        /** JiangEstimator::solve with the construction options (up to rounding on near-tied candidates). */
+        JiangResult solve(const std::vector<Eigen::Vector3f>& rgbPatches) const;
+
+        /** Solve every chart in parallel on the shared pool; results keep input order. */
+        std::vector<JiangResult> solveBatch(const std::vector<std::vector<Eigen::Vector3f>>& charts) const;
+
+        /**
+         * Bootstrap confidence bands for the recovered CSS.
+         *
+         * Each resample draws patches with replacement and adds Gaussian noise
+         * with per-patch, per-channel sigma (e.g. the patch standard error of the
+         * mean), then reruns the illuminant search and CSS fit. Resamples run in
+         * parallel on the shared pool; resample i draws from its own RNG stream
+         * derived from (seed, i), so results do not depend on thread count.
+         *
+         * @param patchSigma Per-patch noise sigma (size 24), same order as rgbPatches
+         */
+        BootstrapResult bootstrap(const std::vector<Eigen::Vector3f>& rgbPatches,
+                                  const std::vector<Eigen::Vector3f>& patchSigma,
+                                  const BootstrapOptions& options = {}) const;
+
+        const JiangEstimator& estimator() const { return m_estimator; }
+
+    private:
+        struct Factorization
+        {
+            Eigen::MatrixXf A;               // 24 x K channel system
+            tikhonov::TikhonovPath path;     // thin SVD of A, reused for every lambda
+        };
+
+        JiangEstimator m_estimator;
+        SearchOptions m_options;
+        std::vector<Eigen::Vector2f> m_grid;                  // (cct, duv) per grid illuminant
+        std::vector<std::array<Factorization, 3>> m_factors;  // per grid illuminant, per channel
     };
 }
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/color_kernel.hpp"
+#include "css/profile.hpp"
+#include "css/transfer.hpp"
+
+namespace css::lut
+{
+    /**
+     * A color transform baked into a size^3 grid over shaped linear BGR.
+     *
+     * Input first goes through `shaper`, a 3x3 matrix and a transfer curve
+     * run by kernel::applyRow, so the grid spends its points where the eye
+     * and the output curve need them; the result is interpolated
+     * tetrahedrally in the grid. Whatever was baked, a pixel costs the
+     * same: one shaper pass and four lookups per channel.
+     */
+    struct Lut3D
+    {
+        int size = 0;
+        kernel::ColorTransform shaper;  // linear BGR -> grid coordinates in [0, 1]
+        std::vector<float> table;       // size^3 BGR outputs, red index fastest (.cube order)
+    };
+
+    /** Any per-pixel transform of linear BGR to output BGR. */
+    using Transform = std::function<Eigen::Vector3f(const Eigen::Vector3f& linearBgr)>;
+
+    /**
+     * Sample `fn` at the grid points, spread over the shared thread pool;
+     * `fn` sees linear values after `inputMatrix` (BGR -> BGR), which the
+     * shaper applies per pixel. `size` is usually 17, 33 or 65 (2 to 129);
+     * throws std::runtime_error.
+     */
+    Lut3D bake(const Transform& fn, int size, const transfer::TransferFunction& shaper,
+               const Eigen::Matrix3f& inputMatrix = Eigen::Matrix3f::Identity());
+
+    struct BakeOptions
+    {
+        int size = 33;
+        transfer::TransferFunction encoding;                         // output curve, sRGB by default
+        transfer::TransferFunction shaper{transfer::Curve::Srgb};    // grid axes
+        std::vector<float> toneCurve;  // optional: samples over [0, 1] of encoded output, interpolated linearly
+
+        // Run white balance and matrix in the shaper, leaving the grid only
+        // the curves: near exact, but a .cube cannot carry the matrix.
+        // Ignored for root-polynomial profiles, which run in the grid.
+        bool matrixInShaper = true;
+    };
+
+    /**
+     * Bake a profile: white balance and matrix (as pipeline::applyProfile),
+     * `encoding` in double precision, then the tone curve per channel.
+     * Domain is clipped at the grid edges: linear [0, 1] for most shapers.
+     */
+    Lut3D bake(const profile::Profile& prof, const BakeOptions& options);
+
+    /**
+     * Transform `count` interleaved linear BGR pixels through `lut`. SIMD
+     * kernels do 4/8/16 pixels per iteration with gathers (SSE4.2 loads
+     * lanes one by one); a pixel's result never depends on its position in
+     * the row. Rows run in L1-sized chunks. The quantized overloads clamp
+     * to [0, 1] and round like kernel::applyRow. `out` must not alias `in`.
+     */
+    void applyRow(const Lut3D& lut, const float* in, float* out, size_t count,
+                  kernel::Isa isa = kernel::detectIsa());
+    void applyRow(const Lut3D& lut, const float* in, std::uint16_t* out, size_t count,
+                  kernel::Isa isa = kernel::detectIsa());
+    void applyRow(const Lut3D& lut, const float* in, std::uint8_t* out, size_t count,
+                  kernel::Isa isa = kernel::detectIsa());
+
+    /**
+     * Write `lut` as a .cube file. A non-linear shaper curve goes first as
+     * a 4096-point LUT_1D over its input range (the shaper + 3D layout that
+     * Resolve reads); the 3D table follows in RGB. The shaper matrix must
+     * be the identity (BakeOptions::matrixInShaper = false). Throws
+     * std::runtime_error.
+     */
+    void writeCube(const Lut3D& lut, const std::string& path, const std::string& title = "camspec");
+} // namespace css::lut
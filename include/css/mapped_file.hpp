@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace css::io
+{
+    /**
+     * Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+     *
+     * Pages are loaded by the OS on first touch and shared between processes,
+     * so binary assets can be used in place without a read-and-copy pass.
+     * Move-only; the mapping is released on destruction.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        /** Map `path`. Throws std::runtime_error on failure. */
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+    private:
+        void release();
+
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+
+    /** FNV-1a 64-bit hash, used as the content hash of the binary asset formats. */
+    std::uint64_t fnv1a64(const unsigned char* data, size_t size);
+} // namespace css::io
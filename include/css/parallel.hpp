@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace css::parallel
+{
+    /**
+     * Fixed-size worker pool shared by the estimators and image kernels.
+     *
+     * parallelFor() splits an index range across the workers and the calling
+     * thread and blocks until every index has run. Calls made from inside a
+     * worker run inline, so nested parallel sections cannot deadlock.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @param threads Number of worker threads (0 = hardware concurrency - 1,
+         *                the caller being the remaining participant).
+         */
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** Number of threads that can take part in a parallelFor (workers + caller). */
+        unsigned concurrency() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+        /**
+         * Run fn(i) for every i in [0, count).
+         *
+         * @param maxThreads Upper bound on participating threads (0 = all).
+         * The first exception thrown by fn is rethrown on the calling thread.
+         */
+        void parallelFor(size_t count,
+                         const std::function<void(size_t)>& fn,
+                         unsigned maxThreads = 0);
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stop = false;
+    };
+
+    /** Process-wide pool, created on first use. */
+    ThreadPool& sharedPool();
+
+    /** parallelFor on the shared pool. */
+    void parallelFor(size_t count,
+                     const std::function<void(size_t)>& fn,
+                     unsigned maxThreads = 0);
+} // namespace css::parallel
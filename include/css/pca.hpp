@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <Eigen/Core>
+
+namespace css::pca
+{
+    enum class SvdMethod
+    {
+        Auto,       // Exact for small problems, Randomized otherwise
+        Exact,      // thin divide-and-conquer SVD, truncated
+        Randomized  // Halko-Martinsson-Tropp range finder + small SVD
+    };
+
+    struct BasisOptions
+    {
+        int components = 3;
+        SvdMethod method = SvdMethod::Auto;
+        int oversampling = 10;      // extra random directions beyond `components`
+        int powerIterations = 2;    // subspace iterations; sharpen slowly decaying spectra
+        std::uint64_t seed = 0x5eed;
+    };
+
+    struct Basis
+    {
+        Eigen::MatrixXf vectors;        // rows x components, orthonormal columns
+        Eigen::VectorXf singularValues; // components, descending
+        float explainedEnergy = 0.0f;   // sum of kept s^2 / ||data||_F^2
+    };
+
+    /**
+     * Leading left singular vectors of `data` (one sample per column, not
+     * mean-centered), i.e. the uncentered PCA basis that the Jiang model
+     * expands each sensitivity curve in.
+     *
+     * The randomized path costs O(rows * cols * (components + oversampling))
+     * per pass, so it scales to databases with thousands of curves. Signs are
+     * fixed so that each vector has a positive sum. Throws std::runtime_error
+     * if `components` exceeds min(rows, cols).
+     */
+    Basis principalBasis(const Eigen::MatrixXf& data, const BasisOptions& options = {});
+} // namespace css::pca
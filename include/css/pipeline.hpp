@@ -1,39 +1,167 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
+#include <Eigen/Core>
 #include <opencv2/core.hpp>
 
 #include "css/chart.hpp"
+#include "css/demosaic.hpp"
+#include "css/grid.hpp"
+#include "css/illuminant.hpp"
+#include "css/io.hpp"
+#include "css/lut3d.hpp"
 #include "css/profile.hpp"
 #include "css/refdata.hpp"
+#include "css/tikhonov.hpp"
+#include "css/transfer.hpp"
 
 namespace css::pipeline
 {
     struct CalibrateConfig
     {
         chart::ChartConfig chart;
-        std::string refDataCsvPath;   // e.g. data/colorchecker_24_D65.csv
+        std::string refDataCsvPath;   // e.g. data/colorchecker_24_D65.csv; empty = built-in reference
         std::string illuminant = "D65";
         std::string cameraName = "camera";
+
+        // Spectral reference: targets computed from the chart's patch reflectances
+        // under `illuminant` (refdata::cachedReference). Used when refDataCsvPath is
+        // empty and the illuminant is not D65, or always if spectralReference is set.
+        Eigen::MatrixXf chartReflectance;      // grid.count x 24, e.g. CameraPriors::reflectance
+        spectral::SpectralGrid chartGrid;
+        bool spectralReference = false;
+        refdata::Adaptation adaptation = refdata::Adaptation::Bradford;
+        std::shared_ptr<const illuminant::IlluminantLibrary> illuminants; // null = built-in families
+
+        // Color-matrix regularization: fixed lambda, or picked by GCV / L-curve.
+        tikhonov::LambdaSelection regularization = tikhonov::LambdaSelection::Fixed;
+        float lambda = 1e-4f;
+        profile::Model model = profile::Model::Linear;
     };
 
     /**
      * High-level calibration: from chart image to Profile.
      *
      * - Assumes input image is linear BGR float in [0,1].
-     * - Uses ColorChecker 24 reference data from a CSV file.
+     * - Uses ColorChecker 24 reference data from a CSV file, the built-in D65
+     *   table, or one computed from chart spectra for other illuminants.
      */
     profile::Profile calibrateFromChart(const cv::Mat& chartImage,
                                         const CalibrateConfig& cfg);
 
+    struct SynthesisConfig
+    {
+        std::string cameraName = "camera";
+        std::string referenceIlluminant = "D65"; // target colors are those seen under this light
+
+        tikhonov::LambdaSelection regularization = tikhonov::LambdaSelection::Fixed;
+        float lambda = 1e-4f;
+        profile::Model model = profile::Model::Linear;
+    };
+
+    /**
+     * Chart-free calibration: one Profile per illuminant, straight from spectra.
+     *
+     * - css:          grid.count x 3 camera sensitivities (recovered or measured).
+     * - illuminants:  grid.count x L SPDs the profiles are built for, named by `labels`.
+     * - reflectances: grid.count x N training spectra (e.g. priors.reflectance or a
+     *                 reflectance database).
+     *
+     * Camera RGB of every training spectrum under every illuminant comes from
+     * render::SpectralRenderer; the reference is its linear sRGB under
+     * cfg.referenceIlluminant through the CIE 1931 observer. White balance is
+     * taken from the camera response to a perfect reflector, then the matrix
+     * is fitted with calib::solveColorMatrix as for a photographed chart.
+     */
+    std::vector<profile::Profile> synthesizeProfiles(const Eigen::MatrixXf& css,
+                                                     const Eigen::MatrixXf& illuminants,
+                                                     const std::vector<std::string>& labels,
+                                                     const Eigen::MatrixXf& reflectances,
+                                                     const spectral::SpectralGrid& grid,
+                                                     const SynthesisConfig& cfg);
+
+    struct ApplyOptions
+    {
+        transfer::TransferFunction transfer;  // output encoding, sRGB by default
+        int depth = CV_32F;             // CV_32F, or CV_16U / CV_8U quantized in the kernel
+        unsigned threads = 0;           // 0 = every thread of the shared pool, 1 = serial
+        size_t tileBytes = 256 * 1024;  // input + output bytes per row tile (about an L2)
+        demosaic::Method demosaic = demosaic::Method::MalvarHeCutler;  // for renderMosaicToTiff
+    };
+
     /**
      * Apply a profile to a linear BGR image in [0,1].
      *
      * - Applies white balance and 3x3 color matrix.
-     * - Optionally applies sRGB gamma (for display/export).
+     * - Optionally applies a transfer function (sRGB, Rec.709, PQ, HLG, gamma).
+     * - With options.depth CV_16U or CV_8U, clamps and rounds to integer codes
+     *   in the same pass, so no float output image is allocated.
+     * - Runs the widest SIMD kernel the CPU supports (kernel::detectIsa()).
+     * - Splits the image into row tiles spread over the shared thread pool.
+     *   Every pixel goes through the same kernel whatever its tile, so the
+     *   output is bit-identical for any thread count or tile size.
      */
+    cv::Mat applyProfile(const cv::Mat& linearBgr,
+                         const profile::Profile& prof,
+                         const ApplyOptions& options);
+
     cv::Mat applyProfile(const cv::Mat& linearBgr,
                          const profile::Profile& prof,
                          bool applySrgbGamma = true);
+
+    /**
+     * Fixed-point applyProfile for black-subtracted uint16 input
+     * (io::loadDngAsRgb16), `whiteLevel` being the code of linear 1.0; no
+     * float image is ever made. Matrix and white balance run as int16
+     * multiply-accumulates, the transfer function as a 65536-entry table
+     * (kernel::FixedTransform); codes are within a few 16-bit steps of
+     * the float path. options.depth must be CV_16U or CV_8U.
+     */
+    cv::Mat applyProfileFixed(const cv::Mat& bgr16,
+                              float whiteLevel,
+                              const profile::Profile& prof,
+                              const ApplyOptions& options);
+
+    /**
+     * applyProfile through a baked 3D LUT (lut::bake): whatever was baked
+     * (profile, transfer function, tone curve, look), a pixel costs one
+     * shaper pass and one tetrahedral lookup, in row tiles over the shared
+     * thread pool. options.depth as for applyProfile; options.transfer is
+     * ignored, being part of the LUT.
+     */
+    cv::Mat applyLut(const cv::Mat& linearBgr,
+                     const lut::Lut3D& lut,
+                     const ApplyOptions& options);
+
+    /**
+     * One-pass raw -> TIFF rendering, with the same output as
+     * io::loadDngAsLinearRgb + applyProfile + io::saveImage (with the same
+     * demosaic method).
+     *
+     * Square tiles sized from options.tileBytes (multiples of 16 pixels) go
+     * through black subtraction, demosaicing (options.demosaic, streamed a
+     * row at a time by demosaic::demosaicRows, so tile edges match a
+     * full-frame demosaic), scaling, matrix, transfer function and
+     * quantization while they are in cache, spread over the shared
+     * thread pool; each is written to its place in a tiled TIFF
+     * (io::TiledTiffWriter) as soon as it is done. No full-frame
+     * intermediate is made. options.depth must be CV_16U or CV_8U;
+     * fixedPoint uses kernel::applyRowFixed instead of the float kernel,
+     * on demosaiced rows rounded to codes as io::loadDngAsRgb16 rounds them.
+     */
+    void renderMosaicToTiff(const io::RawMosaic& mosaic,
+                            const profile::Profile& prof,
+                            const std::string& tiffPath,
+                            const ApplyOptions& options,
+                            bool fixedPoint = false);
+
+    /** renderMosaicToTiff on io::loadDngMosaic(dngPath). */
+    void renderDngToTiff(const std::string& dngPath,
+                         const profile::Profile& prof,
+                         const std::string& tiffPath,
+                         const ApplyOptions& options,
+                         bool fixedPoint = false);
 } // namespace css::pipeline
 
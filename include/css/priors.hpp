@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <Eigen/Core>
 
+#include "css/grid.hpp"
+#include "css/mapped_file.hpp"
+#include "css/pca.hpp"
+#include "css/resample.hpp"
+
 namespace css::priors
 {
     struct CameraPriors
@@ -14,14 +21,144 @@ namespace css::priors
         Eigen::MatrixXf basisB;
         
         // Spectral Reflectance of the chart patches
-        // Rows = Wavelengths (33), Cols = Num Patches (24)
+        // Rows = Wavelengths (grid.count), Cols = Num Patches (24)
         Eigen::MatrixXf reflectance;
+
+        // Wavelength sampling of every row above.
+        spectral::SpectralGrid grid;
     };
 
     /**
      * Load priors from an OpenCV YAML file (e.g. assets.yaml).
      * Expected keys: 'basis_r', 'basis_g', 'basis_b', 'reflectance'.
+     * Optional keys 'wavelength_start' and 'wavelength_step' (nm) describe the
+     * grid; the default is 400nm @ 10nm.
      * Throws std::runtime_error on failure.
      */
     CameraPriors loadPriorsFromYaml(const std::string& path);
+
+    /**
+     * Save priors as OpenCV YAML readable by loadPriorsFromYaml(), including
+     * the grid keys. Throws std::runtime_error on failure.
+     */
+    void savePriorsToYaml(const std::string& path, const CameraPriors& priors);
+
+    /**
+     * Write priors in the compact binary format read by MappedPriors:
+     * a 64-byte header (magic "CSPRIORS", version, grid, matrix shapes, a
+     * byte-order mark, payload size and FNV-1a 64 hash of the payload)
+     * followed by basis_r, basis_g, basis_b and reflectance as float32,
+     * column-major, all in the writer's byte order. MappedPriors rejects files
+     * written on a host of the other byte order.
+     * Throws std::runtime_error on failure.
+     */
+    void savePriorsBinary(const std::string& path, const CameraPriors& priors);
+
+    /** True if `path` starts with the binary priors magic. */
+    bool isPriorsBinary(const std::string& path);
+
+    /**
+     * Binary priors used in place: the file is memory-mapped and every matrix
+     * is an Eigen::Map over the mapping, so opening costs one header check
+     * (plus one hash pass over the payload when verifying).
+     */
+    class MappedPriors
+    {
+    public:
+        using ConstMap = Eigen::Map<const Eigen::MatrixXf>;
+
+        /** Throws std::runtime_error on a bad magic, version, size or hash. */
+        explicit MappedPriors(const std::string& path, bool verifyHash = true);
+
+        // Maps point into the mapping: movable, but never copied or reassigned.
+        MappedPriors(MappedPriors&&) = default;
+        MappedPriors(const MappedPriors&) = delete;
+        MappedPriors& operator=(const MappedPriors&) = delete;
+        MappedPriors& operator=(MappedPriors&&) = delete;
+
+        const ConstMap& basisR() const { return m_basisR; }
+        const ConstMap& basisG() const { return m_basisG; }
+        const ConstMap& basisB() const { return m_basisB; }
+        const ConstMap& reflectance() const { return m_reflectance; }
+        const spectral::SpectralGrid& grid() const { return m_grid; }
+
+        /** FNV-1a 64 of the payload, as stored in the header. */
+        std::uint64_t contentHash() const { return m_hash; }
+
+        /** Owning copy for code that keeps CameraPriors by value. */
+        CameraPriors toPriors() const;
+
+    private:
+        io::MappedFile m_file;
+        spectral::SpectralGrid m_grid;
+        std::uint64_t m_hash = 0;
+        ConstMap m_basisR{nullptr, 0, 0};
+        ConstMap m_basisG{nullptr, 0, 0};
+        ConstMap m_basisB{nullptr, 0, 0};
+        ConstMap m_reflectance{nullptr, 0, 0};
+    };
+
+    /**
+     * Non-owning view of priors, either a CameraPriors or a MappedPriors
+     * mapping; the matrices are referenced in place, never copied. The viewed
+     * priors must outlive the view.
+     */
+    struct PriorsView
+    {
+        using Matrix = Eigen::Ref<const Eigen::MatrixXf>;
+
+        PriorsView(const CameraPriors& priors);
+        PriorsView(const MappedPriors& priors);
+
+        Matrix basisR;
+        Matrix basisG;
+        Matrix basisB;
+        Matrix reflectance;
+        spectral::SpectralGrid grid;
+    };
+
+    /**
+     * Load priors from either format, detected by the binary magic, into an
+     * owning CameraPriors. Solvers take binary priors in place instead (see
+     * jiang::JiangEstimator).
+     */
+    CameraPriors loadPriors(const std::string& path);
+
+    /** Save as binary for a ".cspri" path, YAML otherwise. */
+    void savePriors(const std::string& path, const CameraPriors& priors);
+
+    struct BuildOptions
+    {
+        pca::BasisOptions basis;  // components per channel, SVD method
+        bool normalize = true;    // scale every curve to unit peak before the PCA
+    };
+
+    /**
+     * Build per-channel PCA bases from a sensitivity database.
+     *
+     * curves:      one (grid.count x 3) matrix per camera, all on `grid`
+     *              (see spectral::loadSensitivityDirectory()).
+     * reflectance: chart patch spectra on `grid`, copied into the result.
+     * explained:   optional per-channel fraction of energy kept by the basis.
+     */
+    CameraPriors buildPriors(const std::vector<Eigen::MatrixXf>& curves,
+                             const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const BuildOptions& options = {},
+                             Eigen::Vector3f* explained = nullptr);
+
+    /**
+     * Same, from cameras packed side by side (grid.count x 3·M, R G B per
+     * camera) as stored in a spectral::SpectralDatabase sensitivity dataset.
+     */
+    CameraPriors buildPriors(const Eigen::Ref<const Eigen::MatrixXf>& packed,
+                             const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const BuildOptions& options = {},
+                             Eigen::Vector3f* explained = nullptr);
+
+    /** Priors with every spectral matrix resampled onto `grid` (one GEMM each). */
+    CameraPriors resamplePriors(const CameraPriors& priors,
+                                const spectral::SpectralGrid& grid,
+                                spectral::ResampleMethod method = spectral::ResampleMethod::Auto);
 }
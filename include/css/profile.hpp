@@ -5,15 +5,50 @@
 
 namespace css::profile
 {
+    /**
+     * Color correction model (Finlayson et al., root-polynomial color
+     * correction). Linear is the 3x3 matrix; RootPoly2 adds sqrt(rg),
+     * sqrt(gb), sqrt(rb) (3x6); RootPoly3 adds the seven degree-3 roots
+     * cbrt(rg^2), cbrt(gb^2), cbrt(rb^2), cbrt(gr^2), cbrt(bg^2), cbrt(br^2),
+     * cbrt(rgb) (3x13). Every term scales linearly with exposure, so a model
+     * fitted at one exposure holds at any other.
+     */
+    enum class Model
+    {
+        Linear,
+        RootPoly2,
+        RootPoly3
+    };
+
+    constexpr int kMaxRootTerms = 10;
+
+    /** Terms of the model, linear ones included: 3, 6 or 13. */
+    int termCount(Model model);
+
+    /** "linear", "rp2", "rp3"; parseModel throws std::runtime_error on anything else. */
+    Model parseModel(const std::string& name);
+    const char* modelName(Model model);
+
+    /**
+     * The root terms of `rgb`, in the order above; entries past the model's
+     * count are zero. Negative components count as zero.
+     */
+    Eigen::Matrix<float, kMaxRootTerms, 1> rootTerms(const Eigen::Vector3f& rgb, Model model);
+
     struct Profile
     {
         std::string cameraName;
         std::string illuminant;       // e.g. "D65"
         std::string chartType;        // e.g. "ColorChecker24"
-        std::string targetColorSpace; // e.g. "linear_srgb"
+        std::string targetColorSpace; // a colorspace::find() name, e.g. "linear_srgb"
 
         Eigen::Matrix3f colorMatrix = Eigen::Matrix3f::Identity();
         Eigen::Vector3f whiteBalance = Eigen::Vector3f::Ones();
+
+        // Root-polynomial models: out = colorMatrix * c + rootMatrix * rootTerms(c),
+        // c the white-balanced camera RGB. Columns past the model's terms are zero.
+        Model model = Model::Linear;
+        Eigen::Matrix<float, 3, kMaxRootTerms> rootMatrix = Eigen::Matrix<float, 3, kMaxRootTerms>::Zero();
     };
 
     /**
@@ -26,6 +61,8 @@ namespace css::profile
      *   targetColorSpace=linear_srgb
      *   M=m00 m01 m02 m10 m11 m12 m20 m21 m22
      *   wb=w0 w1 w2
+     *   model=rp2|rp3                (root-polynomial profiles only)
+     *   R=r00 r01 ... (3 rows of termCount - 3 coefficients, row-major)
      */
     bool saveProfile(const std::string& path, const Profile& p);
 
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <Eigen/Core>
 
+#include "css/grid.hpp"
+
+namespace css::illuminant
+{
+    class IlluminantLibrary;
+}
+
 namespace css::refdata
 {
     struct PatchRef
@@ -31,5 +39,60 @@ namespace css::refdata
                                  const std::string& illuminant,
                                  const std::string& colorSpace = "linear_srgb");
 
+    /**
+     * The default ColorChecker 24 reference (data/colorchecker_24_D65.csv),
+     * compiled into the library at build time: no file lookup or parsing.
+     */
+    RefSet defaultColorChecker24(const std::string& illuminant = "D65",
+                                 const std::string& colorSpace = "linear_srgb");
+
+    enum class Adaptation
+    {
+        None,     // colors as seen under the illuminant, white = illuminant white
+        Bradford  // adapted to the white of the target space
+    };
+
+    /**
+     * Reference colors computed from spectral patch reflectances.
+     *
+     * - reflectance:   grid.count x N patch spectra (e.g. CameraPriors::reflectance);
+     *                  24 patches take the ColorChecker names.
+     * - illuminantSpd: grid.count SPD the chart is lit by, any scale.
+     * - colorSpace:    any colorspace::find() name, e.g. "linear_srgb" (D65
+     *                  white), "linear_rec2020", "xyz_d65" or "xyz_d50".
+     *
+     * Patch XYZ comes from the CIE 1931 observer with the perfect reflector
+     * scaled to Y = 1, then goes through the chosen chromatic adaptation to
+     * the target white. Under D65 this reproduces the D65 table to within the
+     * precision of the spectra. Throws std::runtime_error on size mismatch or
+     * an unknown color space.
+     */
+    RefSet spectralReference(const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const Eigen::VectorXf& illuminantSpd,
+                             const std::string& illuminant,
+                             const std::string& colorSpace = "linear_srgb",
+                             Adaptation adaptation = Adaptation::Bradford);
+
+    /**
+     * spectralReference() for an illuminant label ("A", "D50", "3200K", or a
+     * member of a family loaded into `library`), memoized per (chart,
+     * illuminant, color space, adaptation). A null `library` means the
+     * built-in families. The chart is keyed by `chart` and a hash of its
+     * spectra, so batch calibrations under the same light build the reference
+     * once; labels are assumed to name the same SPD across libraries. Safe to
+     * call from several threads.
+     */
+    std::shared_ptr<const RefSet> cachedReference(const std::string& chart,
+                                                  const Eigen::MatrixXf& reflectance,
+                                                  const spectral::SpectralGrid& grid,
+                                                  const std::string& illuminant,
+                                                  const std::string& colorSpace = "linear_srgb",
+                                                  Adaptation adaptation = Adaptation::Bradford,
+                                                  const illuminant::IlluminantLibrary* library = nullptr);
+
+    /** Drop every memoized reference (e.g. after reloading chart spectra). */
+    void clearReferenceCache();
+
 } // namespace css::refdata
 
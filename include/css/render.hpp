@@ -0,0 +1,112 @@
+#pragma once
+
+#include <functional>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/grid.hpp"
+#include "css/resample.hpp"
+
+namespace css::render
+{
+    /**
+     * Predicts camera RGB for reflectances under a set of illuminants.
+     *
+     * For illuminant l the camera response to reflectance r is
+     *   rgb = CSSᵀ diag(e_l) r · Δλ,
+     * so the 3 x n matrix CSSᵀ diag(e_l) Δλ is folded once at construction.
+     * All illuminants are stacked into one (3·L x n) weight matrix, and a
+     * block of N reflectances is rendered under every illuminant by a single
+     * GEMM. The result has three rows per illuminant (R, G, B of illuminant l
+     * at rows 3l..3l+2) and one column per reflectance.
+     */
+    class SpectralRenderer
+    {
+    public:
+        /**
+         * @param css         grid.count x 3 camera sensitivities.
+         * @param illuminants grid.count x L SPDs, one per column.
+         * @param normalizeWhite Scale each illuminant so a perfect reflector
+         *                    renders with G = 1 (exposure-normalized RGB).
+         */
+        SpectralRenderer(const Eigen::MatrixXf& css,
+                         const Eigen::MatrixXf& illuminants,
+                         const spectral::SpectralGrid& grid,
+                         bool normalizeWhite = false);
+
+        int numIlluminants() const { return static_cast<int>(m_weights.rows() / 3); }
+        const spectral::SpectralGrid& grid() const { return m_grid; }
+
+        /** Stacked (3·L x grid.count) illuminant-weighted CSS. */
+        const Eigen::MatrixXf& weights() const { return m_weights; }
+
+        /**
+         * reflectances: grid.count rows x N columns -> 3·L rows x N columns.
+         * Column blocks are spread over the shared thread pool.
+         */
+        Eigen::MatrixXf render(const Eigen::MatrixXf& reflectances) const;
+
+        /** Allocation-free variant writing into caller storage (3·L x N). */
+        void render(const Eigen::Ref<const Eigen::MatrixXf>& reflectances, Eigen::Ref<Eigen::MatrixXf> out) const;
+
+        /** Camera RGB of every reflectance under illuminant `l` alone (3 x N). */
+        Eigen::MatrixXf render(const Eigen::MatrixXf& reflectances, int l) const;
+
+    private:
+        spectral::SpectralGrid m_grid;
+        Eigen::MatrixXf m_weights; // 3·L x grid.count
+    };
+
+    /**
+     * Streams a reflectance database from a CSV file in fixed-size blocks, so
+     * databases larger than memory can be rendered.
+     *
+     * Expected CSV format (one spectrum per line, header required):
+     *   name,<wavelength_nm_1>,<wavelength_nm_2>,...
+     * Header wavelengths must be uniformly spaced; spectra are resampled to
+     * the target grid as they are read. Values may be in [0,1] or percent;
+     * pass `scale` = 0.01 for the latter.
+     */
+    class ReflectanceReader
+    {
+    public:
+        ReflectanceReader(const std::string& path,
+                          const spectral::SpectralGrid& grid,
+                          float scale = 1.0f);
+
+        const spectral::SpectralGrid& sourceGrid() const { return m_source; }
+
+        /**
+         * Read up to `maxCount` spectra into `block` (grid.count x count) and
+         * their labels into `names`. Returns the number read, 0 at end of file.
+         */
+        int next(int maxCount, Eigen::MatrixXf& block, std::vector<std::string>& names);
+
+    private:
+        std::ifstream m_in;
+        std::string m_path;
+        spectral::SpectralGrid m_source;
+        spectral::Resampler m_resampler;
+        float m_scale = 1.0f;
+        Eigen::MatrixXf m_raw; // source.count x maxCount staging buffer
+        size_t m_line = 1;
+    };
+
+    /** Load a whole reflectance CSV (see ReflectanceReader) at once. */
+    Eigen::MatrixXf loadReflectanceCsv(const std::string& path,
+                                       const spectral::SpectralGrid& grid,
+                                       std::vector<std::string>* names = nullptr,
+                                       float scale = 1.0f);
+
+    /**
+     * Render every spectrum of `reader` block by block. `sink` receives each
+     * block's labels and its (3·L x count) RGB before the next block is read.
+     * Returns the number of spectra rendered.
+     */
+    size_t renderStream(ReflectanceReader& reader,
+                        const SpectralRenderer& renderer,
+                        const std::function<void(const std::vector<std::string>&, const Eigen::MatrixXf&)>& sink,
+                        int blockSize = 8192);
+} // namespace css::render
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "css/grid.hpp"
+
+namespace css::spectral
+{
+    enum class ResampleMethod
+    {
+        Auto,     // Sprague when refining or keeping the step, Rebin when coarsening
+        Linear,   // piecewise linear interpolation
+        Sprague,  // CIE-recommended 6-point quintic interpolation (needs >= 6 samples)
+        Rebin     // mean of the linear interpolant over each target bin (preserves integrals)
+    };
+
+    /**
+     * Linear operator taking spectra sampled on one grid to another.
+     *
+     * Every method above is linear in the input samples, so the whole
+     * resampling is precomputed as a dense (to.count x from.count) matrix and
+     * applied to a matrix of spectra (one per column) with a single GEMM.
+     * Converting a database of thousands of spectra is one product, not a loop.
+     *
+     * Target wavelengths outside the source range take the nearest end value.
+     */
+    class Resampler
+    {
+    public:
+        Resampler(const SpectralGrid& from,
+                  const SpectralGrid& to,
+                  ResampleMethod method = ResampleMethod::Auto);
+
+        /** spectra: from.count rows x N columns -> to.count rows x N columns. */
+        Eigen::MatrixXf apply(const Eigen::MatrixXf& spectra) const;
+
+        /** Allocation-free variant writing into caller storage. */
+        void apply(const Eigen::Ref<const Eigen::MatrixXf>& spectra, Eigen::Ref<Eigen::MatrixXf> out) const;
+
+        const Eigen::MatrixXf& matrix() const { return m_op; }
+        const SpectralGrid& from() const { return m_from; }
+        const SpectralGrid& to() const { return m_to; }
+
+    private:
+        SpectralGrid m_from;
+        SpectralGrid m_to;
+        Eigen::MatrixXf m_op; // to.count x from.count
+    };
+
+    /** One-shot helper; returns `spectra` unchanged when the grids match. */
+    Eigen::MatrixXf resample(const Eigen::MatrixXf& spectra,
+                             const SpectralGrid& from,
+                             const SpectralGrid& to,
+                             ResampleMethod method = ResampleMethod::Auto);
+} // namespace css::spectral
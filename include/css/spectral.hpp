@@ -4,6 +4,9 @@
 #include <vector>
 #include <Eigen/Core>
 
+#include "css/grid.hpp"
+#include "css/resample.hpp"
+
 namespace css::spectral
 {
     struct SpectralSample
@@ -32,5 +35,30 @@ namespace css::spectral
      * Format: wavelength_nm,R,G,B
      */
     void saveSpectralSensitivityCsv(const std::string& path, const SpectralSensitivity& sens);
+
+    /**
+     * Curves of `sens` as a (grid.count x 3) matrix on `grid`. Samples must be
+     * uniformly spaced (e.g. 380-780nm @ 1, 2 or 5nm measurements) and are
+     * resampled with `method`. Throws std::runtime_error otherwise.
+     */
+    Eigen::MatrixXf toMatrix(const SpectralSensitivity& sens,
+                             const SpectralGrid& grid,
+                             ResampleMethod method = ResampleMethod::Auto);
+
+    /**
+     * Load every *.csv in `directory` (one camera per file, see
+     * loadSpectralSensitivityCsv()) in parallel, resampled to `grid`. Files
+     * that fail to parse are skipped and reported in `skipped`. Results are in
+     * file-name order; `names` receives the file stems.
+     */
+    std::vector<Eigen::MatrixXf> loadSensitivityDirectory(const std::string& directory,
+                                                          const SpectralGrid& grid,
+                                                          std::vector<std::string>* names = nullptr,
+                                                          std::vector<std::string>* skipped = nullptr);
+
+    /** Inverse of toMatrix(): one sample per grid wavelength. */
+    SpectralSensitivity fromMatrix(const Eigen::MatrixXf& curves,
+                                   const SpectralGrid& grid,
+                                   const std::string& cameraName = "");
 } // namespace css::spectral
 
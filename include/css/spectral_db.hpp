@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Eigen/Core>
+
+#include "css/grid.hpp"
+#include "css/mapped_file.hpp"
+
+namespace css::spectral
+{
+    enum class DatasetKind : std::uint32_t
+    {
+        Generic = 0,
+        Sensitivity = 1,  // 3 columns (R, G, B) per item (camera)
+        Reflectance = 2,  // 1 column per item
+        Illuminant = 3    // 1 column per item
+    };
+
+    /** In-memory dataset handed to saveSpectralDatabase(). */
+    struct Dataset
+    {
+        std::string name;
+        DatasetKind kind = DatasetKind::Generic;
+        SpectralGrid grid;
+        int channels = 1;                // columns per item
+        Eigen::MatrixXf data;            // grid.count x (items.size() * channels)
+        std::vector<std::string> items;  // item names, unique within the dataset
+    };
+
+    /**
+     * Write datasets to a columnar binary file.
+     *
+     * Layout: a 64-byte header (magic "CSSPECDB", version, dataset count,
+     * FNV-1a 64 hash of everything after the header), a directory of
+     * fixed-size dataset entries, then per dataset its float32 column-major
+     * matrix (64-byte aligned), the item-name blob with offsets, and the item
+     * ids sorted by name for binary-search lookup. Throws std::runtime_error.
+     */
+    void saveSpectralDatabase(const std::string& path, const std::vector<Dataset>& datasets);
+
+    /** True if `path` starts with the spectral database magic. */
+    bool isSpectralDatabase(const std::string& path);
+
+    /**
+     * Memory-mapped spectral database. Nothing is parsed on open beyond the
+     * header and directory; matrices are Eigen::Maps into the mapping and
+     * name lookups binary-search the stored index, so curves can be fed to
+     * priors building or rendering without a copy.
+     */
+    class SpectralDatabase
+    {
+    public:
+        using ConstMap = Eigen::Map<const Eigen::MatrixXf>;
+
+        /**
+         * @param verifyHash Hash the whole file on open (touches every page,
+         *                   so off by default for large databases).
+         */
+        explicit SpectralDatabase(const std::string& path, bool verifyHash = false);
+
+        class View
+        {
+        public:
+            const std::string& name() const;
+            DatasetKind kind() const;
+            const SpectralGrid& grid() const;
+            int channels() const;
+            Eigen::Index size() const;  // number of items
+
+            /** Whole dataset: grid.count x (size() * channels()). */
+            ConstMap matrix() const;
+
+            /** One item: grid.count x channels(). */
+            ConstMap item(Eigen::Index i) const;
+            std::string_view itemName(Eigen::Index i) const;
+
+            /** Item index of `itemName`, or -1. */
+            Eigen::Index find(std::string_view itemName) const;
+
+        private:
+            friend class SpectralDatabase;
+            View(const SpectralDatabase* db, size_t index) : m_db(db), m_index(index) {}
+
+            const SpectralDatabase* m_db;
+            size_t m_index;
+        };
+
+        size_t size() const { return m_entries.size(); }
+        View dataset(size_t index) const;
+
+        /** Dataset by name. Throws std::runtime_error if absent. */
+        View dataset(const std::string& name) const;
+        bool hasDataset(const std::string& name) const;
+
+        /** First dataset of `kind`. Throws std::runtime_error if absent. */
+        View first(DatasetKind kind) const;
+
+        /** Sensitivity curves (grid.count x 3) of `camera` from any sensitivity dataset. */
+        ConstMap camera(std::string_view camera, SpectralGrid* grid = nullptr) const;
+
+        std::uint64_t contentHash() const { return m_hash; }
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            DatasetKind kind;
+            SpectralGrid grid;
+            int channels;
+            Eigen::Index items;
+            const float* data;
+            const std::uint64_t* nameOffsets; // items + 1, into names
+            const char* names;
+            const std::uint32_t* sorted;      // item ids ordered by name
+        };
+
+        io::MappedFile m_file;
+        std::vector<Entry> m_entries;
+        std::uint64_t m_hash = 0;
+    };
+} // namespace css::spectral
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace css::io
+{
+    /**
+     * Uncompressed, tiled, interleaved RGB TIFF written one tile at a time.
+     *
+     * Every tile has a fixed size and so a fixed offset, which the header and
+     * tile tables record up front; tiles can then be written in any order,
+     * from any thread, as soon as each is ready, and the image never exists
+     * in memory as a whole. Classic TIFF, so the file must stay below 4 GiB;
+     * 16-bit samples are written in host order, declared little-endian.
+     */
+    class TiledTiffWriter
+    {
+    public:
+        /**
+         * Create `path` for a width x height image of 8- or 16-bit samples in
+         * tiles of tileWidth x tileHeight (multiples of 16, as TIFF requires).
+         * Throws std::runtime_error.
+         */
+        TiledTiffWriter(const std::string& path, int width, int height, int bitsPerSample,
+                        int tileWidth, int tileHeight);
+        ~TiledTiffWriter();
+
+        TiledTiffWriter(const TiledTiffWriter&) = delete;
+        TiledTiffWriter& operator=(const TiledTiffWriter&) = delete;
+
+        int tilesAcross() const { return (m_width + m_tileWidth - 1) / m_tileWidth; }
+        int tilesDown() const { return (m_height + m_tileHeight - 1) / m_tileHeight; }
+        size_t tileBytes() const;
+
+        /**
+         * Write tile (tx, ty): tileHeight rows of tileWidth RGB pixels, rows
+         * `stride` bytes apart. Edge tiles are full size too; samples past
+         * the image edge are ignored by readers. Thread-safe.
+         */
+        void writeTile(int tx, int ty, const void* pixels, size_t stride);
+
+        /** Flush and close; throws std::runtime_error if any write failed. */
+        void close();
+
+    private:
+        std::FILE* m_file = nullptr;
+        std::string m_path;
+        int m_width = 0;
+        int m_height = 0;
+        int m_bitsPerSample = 8;
+        int m_tileWidth = 0;
+        int m_tileHeight = 0;
+        std::uint32_t m_dataOffset = 0;
+        bool m_failed = false;
+        std::mutex m_mutex;
+    };
+} // namespace css::io
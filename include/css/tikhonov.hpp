@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace css::tikhonov
+{
+    enum class LambdaSelection
+    {
+        Fixed,  // use the caller's lambda
+        GCV,    // generalized cross-validation minimum
+        LCurve  // maximum curvature of the (log ||r||, log ||x||) curve
+    };
+
+    /**
+     * Tikhonov regularization path for min ||A X - B||^2 + lambda ||X||^2.
+     *
+     * One thin SVD of A (n x k) is computed up front. After projecting the
+     * right-hand sides once (C = U^T B), every lambda on the path costs O(k)
+     * per column, so GCV / L-curve selection is about as cheap as one solve.
+     */
+    class TikhonovPath
+    {
+    public:
+        struct Projection
+        {
+            Eigen::MatrixXf coeffs;   // U^T B (r x m)
+            float outOfRange = 0.0f;  // ||B - U U^T B||^2, independent of lambda
+            Eigen::Index rows = 0;    // n
+        };
+
+        TikhonovPath() = default;
+        explicit TikhonovPath(const Eigen::MatrixXf& A);
+
+        /**
+         * Path of a system known only through its normal equations, e.g. one
+         * accumulated block by block: A^T A (k x k), A^T B (k x m), ||B||^2
+         * (all columns) and the row count n of A. The eigenvalues of A^T A are
+         * the s^2, and `projection` receives U^T B = S^-1 V^T A^T B with the
+         * out-of-range residual ||B||^2 - ||U^T B||^2. Such a path has no U,
+         * so project() must not be called on it.
+         */
+        static TikhonovPath fromNormalEquations(const Eigen::MatrixXd& AtA,
+                                                const Eigen::MatrixXd& AtB,
+                                                double BtB,
+                                                Eigen::Index rows,
+                                                Projection& projection);
+
+        Projection project(const Eigen::MatrixXf& B) const;
+
+        /** Regularized solution X(lambda) (k x m). lambda = 0 gives the minimum-norm LS solution. */
+        Eigen::MatrixXf solve(const Projection& p, float lambda) const;
+
+        /** ||A X(lambda) - B||^2 summed over columns. */
+        float residual(const Projection& p, float lambda) const;
+
+        /** GCV(lambda) = n ||r||^2 / (n - trace(influence))^2, columns pooled. */
+        float gcv(const Projection& p, float lambda) const;
+
+        /** Curvature of the L-curve at lambda (Hansen's formula, columns pooled). */
+        float lcurveCurvature(const Projection& p, float lambda) const;
+
+        /**
+         * Pick lambda on a log-spaced path spanning the singular value range,
+         * refined by golden-section search around the best grid point.
+         */
+        float selectLambda(const Projection& p,
+                           LambdaSelection method,
+                           float fixedLambda = 0.0f,
+                           int gridSize = 48) const;
+
+        const Eigen::VectorXf& singularValues() const { return m_s; }
+        Eigen::Index rank() const { return m_s.size(); }
+
+    private:
+        Eigen::MatrixXf m_U;  // n x r
+        Eigen::VectorXf m_s;  // r, descending
+        Eigen::MatrixXf m_V;  // k x r
+    };
+} // namespace css::tikhonov
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace css::transfer
+{
+    enum class Curve
+    {
+        Linear,  // no encoding, no clamp
+        Srgb,    // IEC 61966-2-1
+        Rec709,  // ITU-R BT.709 OETF
+        PQ,      // SMPTE ST 2084 inverse EOTF
+        HLG,     // ITU-R BT.2100 HLG OETF
+        Gamma    // v^(1/gamma)
+    };
+
+    /** An encoding curve taking linear values to code values in [0, 1]. */
+    struct TransferFunction
+    {
+        Curve curve = Curve::Srgb;
+        float gamma = 2.2f;          // Gamma only
+        float pqWhiteNits = 203.0f;  // PQ only: nits of linear 1.0 (BT.2408 reference white)
+    };
+
+    /**
+     * "linear", "srgb", "rec709", "pq", "pq:<white nits>", "hlg" or
+     * "gamma:<g>" (plain "gamma" = 2.2). Throws std::runtime_error.
+     */
+    TransferFunction parseTransfer(const std::string& name);
+    std::string transferName(const TransferFunction& tf);
+
+    /**
+     * Reference encoder in double precision with std::pow / std::log. Input
+     * is clamped to the curve's domain: [0, 1] for the display curves,
+     * [0, 10000 / pqWhiteNits] for PQ. Linear passes values through.
+     */
+    double encodeReference(const TransferFunction& tf, double v);
+
+    /**
+     * Inverse of encodeReference(): code values (clamped to [0, 1], except
+     * for Linear) back to linear values.
+     */
+    double decodeReference(const TransferFunction& tf, double code);
+
+    /**
+     * Table encoder for the scalar paths.
+     *
+     * The table (64 KiB) is indexed by the float's exponent and top 8
+     * mantissa bits, i.e. 256 linear segments per octave over [2^-64, 1], so
+     * the steep feet of pure gamma and PQ get as many points as the
+     * shoulder. Lookups interpolate linearly; the linear / sqrt feet below
+     * the sRGB, Rec.709 and HLG knees are evaluated directly. Maximum
+     * absolute error against encodeReference() is below 6e-7 for every
+     * curve, under a tenth of a 16-bit LSB (1.5e-5).
+     */
+    class EncodeLut
+    {
+    public:
+        explicit EncodeLut(const TransferFunction& tf);
+
+        const TransferFunction& function() const { return m_tf; }
+
+        float operator()(float v) const;
+
+        /** Encode `count` values in place. */
+        void apply(float* values, size_t count) const;
+
+    private:
+        TransferFunction m_tf;
+        float m_scale = 1.0f;      // linear value -> curve input
+        float m_knee = 0.0f;       // below: closed-form foot (linear / sqrt)
+        std::vector<float> m_table;
+    };
+} // namespace css::transfer
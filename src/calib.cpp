@@ -34,76 +34,124 @@ namespace css::calib
         return wb;
     }
 
-    CalibResult solveColorMatrix(const std::vector<Eigen::Vector3f>& measuredIn,
-                                 const std::vector<Eigen::Vector3f>& referenceIn,
-                                 bool estimateWb,
-                                 float regularization)
+    namespace
     {
-        if (measuredIn.size() != referenceIn.size() || measuredIn.empty())
+        CalibResult solve(const std::vector<Eigen::Vector3f>& measuredIn,
+                          const std::vector<Eigen::Vector3f>& referenceIn,
+                          bool estimateWb,
+                          tikhonov::LambdaSelection selection,
+                          float regularization,
+                          profile::Model model)
         {
-            throw std::runtime_error("solveColorMatrix: mismatched or empty inputs");
-        }
+            if (measuredIn.size() != referenceIn.size() || measuredIn.empty())
+            {
+                throw std::runtime_error("solveColorMatrix: mismatched or empty inputs");
+            }
 
-        const size_t n = measuredIn.size();
+            const size_t n = measuredIn.size();
 
-        Eigen::Vector3f wb = Eigen::Vector3f::Ones();
-        if (estimateWb)
-        {
-            wb = estimateWhiteBalance(measuredIn);
-        }
+            Eigen::Vector3f wb = Eigen::Vector3f::Ones();
+            if (estimateWb)
+            {
+                wb = estimateWhiteBalance(measuredIn);
+            }
 
-        // Apply white balance to measured values.
-        std::vector<Eigen::Vector3f> measured(n);
-        for (size_t i = 0; i < n; ++i)
-        {
-            measured[i] = measuredIn[i].cwiseProduct(wb);
-        }
+            // Apply white balance to measured values.
+            std::vector<Eigen::Vector3f> measured(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                measured[i] = measuredIn[i].cwiseProduct(wb);
+            }
 
-        Eigen::MatrixXf A(n, 3);
-        Eigen::MatrixXf B(n, 3);
+            // One column per model term: r, g, b, then the root terms.
+            const int terms = profile::termCount(model);
+            auto features = [&](const Eigen::Vector3f& rgb) {
+                Eigen::VectorXf f(terms);
+                f.head<3>() = rgb;
+                f.tail(terms - 3) = profile::rootTerms(rgb, model).head(terms - 3);
+                return f;
+            };
 
-        for (size_t i = 0; i < n; ++i)
-        {
-            A(static_cast<int>(i), 0) = measured[i][0];
-            A(static_cast<int>(i), 1) = measured[i][1];
-            A(static_cast<int>(i), 2) = measured[i][2];
+            Eigen::MatrixXf A(n, terms);
+            Eigen::MatrixXf B(n, 3);
 
-            B(static_cast<int>(i), 0) = referenceIn[i][0];
-            B(static_cast<int>(i), 1) = referenceIn[i][1];
-            B(static_cast<int>(i), 2) = referenceIn[i][2];
-        }
+            for (size_t i = 0; i < n; ++i)
+            {
+                A.row(static_cast<int>(i)) = features(measured[i]).transpose();
 
-        // Regularized least squares: (A^T A + λI) M^T = A^T B
-        Eigen::Matrix3f AtA = A.transpose() * A;
-        AtA += regularization * Eigen::Matrix3f::Identity();
+                B(static_cast<int>(i), 0) = referenceIn[i][0];
+                B(static_cast<int>(i), 1) = referenceIn[i][1];
+                B(static_cast<int>(i), 2) = referenceIn[i][2];
+            }
 
-        Eigen::Matrix3f AtB = A.transpose() * B;
+            Eigen::MatrixXf M;
+            if (selection == tikhonov::LambdaSelection::Fixed)
+            {
+                // Regularized least squares: (A^T A + λI) M^T = A^T B, in
+                // double: the root terms are strongly correlated, and A^T A
+                // squares a condition number float cannot carry.
+                const Eigen::MatrixXd Ad = A.cast<double>();
+                Eigen::MatrixXd AtA = Ad.transpose() * Ad;
+                AtA += static_cast<double>(regularization) * Eigen::MatrixXd::Identity(terms, terms);
+
+                Eigen::MatrixXd AtB = Ad.transpose() * B.cast<double>();
+
+                // Use LDLT decomposition for solving (more stable than direct inverse)
+                Eigen::LDLT<Eigen::MatrixXd> ldlt(AtA);
+                M = ldlt.solve(AtB).transpose().cast<float>(); // rows: target channels
+            }
+            else
+            {
+                // Same objective, lambda picked on the path from one SVD of A.
+                tikhonov::TikhonovPath path(A);
+                auto proj = path.project(B);
+                regularization = path.selectLambda(proj, selection);
+                M = path.solve(proj, regularization).transpose();
+            }
 
-        // Use LDLT decomposition for solving (more stable than direct inverse)
-        Eigen::LDLT<Eigen::Matrix3f> ldlt(AtA);
-        Eigen::Matrix3f M = ldlt.solve(AtB).transpose(); // rows: target channels
+            // Compute errors.
+            std::vector<float> perPatch;
+            perPatch.reserve(n);
+            float sumSq = 0.0f;
 
-        // Compute errors.
-        std::vector<float> perPatch;
-        perPatch.reserve(n);
-        float sumSq = 0.0f;
+            for (size_t i = 0; i < n; ++i)
+            {
+                Eigen::Vector3f pred = M * features(measured[i]);
+                Eigen::Vector3f diff = pred - referenceIn[i];
+                float e = diff.norm();
+                perPatch.push_back(e);
+                sumSq += e * e;
+            }
 
-        for (size_t i = 0; i < n; ++i)
-        {
-            Eigen::Vector3f pred = M * measured[i];
-            Eigen::Vector3f diff = pred - referenceIn[i];
-            float e = diff.norm();
-            perPatch.push_back(e);
-            sumSq += e * e;
+            CalibResult res;
+            res.colorMatrix = M.leftCols<3>();
+            res.model = model;
+            res.rootMatrix.leftCols(terms - 3) = M.rightCols(terms - 3);
+            res.whiteBalance = wb;
+            res.regularization = regularization;
+            res.perPatchError = std::move(perPatch);
+            res.rmsError = std::sqrt(sumSq / static_cast<float>(n));
+
+            return res;
         }
+    } // namespace
 
-        CalibResult res;
-        res.colorMatrix = M;
-        res.whiteBalance = wb;
-        res.perPatchError = std::move(perPatch);
-        res.rmsError = std::sqrt(sumSq / static_cast<float>(n));
+    CalibResult solveColorMatrix(const std::vector<Eigen::Vector3f>& measured,
+                                 const std::vector<Eigen::Vector3f>& reference,
+                                 bool estimateWb,
+                                 float regularization,
+                                 profile::Model model)
+    {
+        return solve(measured, reference, estimateWb, tikhonov::LambdaSelection::Fixed, regularization, model);
+    }
 
-        return res;
+    CalibResult solveColorMatrix(const std::vector<Eigen::Vector3f>& measured,
+                                 const std::vector<Eigen::Vector3f>& reference,
+                                 bool estimateWb,
+                                 tikhonov::LambdaSelection selection,
+                                 profile::Model model)
+    {
+        return solve(measured, reference, estimateWb, selection, 0.0f, model);
     }
 } // namespace css::calib
 
@@ -245,6 +245,23 @@ namespace css::chart
                     medianOf(valsG),
                     medianOf(valsR));
 
+                auto stdOf = [](const std::vector<float>& v, double m) -> float {
+                    if (v.size() < 2)
+                        return 0.0f;
+                    double acc = 0.0;
+                    for (float x : v)
+                    {
+                        acc += (x - m) * (x - m);
+                    }
+                    return static_cast<float>(std::sqrt(acc / static_cast<double>(v.size() - 1)));
+                };
+
+                s.stdBgr = cv::Vec3f(
+                    stdOf(valsB, mean[0]),
+                    stdOf(valsG, mean[1]),
+                    stdOf(valsR, mean[2]));
+                s.pixelCount = static_cast<int>(valsB.size());
+
                 samples.push_back(s);
             }
         }
@@ -0,0 +1,402 @@
+#include "css/color_kernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(CAMSPEC_X86_KERNELS)
+#include "simd/color_kernel_impl.hpp"
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace css::kernel
+{
+#if defined(CAMSPEC_X86_KERNELS)
+    static_assert(static_cast<int>(transfer::Curve::Linear) == detail::kLinear &&
+                  static_cast<int>(transfer::Curve::Srgb) == detail::kSrgb &&
+                  static_cast<int>(transfer::Curve::Rec709) == detail::kRec709 &&
+                  static_cast<int>(transfer::Curve::PQ) == detail::kPQ &&
+                  static_cast<int>(transfer::Curve::HLG) == detail::kHLG &&
+                  static_cast<int>(transfer::Curve::Gamma) == detail::kGamma,
+                  "detail::CurveId must mirror transfer::Curve");
+#endif
+
+    namespace
+    {
+        Isa cpuIsa()
+        {
+#if defined(CAMSPEC_X86_KERNELS) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool sse42 = (info[2] & (1 << 20)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            if (!sse42)
+                return Isa::Scalar;
+            if (!osxsave || maxLeaf < 7)
+                return Isa::SSE42;
+
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            const bool avx2 = (info[1] & (1 << 5)) != 0 && fma && (xcr0 & 0x6) == 0x6;
+            const bool avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+            if (avx512 && avx2)
+                return Isa::AVX512;
+            return avx2 ? Isa::AVX2 : Isa::SSE42;
+#elif defined(CAMSPEC_X86_KERNELS)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Isa::AVX512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Isa::AVX2;
+            if (__builtin_cpu_supports("sse4.2"))
+                return Isa::SSE42;
+            return Isa::Scalar;
+#else
+            return Isa::Scalar;
+#endif
+        }
+
+        Isa cappedIsa()
+        {
+            Isa isa = cpuIsa();
+            if (const char* env = std::getenv("CAMSPEC_ISA"))
+            {
+                Isa cap = isa;
+                if (std::strcmp(env, "scalar") == 0) cap = Isa::Scalar;
+                else if (std::strcmp(env, "sse4.2") == 0) cap = Isa::SSE42;
+                else if (std::strcmp(env, "avx2") == 0) cap = Isa::AVX2;
+                else if (std::strcmp(env, "avx512") == 0) cap = Isa::AVX512;
+                isa = std::min(isa, cap);
+            }
+            return isa;
+        }
+
+        void encodeScalar(const ColorTransform& t, float* values, size_t count)
+        {
+            if (t.lut)
+            {
+                t.lut->apply(values, count);
+                return;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                values[i] = static_cast<float>(transfer::encodeReference(t.encoding, values[i]));
+            }
+        }
+
+        // m: 3 x termCount(t.model), row-major, as for the SIMD kernels.
+        void applyRowsScalar(const float* m, const ColorTransform& t, const float* in, float* out, size_t count)
+        {
+            const int terms = profile::termCount(t.model);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float c0 = in[3 * i];
+                const float c1 = in[3 * i + 1];
+                const float c2 = in[3 * i + 2];
+                float o[3];
+                for (int r = 0; r < 3; ++r)
+                {
+                    const float* k = m + terms * r;
+                    o[r] = k[0] * c0 + k[1] * c1 + k[2] * c2;
+                }
+                if (terms > 3)
+                {
+                    const auto roots = profile::rootTerms(Eigen::Vector3f(c2, c1, c0), t.model);
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        for (int j = 3; j < terms; ++j)
+                        {
+                            o[r] += m[terms * r + j] * roots[j - 3];
+                        }
+                    }
+                }
+                out[3 * i] = o[0];
+                out[3 * i + 1] = o[1];
+                out[3 * i + 2] = o[2];
+            }
+            if (t.encoding.curve != transfer::Curve::Linear)
+            {
+                encodeScalar(t, out, 3 * count);
+            }
+        }
+
+        // Chunk of a row encoded in float before quantizing (3 KiB).
+        constexpr size_t kQuantizeChunk = 256;
+
+        template <class T>
+        void applyRowQuantized(const ColorTransform& t, const float* in, T* out, size_t count, Isa isa)
+        {
+            constexpr float maxCode = static_cast<float>(std::numeric_limits<T>::max());
+            float buffer[3 * kQuantizeChunk];
+            for (size_t i = 0; i < count; i += kQuantizeChunk)
+            {
+                const size_t n = std::min(kQuantizeChunk, count - i);
+                applyRow(t, in + 3 * i, buffer, n, isa);
+                T* dst = out + 3 * i;
+                for (size_t k = 0; k < 3 * n; ++k)
+                {
+                    const float v = buffer[k] > 0.0f ? std::min(buffer[k], 1.0f) : 0.0f; // NaN -> 0
+                    dst[k] = static_cast<T>(v * maxCode + 0.5f);
+                }
+            }
+        }
+
+        // 16-bit linear codes of `count` pixels.
+        void linearCodes(const FixedTransform& t, const std::uint16_t* in, std::uint16_t* out, size_t count, Isa isa)
+        {
+#if defined(CAMSPEC_X86_KERNELS)
+            detail::FixedMatrix f;
+            std::copy(t.matrix, t.matrix + 9, f.m);
+            f.inputMax = t.inputMax;
+            f.inputShift = t.inputShift;
+            f.fracBits = t.fracBits;
+#endif
+
+            switch (std::min(isa, detectIsa()))
+            {
+#if defined(CAMSPEC_X86_KERNELS)
+            case Isa::AVX512:
+            case Isa::AVX2:
+                detail::applyFixedRowsAvx2(f, in, out, count);
+                return;
+            case Isa::SSE42:
+                detail::applyFixedRowsSse42(f, in, out, count);
+                return;
+#endif
+            default:
+                break;
+            }
+
+            const std::int32_t rounding = 1 << (t.fracBits - 1);
+            const std::int16_t* m = t.matrix;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const std::int32_t c0 = std::min(in[3 * i], t.inputMax) >> t.inputShift;
+                const std::int32_t c1 = std::min(in[3 * i + 1], t.inputMax) >> t.inputShift;
+                const std::int32_t c2 = std::min(in[3 * i + 2], t.inputMax) >> t.inputShift;
+                for (int r = 0; r < 3; ++r)
+                {
+                    const std::int32_t sum = m[3 * r] * c0 + m[3 * r + 1] * c1 + m[3 * r + 2] * c2 + rounding;
+                    out[3 * i + r] = static_cast<std::uint16_t>(sum <= 0 ? 0 : std::min(sum >> t.fracBits, 65535));
+                }
+            }
+        }
+    } // namespace
+
+    Isa detectIsa()
+    {
+        static const Isa isa = cappedIsa();
+        return isa;
+    }
+
+    const char* isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::SSE42: return "sse4.2";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512: return "avx512";
+        default: return "scalar";
+        }
+    }
+
+    ColorTransform makeTransform(const profile::Profile& prof, const transfer::TransferFunction& encoding)
+    {
+        // Reverse rows and columns: the image rows are BGR, the profile RGB.
+        const Eigen::Matrix3f rgb = prof.colorMatrix * prof.whiteBalance.asDiagonal();
+
+        ColorTransform t;
+        t.matrix = rgb.colwise().reverse().rowwise().reverse();
+        t.encoding = encoding;
+
+        // Root terms of the balanced input are those of the raw input times
+        // the terms of the gains; the term order is fixed, only rows flip.
+        t.model = prof.model;
+        if (prof.model != profile::Model::Linear)
+        {
+            const Eigen::Matrix<float, 3, profile::kMaxRootTerms> roots =
+                prof.rootMatrix * profile::rootTerms(prof.whiteBalance, prof.model).asDiagonal();
+            t.roots = roots.colwise().reverse();
+        }
+        if (encoding.curve != transfer::Curve::Linear)
+        {
+            t.lut = std::make_shared<const transfer::EncodeLut>(encoding);
+        }
+        return t;
+    }
+
+    void applyRow(const ColorTransform& t, const float* in, float* out, size_t count, Isa isa)
+    {
+        // 3 x terms, row-major: the matrix, then the root coefficients.
+        const int terms = profile::termCount(t.model);
+        float m[3 * (3 + profile::kMaxRootTerms)];
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int c = 0; c < terms; ++c)
+            {
+                m[terms * r + c] = c < 3 ? t.matrix(r, c) : t.roots(r, c - 3);
+            }
+        }
+
+        isa = std::min(isa, detectIsa());
+#if defined(CAMSPEC_X86_KERNELS)
+        detail::Encoding e;
+        e.curve = static_cast<int>(t.encoding.curve);
+        e.scale = t.encoding.pqWhiteNits / 10000.0f;
+        e.exponent = 1.0f / t.encoding.gamma;
+#endif
+
+        switch (isa)
+        {
+#if defined(CAMSPEC_X86_KERNELS)
+        case Isa::AVX512:
+            detail::applyRowsAvx512(m, terms, e, in, out, count);
+            return;
+        case Isa::AVX2:
+            detail::applyRowsAvx2(m, terms, e, in, out, count);
+            return;
+        case Isa::SSE42:
+            // Four lanes without FMA lose to the table on every curve but
+            // HLG, so SSE4.2 runs the matrix only and encodes the row after.
+            if (e.curve != detail::kLinear && e.curve != detail::kHLG)
+            {
+                detail::Encoding linear;
+                detail::applyRowsSse42(m, terms, linear, in, out, count);
+                encodeScalar(t, out, 3 * count);
+                return;
+            }
+            detail::applyRowsSse42(m, terms, e, in, out, count);
+            return;
+#endif
+        default:
+            applyRowsScalar(m, t, in, out, count);
+            return;
+        }
+    }
+
+    void applyRow(const ColorTransform& t, const float* in, std::uint16_t* out, size_t count, Isa isa)
+    {
+        applyRowQuantized(t, in, out, count, isa);
+    }
+
+    void applyRow(const ColorTransform& t, const float* in, std::uint8_t* out, size_t count, Isa isa)
+    {
+        applyRowQuantized(t, in, out, count, isa);
+    }
+
+    FixedTransform makeFixedTransform(const profile::Profile& prof, const transfer::TransferFunction& encoding,
+                                      float whiteLevel, int outputBits)
+    {
+        return makeFixedTransform(makeTransform(prof, encoding), whiteLevel, outputBits);
+    }
+
+    FixedTransform makeFixedTransform(const ColorTransform& transform, float whiteLevel, int outputBits)
+    {
+        const transfer::TransferFunction& encoding = transform.encoding;
+        if (outputBits != 8 && outputBits != 16)
+        {
+            throw std::runtime_error("Fixed-point output must be 8 or 16 bits");
+        }
+        if (transform.model != profile::Model::Linear)
+        {
+            throw std::runtime_error("The fixed-point path supports linear (3x3) profiles only");
+        }
+
+        FixedTransform t;
+        t.outputBits = outputBits;
+        const float white = std::clamp(whiteLevel, 1.0f, 65535.0f);
+        t.inputMax = static_cast<std::uint16_t>(std::ceil(white));
+        while ((t.inputMax >> t.inputShift) > 32767)
+        {
+            ++t.inputShift;
+        }
+
+        // Shifted input codes -> 16-bit linear codes, with the most fractional
+        // bits for which every coefficient fits int16 and no row sum overflows.
+        const Eigen::Matrix3f m = transform.matrix * (65535.0f * static_cast<float>(1 << t.inputShift) / white);
+        const std::int64_t inputMax = t.inputMax >> t.inputShift;
+        for (t.fracBits = 14; t.fracBits > 0; --t.fracBits)
+        {
+            bool fits = true;
+            for (int r = 0; r < 3 && fits; ++r)
+            {
+                std::int64_t sum = std::int64_t(1) << (t.fracBits - 1);
+                for (int c = 0; c < 3; ++c)
+                {
+                    const long q = std::lround(m(r, c) * static_cast<float>(1 << t.fracBits));
+                    fits = fits && q >= -32767 && q <= 32767;
+                    t.matrix[3 * r + c] = static_cast<std::int16_t>(q);
+                    sum += std::abs(q) * inputMax;
+                }
+                fits = fits && sum <= std::numeric_limits<std::int32_t>::max();
+            }
+            if (fits)
+            {
+                break;
+            }
+        }
+        if (t.fracBits == 0)
+        {
+            throw std::runtime_error("Profile matrix too large for the fixed-point path");
+        }
+
+        if (outputBits == 8 || encoding.curve != transfer::Curve::Linear)
+        {
+            const double maxCode = outputBits == 8 ? 255.0 : 65535.0;
+            auto lut = std::make_shared<std::vector<std::uint16_t>>(65536);
+            for (size_t i = 0; i < lut->size(); ++i)
+            {
+                const double v = transfer::encodeReference(encoding, static_cast<double>(i) / 65535.0);
+                (*lut)[i] = static_cast<std::uint16_t>(std::clamp(v, 0.0, 1.0) * maxCode + 0.5);
+            }
+            t.lut = std::move(lut);
+        }
+        return t;
+    }
+
+    void applyRowFixed(const FixedTransform& t, const std::uint16_t* in, std::uint16_t* out, size_t count, Isa isa)
+    {
+        if (t.outputBits != 16)
+        {
+            throw std::runtime_error("applyRowFixed: transform built for 8-bit output");
+        }
+        linearCodes(t, in, out, count, isa);
+        if (t.lut)
+        {
+            const std::uint16_t* lut = t.lut->data();
+            for (size_t k = 0; k < 3 * count; ++k)
+            {
+                out[k] = lut[out[k]];
+            }
+        }
+    }
+
+    void applyRowFixed(const FixedTransform& t, const std::uint16_t* in, std::uint8_t* out, size_t count, Isa isa)
+    {
+        if (t.outputBits != 8)
+        {
+            throw std::runtime_error("applyRowFixed: transform built for 16-bit output");
+        }
+        const std::uint16_t* lut = t.lut->data();
+        std::uint16_t buffer[3 * kQuantizeChunk];
+        for (size_t i = 0; i < count; i += kQuantizeChunk)
+        {
+            const size_t n = std::min(kQuantizeChunk, count - i);
+            linearCodes(t, in + 3 * i, buffer, n, isa);
+            std::uint8_t* dst = out + 3 * i;
+            for (size_t k = 0; k < 3 * n; ++k)
+            {
+                dst[k] = static_cast<std::uint8_t>(lut[buffer[k]]);
+            }
+        }
+    }
+} // namespace css::kernel
@@ -0,0 +1,131 @@
+#include "css/colorimetry.hpp"
+#include "css/resample.hpp"
+
+#include <stdexcept>
+#include <Eigen/LU>
+
+namespace css::colorimetry
+{
+    namespace
+    {
+        constexpr int kCmfBands = 41;
+
+        // CIE 1931 2° color-matching functions x̄, ȳ, z̄ for 380-780nm @ 10nm
+        // Source: ISO/CIE 11664-1 (10nm subset of the 1nm table)
+        constexpr float kCie1931[kCmfBands][3] = {
+            { 0.001368f, 0.000039f, 0.006450f }, // 380
+            { 0.004243f, 0.000120f, 0.020050f }, // 390
+            { 0.014310f, 0.000396f, 0.067850f }, // 400
+            { 0.043510f, 0.001210f, 0.207400f }, // 410
+            { 0.134380f, 0.004000f, 0.645600f }, // 420
+            { 0.283900f, 0.011600f, 1.385600f }, // 430
+            { 0.348280f, 0.023000f, 1.747060f }, // 440
+            { 0.336200f, 0.038000f, 1.772110f }, // 450
+            { 0.290800f, 0.060000f, 1.669200f }, // 460
+            { 0.195360f, 0.090980f, 1.287640f }, // 470
+            { 0.095640f, 0.139020f, 0.812950f }, // 480
+            { 0.032010f, 0.208020f, 0.465180f }, // 490
+            { 0.004900f, 0.323000f, 0.272000f }, // 500
+            { 0.009300f, 0.503000f, 0.158200f }, // 510
+            { 0.063270f, 0.710000f, 0.078250f }, // 520
+            { 0.165500f, 0.862000f, 0.042160f }, // 530
+            { 0.290400f, 0.954000f, 0.020300f }, // 540
+            { 0.433450f, 0.994950f, 0.008750f }, // 550
+            { 0.594500f, 0.995000f, 0.003900f }, // 560
+            { 0.762100f, 0.952000f, 0.002100f }, // 570
+            { 0.916300f, 0.870000f, 0.001650f }, // 580
+            { 1.026300f, 0.757000f, 0.001100f }, // 590
+            { 1.062200f, 0.631000f, 0.000800f }, // 600
+            { 1.002600f, 0.503000f, 0.000340f }, // 610
+            { 0.854450f, 0.381000f, 0.000190f }, // 620
+            { 0.642400f, 0.265000f, 0.000050f }, // 630
+            { 0.447900f, 0.175000f, 0.000020f }, // 640
+            { 0.283500f, 0.107000f, 0.000000f }, // 650
+            { 0.164900f, 0.061000f, 0.000000f }, // 660
+            { 0.087400f, 0.032000f, 0.000000f }, // 670
+            { 0.046770f, 0.017000f, 0.000000f }, // 680
+            { 0.022700f, 0.008210f, 0.000000f }, // 690
+            { 0.011359f, 0.004102f, 0.000000f }, // 700
+            { 0.005790f, 0.002091f, 0.000000f }, // 710
+            { 0.002899f, 0.001047f, 0.000000f }, // 720
+            { 0.001440f, 0.000520f, 0.000000f }, // 730
+            { 0.000690f, 0.000249f, 0.000000f }, // 740
+            { 0.000332f, 0.000120f, 0.000000f }, // 750
+            { 0.000166f, 0.000060f, 0.000000f }, // 760
+            { 0.000083f, 0.000030f, 0.000000f }, // 770
+            { 0.000042f, 0.000015f, 0.000000f }, // 780
+        };
+    } // namespace
+
+    spectral::SpectralGrid cmfGrid()
+    {
+        return spectral::SpectralGrid::range(380.0f, 780.0f, 10.0f);
+    }
+
+    Eigen::MatrixXf cie1931(const spectral::SpectralGrid& grid)
+    {
+        Eigen::MatrixXf table = Eigen::Map<const Eigen::Matrix<float, kCmfBands, 3, Eigen::RowMajor>>(&kCie1931[0][0]);
+        return spectral::resample(table, cmfGrid(), grid);
+    }
+
+    Eigen::Matrix3f xyzToLinearSrgb()
+    {
+        Eigen::Matrix3f m;
+        m <<  3.2404542f, -1.5371385f, -0.4985314f,
+             -0.9692660f,  1.8760108f,  0.0415560f,
+              0.0556434f, -0.2040259f,  1.0572252f;
+        return m;
+    }
+
+    Eigen::Vector3f d65White()
+    {
+        return Eigen::Vector3f(0.95047f, 1.0f, 1.08883f);
+    }
+
+    Eigen::Vector3f d50White()
+    {
+        return Eigen::Vector3f(0.96422f, 1.0f, 0.82521f);
+    }
+
+    Eigen::Matrix3f bradfordAdaptation(const Eigen::Vector3f& srcWhite, const Eigen::Vector3f& dstWhite)
+    {
+        // XYZ -> sharpened cone response (Lam 1985).
+        Eigen::Matrix3f bradford;
+        bradford <<  0.8951f,  0.2664f, -0.1614f,
+                    -0.7502f,  1.7135f,  0.0367f,
+                     0.0389f, -0.0685f,  1.0296f;
+
+        Eigen::Vector3f src = bradford * srcWhite;
+        Eigen::Vector3f dst = bradford * dstWhite;
+        if (!(src.cwiseAbs().minCoeff() > 0.0f))
+        {
+            throw std::runtime_error("bradfordAdaptation: degenerate source white.");
+        }
+        return bradford.inverse() * dst.cwiseQuotient(src).asDiagonal() * bradford;
+    }
+
+    Eigen::Vector3f whitePoint(const Eigen::VectorXf& spd, const spectral::SpectralGrid& grid)
+    {
+        if (spd.size() != grid.count)
+        {
+            throw std::runtime_error("whitePoint: SPD does not match the spectral grid.");
+        }
+
+        Eigen::Vector3f xyz = cie1931(grid).transpose() * spd;
+        if (!(xyz.y() > 0.0f))
+        {
+            throw std::runtime_error("whitePoint: SPD has no luminance.");
+        }
+        return xyz / xyz.y();
+    }
+
+    Eigen::Vector2f chromaticity(const Eigen::Vector3f& xyz)
+    {
+        float sum = xyz.sum();
+        if (sum == 0.0f)
+        {
+            return Eigen::Vector2f::Zero();
+        }
+        return Eigen::Vector2f(xyz.x() / sum, xyz.y() / sum);
+    }
+} // namespace css::colorimetry
@@ -0,0 +1,175 @@
+#include "css/colorspace.hpp"
+#include "css/colorimetry.hpp"
+
+#include <stdexcept>
+#include <Eigen/LU>
+
+namespace css::colorspace
+{
+    namespace
+    {
+        struct Primaries
+        {
+            const char* name;
+            float rx, ry, gx, gy, bx, by;
+            float wx, wy; // white; 0 = D65
+        };
+
+        // ITU-R BT.709 / BT.2020, SMPTE EG 432-1 (Display P3), SMPTE ST 2065-1
+        // and S-2014-004 (ACES; white is the ACES "D60").
+        constexpr Primaries kPrimaries[] = {
+            {"linear_rec2020", 0.708f, 0.292f, 0.170f, 0.797f, 0.131f, 0.046f, 0.0f, 0.0f},
+            {"linear_p3", 0.680f, 0.320f, 0.265f, 0.690f, 0.150f, 0.060f, 0.0f, 0.0f},
+            {"aces_ap0", 0.7347f, 0.2653f, 0.0f, 1.0f, 0.0001f, -0.0770f, 0.32168f, 0.33767f},
+            {"aces_ap1", 0.713f, 0.293f, 0.165f, 0.830f, 0.128f, 0.044f, 0.32168f, 0.33767f},
+        };
+
+        // XYZ -> CAT16 cone response.
+        Eigen::Matrix3f cat16Matrix()
+        {
+            Eigen::Matrix3f m;
+            m <<  0.401288f, 0.650173f, -0.051461f,
+                 -0.250268f, 1.204414f,  0.045854f,
+                 -0.002079f, 0.048952f,  0.953127f;
+            return m;
+        }
+    } // namespace
+
+    Eigen::Vector3f whiteFromXy(const Eigen::Vector2f& xy)
+    {
+        if (!(xy.y() > 0.0f))
+        {
+            throw std::runtime_error("whiteFromXy: y must be positive");
+        }
+        return Eigen::Vector3f(xy.x() / xy.y(), 1.0f, (1.0f - xy.x() - xy.y()) / xy.y());
+    }
+
+    Eigen::Matrix3f primariesToXyz(const Eigen::Vector2f& red, const Eigen::Vector2f& green,
+                                   const Eigen::Vector2f& blue, const Eigen::Vector3f& white)
+    {
+        // Columns: primaries at unit luminance, then scaled so RGB 1 is the white.
+        Eigen::Matrix3f p;
+        for (int c = 0; c < 3; ++c)
+        {
+            const Eigen::Vector2f& xy = c == 0 ? red : (c == 1 ? green : blue);
+            p(0, c) = xy.x();
+            p(1, c) = xy.y();
+            p(2, c) = 1.0f - xy.x() - xy.y();
+        }
+        Eigen::FullPivLU<Eigen::Matrix3f> lu(p);
+        if (!lu.isInvertible())
+        {
+            throw std::runtime_error("primariesToXyz: primaries are collinear");
+        }
+        const Eigen::Vector3f scale = lu.solve(white);
+        return p * scale.asDiagonal();
+    }
+
+    ColorSpace find(const std::string& name)
+    {
+        ColorSpace space;
+        space.name = name;
+        if (name == "linear_srgb")
+        {
+            space.white = colorimetry::d65White();
+            space.fromXyz = colorimetry::xyzToLinearSrgb();
+            space.toXyz = space.fromXyz.inverse();
+            return space;
+        }
+        if (name == "xyz_d65" || name == "xyz_d50")
+        {
+            space.white = name == "xyz_d65" ? colorimetry::d65White() : colorimetry::d50White();
+            return space;
+        }
+        for (const Primaries& p : kPrimaries)
+        {
+            if (name == p.name)
+            {
+                space.white = p.wx > 0.0f ? whiteFromXy({p.wx, p.wy}) : colorimetry::d65White();
+                space.toXyz = primariesToXyz({p.rx, p.ry}, {p.gx, p.gy}, {p.bx, p.by}, space.white);
+                space.fromXyz = space.toXyz.inverse();
+                return space;
+            }
+        }
+        throw std::runtime_error("Unknown color space: " + name);
+    }
+
+    std::vector<std::string> names()
+    {
+        std::vector<std::string> all{"linear_srgb"};
+        for (const Primaries& p : kPrimaries)
+        {
+            all.emplace_back(p.name);
+        }
+        all.emplace_back("xyz_d65");
+        all.emplace_back("xyz_d50");
+        return all;
+    }
+
+    Cat parseCat(const std::string& name)
+    {
+        if (name == "none")
+            return Cat::None;
+        if (name == "bradford")
+            return Cat::Bradford;
+        if (name == "cat16")
+            return Cat::Cat16;
+        throw std::runtime_error("Unknown chromatic adaptation: " + name + " (expected none, bradford or cat16)");
+    }
+
+    const char* catName(Cat cat)
+    {
+        switch (cat)
+        {
+        case Cat::None: return "none";
+        case Cat::Cat16: return "cat16";
+        default: return "bradford";
+        }
+    }
+
+    Eigen::Matrix3f adaptation(const Eigen::Vector3f& srcWhite, const Eigen::Vector3f& dstWhite, Cat cat)
+    {
+        if (cat == Cat::None)
+        {
+            return Eigen::Matrix3f::Identity();
+        }
+        if (cat == Cat::Bradford)
+        {
+            return colorimetry::bradfordAdaptation(srcWhite, dstWhite);
+        }
+
+        const Eigen::Matrix3f m = cat16Matrix();
+        const Eigen::Vector3f src = m * srcWhite;
+        const Eigen::Vector3f dst = m * dstWhite;
+        if (!(src.cwiseAbs().minCoeff() > 0.0f))
+        {
+            throw std::runtime_error("adaptation: degenerate source white");
+        }
+        return m.inverse() * dst.cwiseQuotient(src).asDiagonal() * m;
+    }
+
+    Eigen::Matrix3f conversion(const ColorSpace& from, const ColorSpace& to, Cat cat)
+    {
+        if (from.name == to.name)
+        {
+            return Eigen::Matrix3f::Identity();
+        }
+        const bool sameWhite = (from.white - to.white).cwiseAbs().maxCoeff() < 1e-6f;
+        const Eigen::Matrix3f adapt = sameWhite ? Eigen::Matrix3f::Identity() : adaptation(from.white, to.white, cat);
+        return to.fromXyz * adapt * from.toXyz;
+    }
+
+    profile::Profile retarget(const profile::Profile& prof, const std::string& space, Cat cat)
+    {
+        const ColorSpace from = find(prof.targetColorSpace.empty() ? "linear_srgb" : prof.targetColorSpace);
+        const ColorSpace to = find(space);
+        const Eigen::Matrix3f c = conversion(from, to, cat);
+
+        // The conversion acts on the output, so it composes with both parts.
+        profile::Profile out = prof;
+        out.colorMatrix = c * prof.colorMatrix;
+        out.rootMatrix = c * prof.rootMatrix;
+        out.targetColorSpace = to.name;
+        return out;
+    }
+} // namespace css::colorspace
@@ -1,90 +1,59 @@
 #include "css/daylight.hpp"
+#include "css/embedded_data.hpp"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace css::daylight
 {
-    DaylightGenerator::DaylightGenerator()
+    // Judd et al. daylight basis S0, S1, S2 for 400-720nm @ 10nm, embedded from
+    // data/cie_daylight_basis.csv at build time.
+    static_assert(embedded::kDaylightBasisBands == DaylightGenerator::kNumBands &&
+                      embedded::kDaylightBasisStart == 400.0f && embedded::kDaylightBasisStep == 10.0f,
+                  "data/cie_daylight_basis.csv must cover 400-720nm @ 10nm");
+
+    DaylightGenerator::DaylightGenerator(float cctMin, float cctMax, float cctStep)
+        : m_basis(Eigen::Map<const Eigen::Matrix<float, kNumBands, 3, Eigen::RowMajor>>(&embedded::kDaylightBasis[0][0]))
     {
-        // Initialize basis vectors S0, S1, S2 for 400-720nm @ 10nm
-        // Source: daylightScalars.txt from reference/MATLAB code
-        m_basis.resize(33, 3);
-        
-        // Data format: S0, S1, S2 (ignoring wavelength column which is implicit 400+10*i)
-        // 400
-        m_basis.row(0) << 94.8f, 43.4f, -1.1f;
-        // 410
-        m_basis.row(1) << 104.8f, 46.3f, -0.5f;
-        // 420
-        m_basis.row(2) << 105.9f, 43.9f, -0.7f;
-        // 430
-        m_basis.row(3) << 96.8f, 37.1f, -1.2f;
-        // 440
-        m_basis.row(4) << 113.9f, 36.7f, -2.6f;
-        // 450
-        m_basis.row(5) << 125.6f, 35.9f, -2.9f;
-        // 460
-        m_basis.row(6) << 125.5f, 32.6f, -2.8f;
-        // 470
-        m_basis.row(7) << 121.3f, 27.9f, -2.6f;
-        // 480
-        m_basis.row(8) << 121.3f, 24.3f, -2.6f;
-        // 490
-        m_basis.row(9) << 113.5f, 20.1f, -1.8f;
-        // 500
-        m_basis.row(10) << 113.1f, 16.2f, -1.5f;
-        // 510
-        m_basis.row(11) << 110.8f, 13.2f, -1.3f;
-        // 520
-        m_basis.row(12) << 106.5f, 8.6f, -1.2f;
-        // 530
-        m_basis.row(13) << 108.8f, 6.1f, -1.0f;
-        // 540
-        m_basis.row(14) << 105.3f, 4.2f, -0.5f;
-        // 550
-        m_basis.row(15) << 104.4f, 1.9f, -0.3f;
-        // 560
-        m_basis.row(16) << 100.0f, 0.0f, 0.0f;
-        // 570
-        m_basis.row(17) << 96.0f, -1.6f, 0.2f;
-        // 580
-        m_basis.row(18) << 95.1f, -3.5f, 0.5f;
-        // 590
-        m_basis.row(19) << 89.1f, -3.5f, 2.1f;
-        // 600
-        m_basis.row(20) << 90.5f, -5.8f, 3.2f;
-        // 610
-        m_basis.row(21) << 90.3f, -7.2f, 4.1f;
-        // 620
-        m_basis.row(22) << 88.4f, -8.6f, 4.7f;
-        // 630
-        m_basis.row(23) << 84.0f, -9.5f, 5.1f;
-        // 640
-        m_basis.row(24) << 85.1f, -10.9f, 6.7f;
-        // 650
-        m_basis.row(25) << 81.9f, -10.7f, 7.3f;
-        // 660
-        m_basis.row(26) << 82.6f, -12.0f, 8.6f;
-        // 670
-        m_basis.row(27) << 84.9f, -14.0f, 9.8f;
-        // 680
-        m_basis.row(28) << 81.3f, -13.6f, 10.2f;
-        // 690
-        m_basis.row(29) << 71.9f, -12.0f, 8.3f;
-        // 700
-        m_basis.row(30) << 74.3f, -13.3f, 9.6f;
-        // 710
-        m_basis.row(31) << 76.4f, -12.9f, 8.5f;
-        // 720
-        m_basis.row(32) << 63.3f, -10.6f, 7.0f;
+        if (!(cctStep > 0.0f) || !(cctMax >= cctMin))
+        {
+            throw std::runtime_error("DaylightGenerator: invalid CCT table range.");
+        }
+
+        const Eigen::Index n = static_cast<Eigen::Index>(std::floor((cctMax - cctMin) / cctStep)) + 1;
+        m_tableMin = cctMin;
+        m_tableStep = cctStep;
+        m_tableMax = cctMin + cctStep * static_cast<float>(n - 1);
+
+        m_weightTable.resize(Eigen::NoChange, n);
+        for (Eigen::Index i = 0; i < n; ++i)
+        {
+            m_weightTable.col(i) = weights(cctMin + cctStep * static_cast<float>(i));
+        }
+        m_table.noalias() = m_basis * m_weightTable;
     }
 
-    Eigen::VectorXf DaylightGenerator::generate(float cct) const
+    bool DaylightGenerator::lookup(float cct, Eigen::Index& index, float& t) const
+    {
+        if (!(cct >= m_tableMin && cct <= m_tableMax))
+        {
+            return false;
+        }
+
+        const Eigen::Index last = m_table.cols() - 1;
+        const float pos = (cct - m_tableMin) / m_tableStep;
+        index = std::min(static_cast<Eigen::Index>(pos), std::max<Eigen::Index>(last - 1, 0));
+        t = last > 0 ? pos - static_cast<float>(index) : 0.0f;
+        return true;
+    }
+
+    Eigen::Vector2d DaylightGenerator::locusChromaticity(double cct)
     {
         // Logic from getDaylightScalars.m
-        
+
         // 1. Calculate xD (CIE chromaticity x coordinate)
         double xD = 0.0;
-        if (cct >= 4000.0f && cct <= 7000.0f)
+        if (cct >= 4000.0 && cct <= 7000.0)
         {
             xD = -4.607e9 / std::pow(cct, 3) 
                  + 2.9678e6 / std::pow(cct, 2) 
@@ -102,21 +71,113 @@ namespace css::daylight
         // 2. Calculate yD
         double yD = -3.0 * xD * xD + 2.87 * xD - 0.275;
 
+        return Eigen::Vector2d(xD, yD);
+    }
+
+    Eigen::Vector3f DaylightGenerator::weightsForChromaticity(double x, double y)
+    {
         // 3. Calculate Scalars M1, M2
         // Denom common: 0.0241 + 0.2562*xD - 0.7341*yD
-        double denom = 0.0241 + 0.2562 * xD - 0.7341 * yD;
-        
-        double M1 = (-1.3515 - 1.7703 * xD + 5.9114 * yD) / denom;
-        double M2 = (0.03 - 31.4424 * xD + 30.0717 * yD) / denom;
+        double denom = 0.0241 + 0.2562 * x - 0.7341 * y;
 
-        // 4. Combine Basis
-        // SD = S0 + M1*S1 + M2*S2
-        Eigen::VectorXf S0 = m_basis.col(0);
-        Eigen::VectorXf S1 = m_basis.col(1);
-        Eigen::VectorXf S2 = m_basis.col(2);
+        double M1 = (-1.3515 - 1.7703 * x + 5.9114 * y) / denom;
+        double M2 = (0.03 - 31.4424 * x + 30.0717 * y) / denom;
+
+        return Eigen::Vector3f(1.0f, static_cast<float>(M1), static_cast<float>(M2));
+    }
+
+    Eigen::Vector3f DaylightGenerator::weights(float cct, float duv)
+    {
+        Eigen::Vector2d xy = locusChromaticity(cct);
+        if (duv == 0.0f)
+        {
+            return weightsForChromaticity(xy.x(), xy.y());
+        }
+
+        // Work in CIE 1960 (u, v), where Duv is defined.
+        auto toUv = [](const Eigen::Vector2d& c) {
+            double d = -2.0 * c.x() + 12.0 * c.y() + 3.0;
+            return Eigen::Vector2d(4.0 * c.x() / d, 6.0 * c.y() / d);
+        };
+
+        // Locus normal from a central difference of the locus tangent.
+        const double dT = 1.0;
+        Eigen::Vector2d tangent = toUv(locusChromaticity(cct + dT)) - toUv(locusChromaticity(cct - dT));
+        Eigen::Vector2d normal(tangent.y(), -tangent.x()); // +v side is positive
+        normal.normalize();
+
+        Eigen::Vector2d uv = toUv(xy) + static_cast<double>(duv) * normal;
 
-        Eigen::VectorXf SD = S0 + (float)M1 * S1 + (float)M2 * S2;
+        double d = 2.0 * uv.x() - 8.0 * uv.y() + 4.0;
+        return weightsForChromaticity(3.0 * uv.x() / d, 2.0 * uv.y() / d);
+    }
 
-        return SD;
+    Eigen::Vector3f DaylightGenerator::weightsAt(float cct, float duv) const
+    {
+        Eigen::Index i;
+        float t;
+        if (duv != 0.0f || !lookup(cct, i, t))
+        {
+            return weights(cct, duv);
+        }
+        if (t == 0.0f)
+        {
+            return m_weightTable.col(i);
+        }
+        return (1.0f - t) * m_weightTable.col(i) + t * m_weightTable.col(i + 1);
+    }
+
+    Eigen::VectorXf DaylightGenerator::generate(float cct) const
+    {
+        Eigen::VectorXf spd(kNumBands);
+        generate(cct, spd);
+        return spd;
+    }
+
+    Eigen::VectorXf DaylightGenerator::generate(float cct, float duv) const
+    {
+        Eigen::VectorXf spd(kNumBands);
+        generate(cct, duv, spd);
+        return spd;
+    }
+
+    void DaylightGenerator::generate(float cct, Eigen::Ref<Eigen::VectorXf> out) const
+    {
+        if (out.size() != kNumBands)
+        {
+            throw std::runtime_error("DaylightGenerator::generate: output must have 33 entries.");
+        }
+
+        Eigen::Index i;
+        float t;
+        if (!lookup(cct, i, t))
+        {
+            out.noalias() = m_basis * weights(cct);
+        }
+        else if (t == 0.0f)
+        {
+            out = m_table.col(i);
+        }
+        else
+        {
+            out = (1.0f - t) * m_table.col(i) + t * m_table.col(i + 1);
+        }
+    }
+
+    void DaylightGenerator::generate(float cct, float duv, Eigen::Ref<Eigen::VectorXf> out) const
+    {
+        if (duv == 0.0f)
+        {
+            generate(cct, out);
+            return;
+        }
+        if (out.size() != kNumBands)
+        {
+            throw std::runtime_error("DaylightGenerator::generate: output must have 33 entries.");
+        }
+
+        // 4. Combine Basis
+        // SD = S0 + M1*S1 + M2*S2
+        out.noalias() = m_basis * weights(cct, duv);
     }
 }
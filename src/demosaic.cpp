@@ -0,0 +1,225 @@
+#include "css/demosaic.hpp"
+
+#include "css/parallel.hpp"
+#include "simd/demosaic_impl.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+
+namespace css::demosaic
+{
+    namespace
+    {
+        // Reflect about the edge sample (-1 -> 1, n -> n - 2): even shifts only.
+        int mirror(int i, int n)
+        {
+            while (i < 0 || i >= n)
+            {
+                i = i < 0 ? -i : 2 * n - 2 - i;
+            }
+            return i;
+        }
+
+        // Columns xStart .. xStart + count - 1 of mosaic row `row`, as linear values.
+        void convertRow(const MosaicView& m, int row, int xStart, int count, float* dst)
+        {
+            const std::uint16_t* src = m.data + static_cast<size_t>(mirror(row, m.height)) * m.stride;
+            const int lo = std::clamp(-xStart, 0, count);
+            const int hi = std::clamp(m.width - xStart, lo, count);
+            for (int k = 0; k < lo; ++k)
+            {
+                dst[k] = std::max(static_cast<float>(src[mirror(xStart + k, m.width)]) - m.black, 0.0f) * m.scale;
+            }
+            for (int k = lo; k < hi; ++k)
+            {
+                dst[k] = std::max(static_cast<float>(src[xStart + k]) - m.black, 0.0f) * m.scale;
+            }
+            for (int k = hi; k < count; ++k)
+            {
+                dst[k] = std::max(static_cast<float>(src[mirror(xStart + k, m.width)]) - m.black, 0.0f) * m.scale;
+            }
+        }
+
+        // Same estimates as detail::demosaicRow, one pixel at a time.
+        void demosaicRowScalar(const detail::RowJob& job)
+        {
+            const float* r0 = job.rows[0];
+            const float* r1 = job.rows[1];
+            const float* r2 = job.rows[2];
+            const float* r3 = job.rows[3];
+            const float* r4 = job.rows[4];
+            for (size_t i = 0; i < job.count; ++i)
+            {
+                const float c = r2[i + 2];
+                const float h1 = r2[i + 1] + r2[i + 3];
+                const float v1 = r1[i + 2] + r3[i + 2];
+                const float d1 = (r1[i + 1] + r1[i + 3]) + (r3[i + 1] + r3[i + 3]);
+                float k1, k2, k3, k4;
+                if (job.mhc)
+                {
+                    const float h2 = r2[i] + r2[i + 4];
+                    const float v2 = r0[i + 2] + r4[i + 2];
+                    k1 = (4.0f * c + 2.0f * (h1 + v1) - (h2 + v2)) * 0.125f;
+                    k2 = (5.0f * c + 4.0f * h1 - (h2 + d1) + 0.5f * v2) * 0.125f;
+                    k3 = (5.0f * c + 4.0f * v1 - (v2 + d1) + 0.5f * h2) * 0.125f;
+                    k4 = (6.0f * c + 2.0f * d1 - 1.5f * (h2 + v2)) * 0.125f;
+                }
+                else
+                {
+                    k1 = (h1 + v1) * 0.25f;
+                    k2 = h1 * 0.5f;
+                    k3 = v1 * 0.5f;
+                    k4 = d1 * 0.25f;
+                }
+
+                const bool isX = static_cast<int>(i & 1) == job.xAt;
+                const float x = std::max(isX ? c : k2, 0.0f);
+                const float g = std::max(isX ? k1 : c, 0.0f);
+                const float y = std::max(isX ? k4 : k3, 0.0f);
+                float* dst = job.out + 3 * i;
+                dst[job.xChannel] = x;
+                dst[1] = g;
+                dst[2 - job.xChannel] = y;
+            }
+        }
+
+        void runRow(const detail::RowJob& job, kernel::Isa isa)
+        {
+            switch (isa)
+            {
+#if defined(CAMSPEC_X86_KERNELS)
+            case kernel::Isa::AVX512:
+                detail::demosaicRowAvx512(job);
+                return;
+            case kernel::Isa::AVX2:
+                detail::demosaicRowAvx2(job);
+                return;
+            case kernel::Isa::SSE42:
+                detail::demosaicRowSse42(job);
+                return;
+#endif
+            default:
+                demosaicRowScalar(job);
+                return;
+            }
+        }
+    } // namespace
+
+    Method parseMethod(const std::string& name)
+    {
+        if (name == "bilinear") return Method::Bilinear;
+        if (name == "mhc") return Method::MalvarHeCutler;
+        throw std::runtime_error("Unknown demosaic method: " + name);
+    }
+
+    const char* methodName(Method method)
+    {
+        return method == Method::Bilinear ? "bilinear" : "mhc";
+    }
+
+    Cfa cfaFromBayerCode(int bayerCode)
+    {
+        switch (bayerCode)
+        {
+        case cv::COLOR_BayerBG2BGR: return Cfa::RGGB;
+        case cv::COLOR_BayerRG2BGR: return Cfa::BGGR;
+        case cv::COLOR_BayerGB2BGR: return Cfa::GRBG;
+        case cv::COLOR_BayerGR2BGR: return Cfa::GBRG;
+        default: throw std::runtime_error("Unsupported Bayer code: " + std::to_string(bayerCode));
+        }
+    }
+
+    void demosaicRows(const MosaicView& mosaic, Method method, int x0, int y0, int cols, int rows,
+                      const RowSink& sink, kernel::Isa isa)
+    {
+        if (!mosaic.data || mosaic.width < 2 || mosaic.height < 2)
+        {
+            throw std::runtime_error("demosaicRows: mosaic must be at least 2x2");
+        }
+        if (x0 < 0 || y0 < 0 || cols < 0 || rows < 0 || x0 + cols > mosaic.width || y0 + rows > mosaic.height)
+        {
+            throw std::runtime_error("demosaicRows: window outside the mosaic");
+        }
+        if (cols == 0 || rows == 0)
+        {
+            return;
+        }
+        isa = std::min(isa, kernel::detectIsa());
+
+        // Color X sharing even rows with green, and the parity of its columns.
+        const int topX = (mosaic.cfa == Cfa::RGGB || mosaic.cfa == Cfa::GRBG) ? 2 : 0;
+        const int topXColumn = (mosaic.cfa == Cfa::RGGB || mosaic.cfa == Cfa::BGGR) ? 0 : 1;
+
+        const int span = cols + 2 * kHalo;
+        const size_t padded = static_cast<size_t>(span) + detail::kRowSlack;
+        std::vector<float> ring(5 * padded, 0.0f);
+        std::vector<float> out(3 * static_cast<size_t>(cols));
+        auto slot = [&](int y) { return ring.data() + static_cast<size_t>((y - y0 + kHalo) % 5) * padded; };
+
+        for (int y = y0 - kHalo; y < y0 + kHalo; ++y)
+        {
+            convertRow(mosaic, y, x0 - kHalo, span, slot(y));
+        }
+
+        detail::RowJob job;
+        job.out = out.data();
+        job.count = static_cast<size_t>(cols);
+        job.mhc = method == Method::MalvarHeCutler;
+        for (int y = y0; y < y0 + rows; ++y)
+        {
+            convertRow(mosaic, y + kHalo, x0 - kHalo, span, slot(y + kHalo));
+            for (int k = 0; k < 5; ++k)
+            {
+                job.rows[k] = slot(y - kHalo + k);
+            }
+            const bool odd = (y & 1) != 0;
+            job.xChannel = odd ? 2 - topX : topX;
+            job.xAt = ((odd ? 1 - topXColumn : topXColumn) + x0) & 1;
+            runRow(job, isa);
+            sink(y, out.data());
+        }
+    }
+
+    cv::Mat demosaicImage(const cv::Mat& mosaic, Cfa cfa, Method method, float black, float scale,
+                          int depth, unsigned threads)
+    {
+        CV_Assert(mosaic.type() == CV_16UC1);
+        CV_Assert(depth == CV_32F || depth == CV_16U);
+
+        MosaicView view;
+        view.data = mosaic.ptr<std::uint16_t>();
+        view.stride = mosaic.step / sizeof(std::uint16_t);
+        view.width = mosaic.cols;
+        view.height = mosaic.rows;
+        view.cfa = cfa;
+        view.black = black;
+        view.scale = scale;
+
+        cv::Mat result(mosaic.rows, mosaic.cols, CV_MAKETYPE(depth, 3));
+        const kernel::Isa isa = kernel::detectIsa();
+
+        // Each band re-reads 2 * kHalo rows, so keep bands tall.
+        const int bandRows = 64;
+        const size_t bands = static_cast<size_t>((mosaic.rows + bandRows - 1) / bandRows);
+        parallel::parallelFor(bands, [&](size_t b) {
+            const int y0 = static_cast<int>(b) * bandRows;
+            const int rows = std::min(bandRows, mosaic.rows - y0);
+            demosaicRows(view, method, 0, y0, mosaic.cols, rows, [&](int y, const float* bgr) {
+                const size_t n = 3 * static_cast<size_t>(mosaic.cols);
+                if (depth == CV_32F)
+                {
+                    std::copy(bgr, bgr + n, result.ptr<float>(y));
+                    return;
+                }
+                std::uint16_t* dst = result.ptr<std::uint16_t>(y);
+                for (size_t k = 0; k < n; ++k)
+                {
+                    dst[k] = static_cast<std::uint16_t>(std::min(bgr[k] + 0.5f, 65535.0f));
+                }
+            }, isa);
+        }, threads);
+        return result;
+    }
+} // namespace css::demosaic
@@ -0,0 +1,408 @@
+#include "css/illuminant.hpp"
+#include "css/daylight.hpp"
+#include "css/embedded_data.hpp"
+#include "css/resample.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace css::illuminant
+{
+    namespace
+    {
+        // Relative spectral radiance lambda^-5 / (exp(c2 / (lambda T)) - 1) with
+        // c2 in nm*K, normalized to 100 at 560nm.
+        void radiator(double c2, double cct, const spectral::SpectralGrid& grid, Eigen::Ref<Eigen::VectorXf> out)
+        {
+            if (out.size() != grid.count)
+            {
+                throw std::runtime_error("illuminant: output size does not match the spectral grid.");
+            }
+            if (!(cct > 0.0))
+            {
+                throw std::runtime_error("illuminant: CCT must be positive.");
+            }
+
+            auto relative = [&](double lambda) {
+                return std::pow(560.0 / lambda, 5.0) / std::expm1(c2 / (lambda * cct));
+            };
+
+            const double norm = 100.0 / relative(560.0);
+            for (int i = 0; i < grid.count; ++i)
+            {
+                out[i] = static_cast<float>(norm * relative(grid.wavelength(i)));
+            }
+        }
+
+        std::string kelvinLabel(float cct)
+        {
+            return std::to_string(static_cast<int>(std::lround(cct))) + "K";
+        }
+
+        // "3200K" -> 3200; 0 if the label is not a Kelvin value.
+        float parseKelvin(const std::string& label)
+        {
+            if (label.size() < 2 || (label.back() != 'K' && label.back() != 'k'))
+            {
+                return 0.0f;
+            }
+            try
+            {
+                size_t used = 0;
+                float v = std::stof(label.substr(0, label.size() - 1), &used);
+                return used == label.size() - 1 ? v : 0.0f;
+            }
+            catch (...)
+            {
+                return 0.0f;
+            }
+        }
+
+        // Embedded table (bands x members, row-major) as a family on `grid`,
+        // each member normalized to 100 at 560nm before resampling.
+        template <int Bands, int Members>
+        IlluminantSet tabulatedSet(const std::string& family, const float (&table)[Bands][Members],
+                                   const char* const (&names)[Members], float start, float step,
+                                   const spectral::SpectralGrid& grid)
+        {
+            const spectral::SpectralGrid source{start, step, Bands};
+            const int at560 = static_cast<int>(std::lround((560.0f - start) / step));
+            Eigen::MatrixXf raw = Eigen::Map<const Eigen::Matrix<float, Bands, Members, Eigen::RowMajor>>(&table[0][0]);
+
+            IlluminantSet set;
+            set.family = family;
+            set.grid = grid;
+            for (int c = 0; c < Members; ++c)
+            {
+                raw.col(c) *= 100.0f / raw(at560, c);
+                set.labels.push_back(names[c]);
+            }
+            set.spectra = spectral::resample(raw, source, grid);
+            set.cct.assign(set.labels.size(), 0.0f);
+            return set;
+        }
+
+        std::vector<float> cctRange(float cctMin, float cctMax, float cctStep)
+        {
+            if (!(cctStep > 0.0f) || !(cctMax >= cctMin) || !(cctMin > 0.0f))
+            {
+                throw std::runtime_error("illuminant: invalid CCT range.");
+            }
+            std::vector<float> ccts;
+            for (int i = 0; ; ++i)
+            {
+                float cct = cctMin + cctStep * static_cast<float>(i);
+                if (cct > cctMax)
+                {
+                    break;
+                }
+                ccts.push_back(cct);
+            }
+            return ccts;
+        }
+    } // namespace
+
+    Eigen::Index IlluminantSet::find(const std::string& label) const
+    {
+        auto it = std::find(labels.begin(), labels.end(), label);
+        return it == labels.end() ? -1 : static_cast<Eigen::Index>(it - labels.begin());
+    }
+
+    Eigen::VectorXf planck(float cct, const spectral::SpectralGrid& grid)
+    {
+        Eigen::VectorXf spd(grid.count);
+        planck(cct, grid, spd);
+        return spd;
+    }
+
+    void planck(float cct, const spectral::SpectralGrid& grid, Eigen::Ref<Eigen::VectorXf> out)
+    {
+        // Second radiation constant c2 = 1.4388e-2 m*K (ITS-90).
+        radiator(1.4388e7, cct, grid, out);
+    }
+
+    IlluminantSet blackbodySet(float cctMin, float cctMax, float cctStep, const spectral::SpectralGrid& grid)
+    {
+        IlluminantSet set;
+        set.family = "blackbody";
+        set.grid = grid;
+        set.cct = cctRange(cctMin, cctMax, cctStep);
+        set.spectra.resize(grid.count, static_cast<Eigen::Index>(set.cct.size()));
+        for (size_t i = 0; i < set.cct.size(); ++i)
+        {
+            planck(set.cct[i], grid, set.spectra.col(static_cast<Eigen::Index>(i)));
+            set.labels.push_back(kelvinLabel(set.cct[i]));
+        }
+        return set;
+    }
+
+    IlluminantSet daylightSet(float cctMin, float cctMax, float cctStep, const spectral::SpectralGrid& grid)
+    {
+        cctRange(cctMin, cctMax, cctStep); // validates the range
+        // The generator tabulates exactly this range; reuse its table.
+        daylight::DaylightGenerator gen(cctMin, cctMax, cctStep);
+
+        IlluminantSet set;
+        set.family = "daylight";
+        set.grid = grid;
+        set.spectra = spectral::resample(gen.getTable(), daylight::DaylightGenerator::grid(), grid);
+        for (Eigen::Index i = 0; i < set.spectra.cols(); ++i)
+        {
+            float cct = gen.tableMin() + gen.tableStep() * static_cast<float>(i);
+            set.cct.push_back(cct);
+            set.labels.push_back("D" + kelvinLabel(cct));
+        }
+        return set;
+    }
+
+    IlluminantSet cieStandardSet(const spectral::SpectralGrid& grid)
+    {
+        IlluminantSet set;
+        set.family = "cie";
+        set.grid = grid;
+        set.spectra.resize(grid.count, 5);
+
+        // CIE A is defined with c2 = 1.435e-2 m*K at 2848 K (2856 K on ITS-90).
+        radiator(1.435e7, 2848.0, grid, set.spectra.col(0));
+        set.labels.push_back("A");
+        set.cct.push_back(2856.0f);
+
+        // D-series nominal CCTs were fixed with the old c2 = 1.4380e-2 m*K.
+        const char* names[] = {"D50", "D55", "D65", "D75"};
+        const float ccts[] = {5003.0f, 5503.0f, 6504.0f, 7504.0f};
+        daylight::DaylightGenerator gen;
+        Eigen::MatrixXf daylights(daylight::DaylightGenerator::kNumBands, 4);
+        for (int i = 0; i < 4; ++i)
+        {
+            gen.generate(ccts[i], daylights.col(i));
+            set.labels.push_back(names[i]);
+            set.cct.push_back(ccts[i]);
+        }
+        set.spectra.rightCols(4) = spectral::resample(daylights, daylight::DaylightGenerator::grid(), grid);
+        return set;
+    }
+
+    IlluminantSet fSeriesSet(const spectral::SpectralGrid& grid)
+    {
+        return tabulatedSet("F", embedded::kFSeries, embedded::kFSeriesNames, embedded::kFSeriesStart,
+                            embedded::kFSeriesStep, grid);
+    }
+
+    IlluminantSet ledModelSet(const spectral::SpectralGrid& grid)
+    {
+        return tabulatedSet("LED-model", embedded::kLedModel, embedded::kLedModelNames, embedded::kLedModelStart,
+                            embedded::kLedModelStep, grid);
+    }
+
+    IlluminantSet loadIlluminantCsv(const std::string& path, const std::string& family,
+                                    const spectral::SpectralGrid& grid)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Failed to open illuminant CSV: " + path);
+        }
+
+        IlluminantSet set;
+        set.family = family;
+        set.grid = grid;
+
+        std::vector<float> wavelengths;
+        std::vector<std::vector<float>> columns;
+
+        std::string line;
+        bool firstLine = true;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::stringstream ss(line);
+            std::string token;
+
+            if (firstLine)
+            {
+                // Header: wavelength column, then one name per illuminant.
+                firstLine = false;
+                std::getline(ss, token, ',');
+                while (std::getline(ss, token, ','))
+                {
+                    set.labels.push_back(token);
+                }
+                columns.resize(set.labels.size());
+                continue;
+            }
+
+            if (!std::getline(ss, token, ','))
+                continue;
+            wavelengths.push_back(std::stof(token));
+
+            for (auto& col : columns)
+            {
+                if (!std::getline(ss, token, ','))
+                {
+                    throw std::runtime_error("Short row in illuminant CSV: " + path);
+                }
+                col.push_back(std::stof(token));
+            }
+        }
+
+        if (set.labels.empty() || wavelengths.size() < 2)
+        {
+            throw std::runtime_error("Illuminant CSV has no data: " + path);
+        }
+        const float tol = 1e-3f * grid.step;
+        if (!std::is_sorted(wavelengths.begin(), wavelengths.end()) ||
+            wavelengths.front() > grid.start + tol ||
+            wavelengths.back() < grid.end() - tol)
+        {
+            throw std::runtime_error("Illuminant CSV must cover the spectral grid in ascending order: " + path);
+        }
+
+        // Linear interpolation of column c of the raw data at `lambda`.
+        auto interp = [&](size_t c, float lambda) {
+            size_t hi = static_cast<size_t>(std::lower_bound(wavelengths.begin(), wavelengths.end(), lambda) -
+                                            wavelengths.begin());
+            size_t lo = hi > 0 ? hi - 1 : 0;
+            hi = std::min(hi, wavelengths.size() - 1);
+            const float span = wavelengths[hi] - wavelengths[lo];
+            const float t = span > 0.0f ? std::clamp((lambda - wavelengths[lo]) / span, 0.0f, 1.0f) : 0.0f;
+            return (1.0f - t) * columns[c][lo] + t * columns[c][hi];
+        };
+
+        const int n = static_cast<int>(wavelengths.size());
+        spectral::SpectralGrid source;
+        source.start = wavelengths.front();
+        source.step = (wavelengths.back() - wavelengths.front()) / static_cast<float>(n - 1);
+        source.count = n;
+        bool uniform = source.step > 0.0f;
+        for (int i = 0; i < n && uniform; ++i)
+        {
+            uniform = std::abs(wavelengths[i] - source.wavelength(i)) <= 1e-3f * source.step;
+        }
+
+        if (uniform)
+        {
+            // Whole table through the resampling engine in one product.
+            Eigen::MatrixXf raw(n, static_cast<Eigen::Index>(columns.size()));
+            for (size_t c = 0; c < columns.size(); ++c)
+            {
+                raw.col(static_cast<Eigen::Index>(c)) = Eigen::Map<const Eigen::VectorXf>(columns[c].data(), n);
+            }
+            set.spectra = spectral::resample(raw, source, grid);
+        }
+        else
+        {
+            set.spectra.resize(grid.count, static_cast<Eigen::Index>(columns.size()));
+            for (int i = 0; i < grid.count; ++i)
+            {
+                for (size_t c = 0; c < columns.size(); ++c)
+                {
+                    set.spectra(i, static_cast<Eigen::Index>(c)) = interp(c, grid.wavelength(i));
+                }
+            }
+        }
+
+        // Normalize to 100 at 560nm like the built-in families.
+        for (Eigen::Index c = 0; c < set.spectra.cols(); ++c)
+        {
+            const float v = interp(static_cast<size_t>(c), 560.0f);
+            if (v <= 0.0f)
+            {
+                throw std::runtime_error("Illuminant '" + set.labels[static_cast<size_t>(c)] +
+                                         "' has no power at 560nm: " + path);
+            }
+            set.spectra.col(c) *= 100.0f / v;
+        }
+
+        set.cct.assign(set.labels.size(), 0.0f);
+        return set;
+    }
+
+    IlluminantLibrary::IlluminantLibrary(const spectral::SpectralGrid& grid)
+        : m_grid(grid)
+    {
+        add(blackbodySet(1000.0f, 20000.0f, 50.0f, grid));
+        add(daylightSet(4000.0f, 25000.0f, 50.0f, grid));
+        add(cieStandardSet(grid));
+        add(fSeriesSet(grid));
+        add(ledModelSet(grid));
+    }
+
+    void IlluminantLibrary::add(IlluminantSet set)
+    {
+        if (set.grid != m_grid)
+        {
+            set.spectra = spectral::resample(set.spectra, set.grid, m_grid);
+            set.grid = m_grid;
+        }
+        std::string name = set.family;
+        m_families[name] = std::move(set);
+    }
+
+    void IlluminantLibrary::loadCsv(const std::string& path, const std::string& family)
+    {
+        add(loadIlluminantCsv(path, family, m_grid));
+    }
+
+    bool IlluminantLibrary::hasFamily(const std::string& family) const
+    {
+        return m_families.count(family) != 0;
+    }
+
+    const IlluminantSet& IlluminantLibrary::family(const std::string& family) const
+    {
+        auto it = m_families.find(family);
+        if (it == m_families.end())
+        {
+            throw std::runtime_error("Unknown illuminant family: " + family);
+        }
+        return it->second;
+    }
+
+    std::vector<std::string> IlluminantLibrary::families() const
+    {
+        std::vector<std::string> names;
+        for (const auto& kv : m_families)
+        {
+            names.push_back(kv.first);
+        }
+        return names;
+    }
+
+    Eigen::VectorXf IlluminantLibrary::spectrum(const std::string& label) const
+    {
+        // Named members first ("cie" before the parametric families).
+        for (const char* preferred : {"cie", "blackbody", "daylight"})
+        {
+            auto it = m_families.find(preferred);
+            if (it == m_families.end())
+                continue;
+            Eigen::Index col = it->second.find(label);
+            if (col >= 0)
+            {
+                return it->second.spectra.col(col);
+            }
+        }
+        for (const auto& kv : m_families)
+        {
+            Eigen::Index col = kv.second.find(label);
+            if (col >= 0)
+            {
+                return kv.second.spectra.col(col);
+            }
+        }
+
+        float cct = parseKelvin(label);
+        if (cct > 0.0f)
+        {
+            return planck(cct, m_grid);
+        }
+        throw std::runtime_error("Unknown illuminant: " + label);
+    }
+} // namespace css::illuminant
@@ -29,11 +29,12 @@ static int getOpenCVBayerCode(const tinydng::DNGImage& img)
     int p10 = img.cfa_plane_color[img.cfa_pattern[1][0]];
     int p11 = img.cfa_plane_color[img.cfa_pattern[1][1]];
 
-    // R=0, G=1, B=2
-    if (p00 == 0 && p01 == 1 && p10 == 1 && p11 == 2) return cv::COLOR_BayerRG2BGR;
-    if (p00 == 2 && p01 == 1 && p10 == 1 && p11 == 0) return cv::COLOR_BayerBG2BGR;
-    if (p00 == 1 && p01 == 0 && p10 == 2 && p11 == 1) return cv::COLOR_BayerGR2BGR;
-    if (p00 == 1 && p01 == 2 && p10 == 0 && p11 == 1) return cv::COLOR_BayerGB2BGR;
+    // R=0, G=1, B=2. OpenCV names a pattern by the second and third pixels of
+    // its second row, so an RGGB sensor is COLOR_BayerBG2BGR (= BayerRGGB2BGR).
+    if (p00 == 0 && p01 == 1 && p10 == 1 && p11 == 2) return cv::COLOR_BayerBG2BGR;
+    if (p00 == 2 && p01 == 1 && p10 == 1 && p11 == 0) return cv::COLOR_BayerRG2BGR;
+    if (p00 == 1 && p01 == 0 && p10 == 2 && p11 == 1) return cv::COLOR_BayerGB2BGR;
+    if (p00 == 1 && p01 == 2 && p10 == 0 && p11 == 1) return cv::COLOR_BayerGR2BGR;
 
     return -1; // Unknown
 }
@@ -46,7 +47,7 @@ namespace css::io
         // The original toFloat01 and normalizeBlackWhite might not be needed if we do custom processing.
     }
 
-    cv::Mat loadDngAsLinearRgb(const std::string& path)
+    RawMosaic loadDngMosaic(const std::string& path)
     {
         std::string warn, err;
         std::vector<tinydng::DNGImage> images;
@@ -69,94 +70,93 @@ namespace css::io
              throw std::runtime_error("DNG has no data");
         }
 
-        // Create raw Mat
         int width = dng.width;
         int height = dng.height;
+        RawMosaic mosaic;
         cv::Mat raw;
-        
-        if (dng.bits_per_sample > 8) {
-            // Assume 16-bit
-             raw = cv::Mat(height, width, CV_16UC1, (void*)dng.data.data()).clone();
-        } else {
-             raw = cv::Mat(height, width, CV_8UC1, (void*)dng.data.data()).clone();
-        }
 
-        // Subtract Black Level (Integer) - simple approx using first value
-        // Note: cv::subtract handles saturation (clamping to 0) for unsigned types
-        cv::subtract(raw, cv::Scalar(dng.black_level[0]), raw);
-
-        // Demosaic (Must be 8/16U) - raw is modified in-place above
-        cv::Mat rgb;
-        
         if (dng.samples_per_pixel == 1) {
-            // CFA -> Debayer
-            int code = getOpenCVBayerCode(dng);
-            if (code == -1) {
+            // CFA, demosaiced by the caller
+            if (dng.bits_per_sample > 8) {
+                // Assume 16-bit
+                raw = cv::Mat(height, width, CV_16UC1, (void*)dng.data.data());
+            } else {
+                raw = cv::Mat(height, width, CV_8UC1, (void*)dng.data.data());
+            }
+            mosaic.bayerCode = getOpenCVBayerCode(dng);
+            if (mosaic.bayerCode == -1) {
                 std::cerr << "Warning: Unknown Bayer pattern, assuming RGGB" << std::endl;
-                code = cv::COLOR_BayerRG2BGR;
+                mosaic.bayerCode = cv::COLOR_BayerBG2BGR;
             }
-            cv::cvtColor(raw, rgb, code);
         } else if (dng.samples_per_pixel == 3) {
-            // Already RGB (Linear DNG?)
-             if (dng.bits_per_sample > 8) {
-                rgb = cv::Mat(height, width, CV_16UC3, (void*)dng.data.data()).clone();
-            } else {
-                rgb = cv::Mat(height, width, CV_8UC3, (void*)dng.data.data()).clone();
-            }
-            // Subtract black level again? We did it on 'raw' but if SPP=3 we just re-created 'rgb'?
-            // Wait, logic above in original was re-creating 'raw'.
-            // Let's stick to using 'raw' which we already subtracted from.
-            // But 'raw' was initialized as CV_16UC1 or CV_8UC1 in lines 62-72.
-            // If SPP=3, 'raw' (C1) contains all data but treated as 1 channel?
-            // Yes, CV_16UC1 with width*3? No, width is width.
-            // If SPP=3, tinydng data is 3*width*height.
-            // If we created CV_16UC1 with width, height, we missed 2/3 of data?
-            // tinydng DNGImage: width, height are image dimensions.
-            // data size should be width*height*spp*bps/8.
-            // My previous code: raw = cv::Mat(height, width, CV_16UC1, ...).
-            // This only views the first plane if SPP=3? Or crashes?
-            
-            // Fix for SPP=3:
-            // We need to reshape or recreate 'raw' correctly BEFORE subtraction if we want to support SPP=3.
-            // But let's assume SPP=1 (CFA) for the task at hand.
-            // If SPP=3, we fix 'rgb' creation here.
-            
+            // Already RGB (Linear DNG), interleaved
             if (dng.planar_configuration == 2) {
                  throw std::runtime_error("Planar RGB DNGs not yet implemented");
             }
-             
             if (dng.bits_per_sample > 8) {
-                rgb = cv::Mat(height, width, CV_16UC3, (void*)dng.data.data()).clone();
+                raw = cv::Mat(height, width, CV_16UC3, (void*)dng.data.data());
             } else {
-                rgb = cv::Mat(height, width, CV_8UC3, (void*)dng.data.data()).clone();
+                raw = cv::Mat(height, width, CV_8UC3, (void*)dng.data.data());
             }
-             cv::subtract(rgb, cv::Scalar(dng.black_level[0], dng.black_level[0], dng.black_level[0]), rgb);
-             
-             // Convert to BGR for OpenCV
-             cv::cvtColor(rgb, rgb, cv::COLOR_RGB2BGR);
         } else {
              throw std::runtime_error("Unsupported samples per pixel: " + std::to_string(dng.samples_per_pixel));
         }
 
-        // Linearize (Scale by White)
-        cv::Mat floatRgb;
-        rgb.convertTo(floatRgb, CV_32F);
-        
-        float black = static_cast<float>(dng.black_level[0]);
+        // Copy out of the loader's buffer, widening 8-bit data.
+        if (raw.depth() == CV_16U) {
+            mosaic.data = raw.clone();
+        } else {
+            raw.convertTo(mosaic.data, CV_16U);
+        }
+
+        mosaic.black = static_cast<float>(dng.black_level[0]);
         float white = static_cast<float>(dng.white_level[0]);
-        float range = white - black;
-        if (range < 1e-6f) range = 1.0f; // Avoid div by zero
+        mosaic.whiteLevel = white - mosaic.black;
+        if (mosaic.whiteLevel < 1e-6f) mosaic.whiteLevel = 1.0f; // Avoid div by zero
+
+        return mosaic;
+    }
+
+    RawImage16 loadDngAsRgb16(const std::string& path, demosaic::Method method)
+    {
+        const RawMosaic mosaic = loadDngMosaic(path);
+
+        RawImage16 result;
+        if (mosaic.bayerCode != -1) {
+            // Black subtraction and demosaicing in one pass, rounded back to codes
+            result.image = demosaic::demosaicImage(mosaic.data, demosaic::cfaFromBayerCode(mosaic.bayerCode),
+                                                   method, mosaic.black, 1.0f, CV_16U);
+        } else {
+            // Subtract Black Level (Integer) - simple approx using first value
+            // Note: cv::subtract handles saturation (clamping to 0) for unsigned types
+            cv::subtract(mosaic.data, cv::Scalar::all(mosaic.black), result.image);
+        }
+
+        result.whiteLevel = mosaic.whiteLevel;
+        return result;
+    }
+
+    cv::Mat loadDngAsLinearRgb(const std::string& path, demosaic::Method method)
+    {
+        cv::Mat floatRgb;
+        const RawMosaic mosaic = loadDngMosaic(path);
+        if (mosaic.bayerCode != -1) {
+            // Demosaiced floats are black subtracted, scaled and non-negative already
+            floatRgb = demosaic::demosaicImage(mosaic.data, demosaic::cfaFromBayerCode(mosaic.bayerCode),
+                                               method, mosaic.black, 1.0f / mosaic.whiteLevel, CV_32F);
+            cv::threshold(floatRgb, floatRgb, 1.0, 1.0, cv::THRESH_TRUNC);
+            return floatRgb;
+        }
+
+        // Linearize: subtract black, then divide by range.
+        cv::Mat raw;
+        cv::subtract(mosaic.data, cv::Scalar::all(mosaic.black), raw);
+        raw.convertTo(floatRgb, CV_32F, 1.0 / mosaic.whiteLevel);
 
-        // We already subtracted black from integer, so we just divide by range.
-        floatRgb = floatRgb / range;
-        
         // Clip to [0,1]
         cv::threshold(floatRgb, floatRgb, 0.0, 0.0, cv::THRESH_TOZERO);
         cv::threshold(floatRgb, floatRgb, 1.0, 1.0, cv::THRESH_TRUNC);
 
-        // Convert to RGB (OpenCV default is BGR)
-        cv::cvtColor(floatRgb, floatRgb, cv::COLOR_BGR2RGB);
-
         return floatRgb;
     }
 
@@ -164,6 +164,15 @@ namespace css::io
                    const cv::Mat& image,
                    int bitDepth)
     {
+        if (image.depth() == CV_8U || image.depth() == CV_16U)
+        {
+            if (!cv::imwrite(path, image))
+            {
+                throw std::runtime_error("Failed to write image: " + path);
+            }
+            return;
+        }
+
         CV_Assert(image.type() == CV_32FC3 || image.type() == CV_32FC1);
 
         cv::Mat clamped;
@@ -1,17 +1,372 @@
 #include "css/jiang.hpp"
+#include "css/parallel.hpp"
+#include "css/resample.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <random>
+#include <stdexcept>
 #include <Eigen/Dense>
 
 namespace css::jiang
 {
+    namespace
+    {
+        struct Candidate
+        {
+            float cct = 0.0f;
+            float duv = 0.0f;
+            float error = std::numeric_limits<float>::max();
+        };
+
+        // Fixed illuminant grid of a search: the full CCT line for DaylightLocus,
+        // the coarse CCT x Duv grid for OffPlanckian.
+        std::vector<Eigen::Vector2f> searchGrid(const SearchOptions& options)
+        {
+            // Non-positive or NaN steps would never leave the loops below.
+            if (!(options.cctStep > 0.0f) || !(options.cctMax >= options.cctMin) || !(options.cctMin > 0.0f))
+            {
+                throw std::runtime_error("JiangEstimator: invalid CCT search range.");
+            }
+            if (options.model == IlluminantModel::OffPlanckian &&
+                (!(options.coarseCctStep > 0.0f) || !(options.duvStep > 0.0f) ||
+                 !(options.duvMax >= options.duvMin) || options.refineLevels < 0))
+            {
+                throw std::runtime_error("JiangEstimator: invalid off-Planckian search grid.");
+            }
+
+            std::vector<Eigen::Vector2f> grid;
+            if (options.model == IlluminantModel::DaylightLocus)
+            {
+                // Search Range from MATLAB script: 4000 to 27000 step 100
+                for (int i = 0; ; ++i)
+                {
+                    float cct = options.cctMin + options.cctStep * static_cast<float>(i);
+                    if (cct > options.cctMax)
+                    {
+                        break;
+                    }
+                    grid.emplace_back(cct, 0.0f);
+                }
+                return grid;
+            }
+
+            for (int i = 0; ; ++i)
+            {
+                float cct = options.cctMin + options.coarseCctStep * static_cast<float>(i);
+                if (cct > options.cctMax)
+                {
+                    break;
+                }
+                for (int j = 0; ; ++j)
+                {
+                    float duv = options.duvMin + options.duvStep * static_cast<float>(j);
+                    if (duv > options.duvMax + 1e-6f)
+                    {
+                        break;
+                    }
+                    grid.emplace_back(cct, duv);
+                }
+            }
+            return grid;
+        }
+
+        // Minimize `objective` (a squared residual for daylight-basis weights)
+        // over the illuminant space selected by `options`. If given,
+        // `gridObjective(i)` replaces `objective` for point i of searchGrid().
+        Candidate searchIlluminant(const daylight::DaylightGenerator& daylight,
+                                   const std::function<float(const Eigen::Vector3f&)>& objective,
+                                   const SearchOptions& options,
+                                   const std::function<float(size_t)>& gridObjective = nullptr)
+        {
+            const std::vector<Eigen::Vector2f> grid = searchGrid(options);
+            if (grid.empty())
+            {
+                throw std::runtime_error("JiangEstimator: empty illuminant search range.");
+            }
+
+            std::vector<Candidate> coarse(grid.size());
+            for (size_t i = 0; i < grid.size(); ++i)
+            {
+                const float cct = grid[i].x();
+                const float duv = grid[i].y();
+                coarse[i] = {cct, duv,
+                             gridObjective ? gridObjective(i)
+                                           : objective(daylight.weightsAt(cct, duv))};
+            }
+
+            if (options.model == IlluminantModel::DaylightLocus)
+            {
+                Candidate best;
+                for (const auto& c : coarse)
+                {
+                    if (c.error < best.error)
+                    {
+                        best = c;
+                    }
+                }
+                return best;
+            }
+
+            // Coarse-to-fine over (CCT, Duv). Each candidate only re-weights the
+            // precomputed per-basis systems, so cost is linear in evaluated points.
+            auto evalAt = [&](float cct, float duv) {
+                cct = std::clamp(cct, options.cctMin, options.cctMax);
+                duv = std::clamp(duv, options.duvMin, options.duvMax);
+                return Candidate{cct, duv, objective(daylight.weightsAt(cct, duv))};
+            };
+
+            size_t seeds = std::min(coarse.size(), static_cast<size_t>(std::max(1, options.refineSeeds)));
+            std::partial_sort(coarse.begin(), coarse.begin() + seeds, coarse.end(),
+                              [](const Candidate& a, const Candidate& b) { return a.error < b.error; });
+
+            Candidate best;
+            for (size_t s = 0; s < seeds; ++s)
+            {
+                Candidate local = coarse[s];
+                float cctStep = options.coarseCctStep;
+                float duvStep = options.duvStep;
+
+                for (int level = 0; level < options.refineLevels; ++level)
+                {
+                    cctStep *= 0.5f;
+                    duvStep *= 0.5f;
+
+                    Candidate center = local;
+                    for (int di = -1; di <= 1; ++di)
+                    {
+                        for (int dj = -1; dj <= 1; ++dj)
+                        {
+                            if (di == 0 && dj == 0)
+                                continue;
+                            Candidate c = evalAt(center.cct + di * cctStep, center.duv + dj * duvStep);
+                            if (c.error < local.error)
+                            {
+                                local = c;
+                            }
+                        }
+                    }
+                }
+
+                if (local.error < best.error)
+                {
+                    best = local;
+                }
+            }
+            return best;
+        }
+
+        // Weighted least squares min_x sum_i c_i (b_i - a_i x)^2 + lambda ||x||^2
+        // through the K x K normal equations. Returns the weighted squared residual.
+        float weightedFit(const Eigen::MatrixXf& A,
+                          const Eigen::VectorXf& counts,
+                          const Eigen::VectorXf& b,
+                          float lambda,
+                          Eigen::VectorXf* x)
+        {
+            Eigen::MatrixXf Aw = A.array().colwise() * counts.array();
+            Eigen::MatrixXf AtA = Aw.transpose() * A;
+            AtA.diagonal().array() += lambda;
+            Eigen::VectorXf Atb = Aw.transpose() * b;
+
+            Eigen::VectorXf sol = AtA.ldlt().solve(Atb);
+            Eigen::VectorXf r = b - A * sol;
+            if (x)
+            {
+                *x = sol;
+            }
+            return (r.array().square() * counts.array()).sum();
+        }
+
+        // Basis coefficients for one channel from a factorized system, with
+        // lambda picked per `options`. Returns the lambda used.
+        float regularizedFit(const tikhonov::TikhonovPath& path,
+                             const Eigen::VectorXf& b,
+                             const SearchOptions& options,
+                             Eigen::VectorXf& x)
+        {
+            auto proj = path.project(b);
+            float lambda = path.selectLambda(proj, options.regularization, options.lambda);
+            x = path.solve(proj, lambda);
+            return lambda;
+        }
+
+        // SplitMix64 finalizer: decorrelated seeds for per-resample streams.
+        uint64_t mixSeed(uint64_t seed, uint64_t index)
+        {
+            uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (index + 1);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        // Clip negatives and normalize the max value to 1.0
+        void normalizeCss(Eigen::MatrixXf& css)
+        {
+            css = css.cwiseMax(0.0f);
+
+            float maxVal = css.maxCoeff();
+            if (maxVal > 1e-6f)
+            {
+                css /= maxVal;
+            }
+        }
+    } // namespace
+
     JiangEstimator::JiangEstimator(const priors::CameraPriors& priors)
-        : m_priors(priors)
+        : JiangEstimator(std::make_shared<const priors::CameraPriors>(priors))
+    {
+    }
+
+    JiangEstimator::JiangEstimator(std::shared_ptr<const priors::CameraPriors> priors)
+        : JiangEstimator(priors, *priors)
     {
     }
 
-    JiangResult JiangEstimator::solve(const std::vector<Eigen::Vector3f>& rgbPatches)
+    JiangEstimator::JiangEstimator(std::shared_ptr<const priors::MappedPriors> priors)
+        : JiangEstimator(priors, *priors)
+    {
+    }
+
+    JiangEstimator::JiangEstimator(std::shared_ptr<const void> storage, const priors::PriorsView& priors)
+        : m_storage(std::move(storage)),
+          m_priors(priors)
+    {
+        if (m_priors.reflectance.rows() != m_priors.grid.count)
+        {
+            throw std::runtime_error("Reflectance prior rows != spectral grid size.");
+        }
+
+        // Daylight basis on the priors' grid (identity on the default 400-720nm @ 10nm).
+        m_daylightBasis = spectral::resample(m_daylight.getBasis(), daylight::DaylightGenerator::grid(), m_priors.grid);
+        const Eigen::MatrixXf& S = m_daylightBasis;
+        const float deltaLambda = m_priors.grid.step;
+
+        // Pointers to basis matrices for convenient indexing
+        // 0=R, 1=G, 2=B
+        const priors::PriorsView::Matrix* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+
+        for (int k = 0; k < 3; ++k)
+        {
+            // Radiance under basis SPD k: Refl (Lx24) * Diag(S_k), transposed (24xL)
+            Eigen::MatrixXf radianceT = (m_priors.reflectance.array().colwise() * S.col(k).array()).matrix().transpose();
+
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                const priors::PriorsView::Matrix& E = *bases[ch]; // (L x K)
+                if (E.rows() != S.rows())
+                {
+                    throw std::runtime_error("PCA basis rows != spectral grid size.");
+                }
+                m_systems[ch][k] = (radianceT * E) * deltaLambda;
+            }
+        }
+    }
+
+    JiangEstimator::ChannelSystems JiangEstimator::daylightSystems(const Eigen::Vector3f& weights) const
+    {
+        // System Matrix A = (R_ill^T * E) * deltaLambda, assembled from the
+        // per-basis systems since R_ill is linear in the illuminant weights.
+        ChannelSystems systems;
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            systems[ch] = weights[0] * m_systems[ch][0]
+                        + weights[1] * m_systems[ch][1]
+                        + weights[2] * m_systems[ch][2];
+        }
+        return systems;
+    }
+
+    JiangEstimator::ChannelSystems JiangEstimator::spdSystems(const Eigen::VectorXf& spd) const
+    {
+        if (spd.size() != m_priors.reflectance.rows())
+        {
+            throw std::runtime_error("Illuminant SPD rows != reflectance rows.");
+        }
+
+        const priors::PriorsView::Matrix* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+
+        // Radiance under the SPD: Refl (Lx24) * Diag(spd), transposed (24xL)
+        Eigen::MatrixXf radianceT = (m_priors.reflectance.array().colwise() * spd.array()).matrix().transpose();
+
+        ChannelSystems systems;
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            systems[ch] = (radianceT * *bases[ch]) * m_priors.grid.step;
+        }
+        return systems;
+    }
+
+    float JiangEstimator::evaluate(const Eigen::MatrixXf& observations,
+                                   const Eigen::Vector3f& weights,
+                                   float lambda,
+                                   Eigen::MatrixXf* css) const
+    {
+        return evaluate(observations, daylightSystems(weights), lambda, css);
+    }
+
+    float JiangEstimator::evaluate(const Eigen::MatrixXf& observations,
+                                   const ChannelSystems& systems,
+                                   float lambda,
+                                   Eigen::MatrixXf* css) const
+    {
+        const priors::PriorsView::Matrix* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+
+        float squaredError = 0.0f;
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            const Eigen::MatrixXf& A = systems[ch];
+
+            // b is (24x1) observed values for this channel
+            Eigen::VectorXf b = observations.col(ch);
+
+            Eigen::VectorXf x;
+            if (lambda > 0.0f)
+            {
+                tikhonov::TikhonovPath path(A);
+                auto proj = path.project(b);
+                squaredError += path.residual(proj, lambda);
+                x = path.solve(proj, lambda);
+            }
+            else
+            {
+                // Solve Ax = b (Least Squares)
+                // Using BDCSVD for robustness
+                x = A.bdcSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
+
+                // Reconstruct b_hat to check error
+                squaredError += (b - A * x).squaredNorm();
+            }
+
+            if (css)
+            {
+                // Reconstruct CSS = E * x
+                css->col(ch) = *bases[ch] * x;
+            }
+        }
+        return squaredError;
+    }
+
+    Eigen::Vector3f JiangEstimator::fitCss(const Eigen::MatrixXf& observations,
+                                           const ChannelSystems& systems,
+                                           const SearchOptions& options,
+                                           Eigen::MatrixXf& css) const
+    {
+        const priors::PriorsView::Matrix* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+
+        Eigen::Vector3f lambdas;
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            Eigen::VectorXf x;
+            lambdas[ch] = regularizedFit(tikhonov::TikhonovPath(systems[ch]), observations.col(ch), options, x);
+            css.col(ch) = *bases[ch] * x;
+        }
+        return lambdas;
+    }
+
+    Eigen::MatrixXf JiangEstimator::toObservations(const std::vector<Eigen::Vector3f>& rgbPatches) const
     {
         // 1. Validate Input
         if (rgbPatches.size() != 24)
@@ -29,91 +384,580 @@ namespace css::jiang
         {
             observations.row(i) = rgbPatches[i];
         }
+        return observations;
+    }
+
+    JiangResult JiangEstimator::solve(const std::vector<Eigen::Vector3f>& rgbPatches,
+                                      const SearchOptions& options) const
+    {
+        Eigen::MatrixXf observations = toObservations(rgbPatches);
 
-        float deltaLambda = 10.0f;
-        
         // 2. Optimization Loop
-        float bestError = std::numeric_limits<float>::max();
-        float bestCct = 0.0f;
-        Eigen::MatrixXf bestCss(33, 3);
-        Eigen::VectorXf bestIll(33);
+        Candidate best = searchIlluminant(m_daylight,
+            [&](const Eigen::Vector3f& w) { return evaluate(observations, w, options.lambda, nullptr); },
+            options);
+
+        // 3. Post-Process
+        Eigen::Vector3f bestWeights = m_daylight.weightsAt(best.cct, best.duv);
+        Eigen::MatrixXf bestCss(m_priors.reflectance.rows(), 3);
+        Eigen::Vector3f lambdas = fitCss(observations, daylightSystems(bestWeights), options, bestCss);
+        normalizeCss(bestCss);
+
+        JiangResult res;
+        res.estimatedCct = best.cct;
+        res.estimatedDuv = best.duv;
+        res.rmsError = std::sqrt(best.error);
+        res.illuminantWeights = bestWeights;
+        res.lambda = lambdas;
+        res.css = bestCss;
+        res.illuminant = m_daylightBasis * bestWeights;
+        res.grid = m_priors.grid;
 
-        // Search Range from MATLAB script: 4000 to 27000 step 100
-        for (int cct = 4000; cct <= 27000; cct += 100)
+        return res;
+    }
+
+    JiangResult JiangEstimator::solveFamily(const std::vector<Eigen::Vector3f>& rgbPatches,
+                                            const illuminant::IlluminantSet& family,
+                                            const SearchOptions& options) const
+    {
+        Eigen::MatrixXf observations = toObservations(rgbPatches);
+        if (family.size() == 0 || family.spectra.cols() != static_cast<Eigen::Index>(family.size()))
+        {
+            throw std::runtime_error("solveFamily: empty or inconsistent illuminant family.");
+        }
+
+        // Members are independent; their spectra come precomputed from the set
+        // (resampled once, as a whole, if the family uses another grid).
+        const Eigen::MatrixXf spectra = spectral::resample(family.spectra, family.grid, m_priors.grid);
+        std::vector<float> errors(family.size());
+        parallel::parallelFor(family.size(), [&](size_t i) {
+            errors[i] = evaluate(observations, spdSystems(spectra.col(static_cast<Eigen::Index>(i))),
+                                 options.lambda, nullptr);
+        });
+        const size_t best = static_cast<size_t>(std::min_element(errors.begin(), errors.end()) - errors.begin());
+
+        Eigen::VectorXf spd = spectra.col(static_cast<Eigen::Index>(best));
+        Eigen::MatrixXf bestCss(m_priors.reflectance.rows(), 3);
+        Eigen::Vector3f lambdas = fitCss(observations, spdSystems(spd), options, bestCss);
+        normalizeCss(bestCss);
+
+        JiangResult res;
+        res.estimatedCct = best < family.cct.size() ? family.cct[best] : 0.0f;
+        res.rmsError = std::sqrt(errors[best]);
+        res.illuminantWeights = Eigen::Vector3f::Zero();
+        res.illuminantLabel = family.labels[best];
+        res.lambda = lambdas;
+        res.css = bestCss;
+        res.illuminant = spd;
+        res.grid = m_priors.grid;
+
+        return res;
+    }
+
+    JointJiangResult JiangEstimator::solveJoint(const std::vector<std::vector<Eigen::Vector3f>>& captures,
+                                                const SearchOptions& options,
+                                                int maxIterations) const
+    {
+        if (captures.empty())
         {
-            float fCct = static_cast<float>(cct);
-            
-            // Generate Illuminant SPD (33x1)
-            Eigen::VectorXf ill = m_daylight.generate(fCct);
+            throw std::runtime_error("solveJoint: no captures given.");
+        }
+
+        const size_t n = captures.size();
+        std::vector<Eigen::MatrixXf> observations(n);
+        for (size_t c = 0; c < n; ++c)
+        {
+            observations[c] = toObservations(captures[c]);
+        }
+
+        // Initial illuminants: independent single-capture solves. Their
+        // unnormalized CSS differ by the capture exposure, which seeds the
+        // exposure estimate relative to the first capture.
+        std::vector<Candidate> ill(n);
+        std::vector<Eigen::MatrixXf> initialCss(n, Eigen::MatrixXf(m_priors.reflectance.rows(), 3));
+        parallel::parallelFor(n, [&](size_t c) {
+            Candidate best = searchIlluminant(m_daylight,
+                [&](const Eigen::Vector3f& w) { return evaluate(observations[c], w, options.lambda, nullptr); },
+                options);
+            evaluate(observations[c], m_daylight.weightsAt(best.cct, best.duv),
+                     options.lambda, &initialCss[c]);
+            ill[c] = best;
+        });
+
+        std::vector<float> exposure(n, 1.0f);
+        const float refNorm = initialCss[0].squaredNorm();
+        for (size_t c = 1; c < n; ++c)
+        {
+            float s = refNorm > 0.0f ? initialCss[0].cwiseProduct(initialCss[c]).sum() / refNorm : 0.0f;
+            exposure[c] = s > 0.0f ? s : 1.0f;
+        }
 
-            // Construct 'Radiance' under this illuminant
-            // Refl (33x24) * Diag(ill)
-            // Equivalent to col-wise multiplication
-            Eigen::MatrixXf R_ill = m_priors.reflectance; 
-            for (int r = 0; r < R_ill.rows(); ++r)
+        const priors::PriorsView::Matrix* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+        std::array<Eigen::VectorXf, 3> coeffs;
+        std::array<Eigen::MatrixXf, 3> Y;
+        Eigen::Vector3f lambdas = Eigen::Vector3f::Constant(options.lambda);
+
+        // With x fixed, the prediction is linear in the basis weights:
+        //     P(w) = sum_k w_k Y_k, Y_k(:, ch) = m_systems[ch][k] * x_ch.
+        auto updatePredictionBases = [&]() {
+            for (int k = 0; k < 3; ++k)
             {
-                R_ill.row(r) *= ill(r);
+                Y[k].resize(24, 3);
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    Y[k].col(ch) = m_systems[ch][k] * coeffs[ch];
+                }
             }
+        };
 
-            // Solve for each channel
-            Eigen::MatrixXf currentCss(33, 3);
-            float currentSquaredError = 0.0f;
+        // Shared CSS from normal equations accumulated per capture:
+        //     (sum_c s_c^2 A_c^T A_c + lambda I) x = sum_c s_c A_c^T b_c
+        // With GCV / L-curve, each channel's lambda is picked on the stacked
+        // system [s_1 A_1; s_2 A_2; ...] against [b_1; b_2; ...] without
+        // forming it: its singular values and residuals follow from these
+        // normal equations and sum_c ||b_c||^2.
+        auto solveShared = [&]() {
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                const Eigen::Index K = bases[ch]->cols();
+                Eigen::MatrixXd AtA = Eigen::MatrixXd::Zero(K, K);
+                Eigen::VectorXd Atb = Eigen::VectorXd::Zero(K);
+                double btb = 0.0;
 
-            // Pointers to basis matrices for convenient indexing
-            // 0=R, 1=G, 2=B
-            const Eigen::MatrixXf* bases[] = { &m_priors.basisR, &m_priors.basisG, &m_priors.basisB };
+                for (size_t c = 0; c < n; ++c)
+                {
+                    Eigen::Vector3f w = m_daylight.weightsAt(ill[c].cct, ill[c].duv);
+                    Eigen::MatrixXf A = w[0] * m_systems[ch][0]
+                                      + w[1] * m_systems[ch][1]
+                                      + w[2] * m_systems[ch][2];
+                    const Eigen::MatrixXd Ad = A.cast<double>();
+                    const Eigen::VectorXd b = observations[c].col(ch).cast<double>();
+                    const double s = exposure[c];
+                    AtA.noalias() += (s * s) * (Ad.transpose() * Ad);
+                    Atb.noalias() += s * (Ad.transpose() * b);
+                    btb += b.squaredNorm();
+                }
 
-            for (int ch = 0; ch < 3; ++ch)
+                if (options.regularization != tikhonov::LambdaSelection::Fixed)
+                {
+                    tikhonov::TikhonovPath::Projection projection;
+                    const auto path = tikhonov::TikhonovPath::fromNormalEquations(
+                        AtA, Atb, btb, 24 * static_cast<Eigen::Index>(n), projection);
+                    lambdas[ch] = path.selectLambda(projection, options.regularization, options.lambda);
+                }
+                AtA.diagonal().array() += lambdas[ch];
+                coeffs[ch] = AtA.bdcSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(Atb).cast<float>();
+            }
+
+            updatePredictionBases();
+        };
+
+        // Optimal exposure s = <P,b>/<P,P> for each capture, then the gauge is
+        // fixed to the first capture. Returns the total squared residual.
+        auto updateExposures = [&]() {
+            float total = 0.0f;
+            for (size_t c = 0; c < n; ++c)
             {
-                const Eigen::MatrixXf& E = *bases[ch]; // (33 x K)
-                
-                // System Matrix A = (R_ill^T * E) * deltaLambda
-                // R_ill is (33x24), R_ill^T is (24x33)
-                // A is (24 x K)
-                Eigen::MatrixXf A = (R_ill.transpose() * E) * deltaLambda;
+                Eigen::Vector3f w = m_daylight.weightsAt(ill[c].cct, ill[c].duv);
+                Eigen::MatrixXf P = w[0] * Y[0] + w[1] * Y[1] + w[2] * Y[2];
+                float pp = P.squaredNorm();
+                exposure[c] = pp > 0.0f ? P.cwiseProduct(observations[c]).sum() / pp : 1.0f;
+                ill[c].error = (observations[c] - exposure[c] * P).squaredNorm();
+                total += ill[c].error;
+            }
+            if (std::abs(exposure[0]) > 1e-12f)
+            {
+                const float s0 = exposure[0];
+                for (auto& s : exposure)
+                {
+                    s /= s0;
+                }
+            }
+            return total;
+        };
 
-                // b is (24x1) observed values for this channel
-                Eigen::VectorXf b = observations.col(ch);
+        // Gauss-Newton on (x, s_1..s_{n-1}) with the illuminants fixed. CSS and
+        // exposures are bilinear, so alternating solves alone converge slowly.
+        // Normal equations are again accumulated capture by capture.
+        auto refineSharedAndExposure = [&](int steps) {
+            const Eigen::Index offsets[] = { 0, bases[0]->cols(), bases[0]->cols() + bases[1]->cols() };
+            const Eigen::Index nx = offsets[2] + bases[2]->cols();
+            const Eigen::Index dim = nx + static_cast<Eigen::Index>(n) - 1;
 
-                // Solve Ax = b (Least Squares)
-                // Using BDCSVD for robustness
-                Eigen::VectorXf x = A.bdcSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
+            for (int step = 0; step < steps; ++step)
+            {
+                Eigen::MatrixXd H = Eigen::MatrixXd::Zero(dim, dim);
+                Eigen::VectorXd g = Eigen::VectorXd::Zero(dim);
 
-                // Reconstruct b_hat to check error
-                Eigen::VectorXf b_hat = A * x;
-                currentSquaredError += (b - b_hat).squaredNorm();
+                for (size_t c = 0; c < n; ++c)
+                {
+                    Eigen::Vector3f w = m_daylight.weightsAt(ill[c].cct, ill[c].duv);
+                    const double sc = exposure[c];
+                    const Eigen::Index js = nx + static_cast<Eigen::Index>(c) - 1;
 
-                // Reconstruct CSS = E * x
-                currentCss.col(ch) = E * x;
+                    for (int ch = 0; ch < 3; ++ch)
+                    {
+                        Eigen::MatrixXd A = (w[0] * m_systems[ch][0]
+                                           + w[1] * m_systems[ch][1]
+                                           + w[2] * m_systems[ch][2]).cast<double>();
+                        Eigen::VectorXd p = A * coeffs[ch].cast<double>();
+                        Eigen::VectorXd r = sc * p - observations[c].col(ch).cast<double>();
+                        const Eigen::Index o = offsets[ch];
+                        const Eigen::Index K = A.cols();
+
+                        H.block(o, o, K, K).noalias() += (sc * sc) * (A.transpose() * A);
+                        g.segment(o, K).noalias() += sc * (A.transpose() * r);
+                        if (c == 0)
+                        {
+                            // Tikhonov term lambda ||x||^2 of the shared CSS.
+                            H.block(o, o, K, K).diagonal().array() += static_cast<double>(lambdas[ch]);
+                            g.segment(o, K) += static_cast<double>(lambdas[ch]) * coeffs[ch].cast<double>();
+                        }
+
+                        if (c > 0)
+                        {
+                            Eigen::VectorXd cross = sc * (A.transpose() * p);
+                            H.block(o, js, K, 1) += cross;
+                            H.block(js, o, 1, K) += cross.transpose();
+                            H(js, js) += p.squaredNorm();
+                            g(js) += p.dot(r);
+                        }
+                    }
+                }
+
+                H.diagonal().array() += 1e-9 * std::max(1.0, H.diagonal().maxCoeff());
+                Eigen::VectorXd delta = H.ldlt().solve(-g);
+                if (!delta.allFinite())
+                {
+                    break;
+                }
+
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    coeffs[ch] += delta.segment(offsets[ch], coeffs[ch].size()).cast<float>();
+                }
+                for (size_t c = 1; c < n; ++c)
+                {
+                    exposure[c] += static_cast<float>(delta(nx + static_cast<Eigen::Index>(c) - 1));
+                }
             }
+            updatePredictionBases();
+        };
+
+        float totalError = std::numeric_limits<float>::max();
+        int iter = 0;
 
-            float rmsError = std::sqrt(currentSquaredError);
+        for (iter = 1; iter <= std::max(1, maxIterations); ++iter)
+        {
+            // (b) Shared CSS and exposures with the illuminants held fixed.
+            solveShared();
+            refineSharedAndExposure(5);
+
+            // (a) Per-capture illuminant (and implicit exposure) against the shared CSS.
+            std::vector<Candidate> next(n);
+            parallel::parallelFor(n, [&](size_t c) {
+                const Eigen::MatrixXf& b = observations[c];
+                const float bb = b.squaredNorm();
+                next[c] = searchIlluminant(m_daylight,
+                    [&](const Eigen::Vector3f& w) {
+                        Eigen::MatrixXf P = w[0] * Y[0] + w[1] * Y[1] + w[2] * Y[2];
+                        float pp = P.squaredNorm();
+                        float pb = P.cwiseProduct(b).sum();
+                        // Residual after the optimal exposure s = <P,b>/<P,P>
+                        return pp > 0.0f ? std::max(0.0f, bb - pb * pb / pp) : bb;
+                    },
+                    options);
+            });
 
-            if (rmsError < bestError)
+            bool moved = false;
+            for (size_t c = 0; c < n; ++c)
             {
-                bestError = rmsError;
-                bestCct = fCct;
-                bestCss = currentCss;
-                bestIll = ill;
+                moved = moved || next[c].cct != ill[c].cct || next[c].duv != ill[c].duv;
+                ill[c] = next[c];
+            }
+
+            float newError = updateExposures();
+            bool converged = !moved && std::abs(totalError - newError) <= 1e-6f * std::max(1.0f, newError);
+            totalError = newError;
+            if (converged)
+            {
+                break;
             }
         }
 
-        // 3. Post-Process
-        // Clip negatives
-        bestCss = bestCss.cwiseMax(0.0f);
-        
-        // Normalize max value to 1.0
-        float maxVal = bestCss.maxCoeff();
-        if (maxVal > 1e-6f)
+        // Final CSS consistent with the last illuminant update.
+        solveShared();
+        refineSharedAndExposure(5);
+        totalError = updateExposures();
+
+        JointJiangResult res;
+        res.grid = m_priors.grid;
+        res.iterations = std::min(iter, std::max(1, maxIterations));
+        res.rmsError = std::sqrt(totalError);
+        res.lambda = lambdas;
+
+        res.css.resize(m_priors.reflectance.rows(), 3);
+        for (int ch = 0; ch < 3; ++ch)
         {
-            bestCss /= maxVal;
+            res.css.col(ch) = *bases[ch] * coeffs[ch];
         }
+        normalizeCss(res.css);
+
+        res.captures.resize(n);
+        for (size_t c = 0; c < n; ++c)
+        {
+            CaptureIlluminant& out = res.captures[c];
+            out.estimatedCct = ill[c].cct;
+            out.estimatedDuv = ill[c].duv;
+            out.exposure = exposure[c];
+            out.rmsError = std::sqrt(ill[c].error);
+            out.illuminantWeights = m_daylight.weightsAt(ill[c].cct, ill[c].duv);
+            out.illuminant = m_daylightBasis * out.illuminantWeights;
+        }
+
+        return res;
+    }
+
+    JiangBatchSolver::JiangBatchSolver(const priors::CameraPriors& priors,
+                                       const SearchOptions& options)
+        : JiangBatchSolver(JiangEstimator(priors), options)
+    {
+    }
+
+    JiangBatchSolver::JiangBatchSolver(JiangEstimator estimator, const SearchOptions& options)
+        : m_estimator(std::move(estimator)),
+          m_options(options),
+          m_grid(searchGrid(options))
+    {
+        m_factors.resize(m_grid.size());
+
+        parallel::parallelFor(m_grid.size(), [&](size_t i) {
+            Eigen::Vector3f w = m_estimator.m_daylight.weightsAt(m_grid[i].x(), m_grid[i].y());
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                Eigen::MatrixXf A = w[0] * m_estimator.m_systems[ch][0]
+                                  + w[1] * m_estimator.m_systems[ch][1]
+                                  + w[2] * m_estimator.m_systems[ch][2];
+
+                // Same rank decision as the BDCSVD solve in JiangEstimator::evaluate.
+                Factorization& f = m_factors[i][ch];
+                f.A = A;
+                f.path = tikhonov::TikhonovPath(A);
+            }
+        });
+    }
+
+    JiangResult JiangBatchSolver::solve(const std::vector<Eigen::Vector3f>& rgbPatches) const
+    {
+        Eigen::MatrixXf observations = m_estimator.toObservations(rgbPatches);
+
+        // Grid residual from the cached SVD: ||b - U U^T b||^2 plus the damped
+        // in-range part when lambda > 0.
+        auto gridObjective = [&](size_t i) {
+            float squaredError = 0.0f;
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                const tikhonov::TikhonovPath& path = m_factors[i][ch].path;
+                squaredError += path.residual(path.project(observations.col(ch)), m_options.lambda);
+            }
+            return squaredError;
+        };
+
+        Candidate best = searchIlluminant(m_estimator.m_daylight,
+            [&](const Eigen::Vector3f& w) { return m_estimator.evaluate(observations, w, m_options.lambda, nullptr); },
+            m_options,
+            gridObjective);
+
+        const priors::PriorsView::Matrix* bases[] = { &m_estimator.m_priors.basisR,
+                                           &m_estimator.m_priors.basisG,
+                                           &m_estimator.m_priors.basisB };
+
+        Eigen::Vector3f bestWeights = m_estimator.m_daylight.weightsAt(best.cct, best.duv);
+        Eigen::MatrixXf bestCss(m_estimator.m_priors.reflectance.rows(), 3);
+        Eigen::Vector3f lambdas;
+
+        auto onGrid = std::find_if(m_grid.begin(), m_grid.end(), [&](const Eigen::Vector2f& g) {
+            return g.x() == best.cct && g.y() == best.duv;
+        });
+        if (onGrid != m_grid.end())
+        {
+            const auto& f = m_factors[static_cast<size_t>(onGrid - m_grid.begin())];
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                Eigen::VectorXf x;
+                lambdas[ch] = regularizedFit(f[ch].path, observations.col(ch), m_options, x);
+                bestCss.col(ch) = *bases[ch] * x;
+            }
+        }
+        else
+        {
+            lambdas = m_estimator.fitCss(observations, m_estimator.daylightSystems(bestWeights), m_options, bestCss);
+        }
+        normalizeCss(bestCss);
 
         JiangResult res;
-        res.estimatedCct = bestCct;
-        res.rmsError = bestError;
+        res.estimatedCct = best.cct;
+        res.estimatedDuv = best.duv;
+        res.rmsError = std::sqrt(best.error);
+        res.illuminantWeights = bestWeights;
+        res.lambda = lambdas;
         res.css = bestCss;
-        res.illuminant = bestIll;
+        res.illuminant = m_estimator.m_daylightBasis * bestWeights;
+        res.grid = m_estimator.m_priors.grid;
+
+        return res;
+    }
+
+    std::vector<JiangResult> JiangBatchSolver::solveBatch(const std::vector<std::vector<Eigen::Vector3f>>& charts) const
+    {
+        std::vector<JiangResult> results(charts.size());
+        parallel::parallelFor(charts.size(), [&](size_t i) {
+            results[i] = solve(charts[i]);
+        });
+        return results;
+    }
+
+    BootstrapResult JiangBatchSolver::bootstrap(const std::vector<Eigen::Vector3f>& rgbPatches,
+                                                const std::vector<Eigen::Vector3f>& patchSigma,
+                                                const BootstrapOptions& options) const
+    {
+        const Eigen::MatrixXf observations = m_estimator.toObservations(rgbPatches);
+        if (patchSigma.size() != rgbPatches.size())
+        {
+            throw std::runtime_error("bootstrap: patchSigma must match rgbPatches.");
+        }
+        if (options.resamples <= 0)
+        {
+            throw std::runtime_error("bootstrap: resamples must be positive.");
+        }
+
+        const int numPatches = static_cast<int>(observations.rows());
+        const Eigen::Index numBands = m_estimator.m_priors.reflectance.rows();
+        const size_t R = static_cast<size_t>(options.resamples);
+
+        const priors::PriorsView::Matrix* bases[] = { &m_estimator.m_priors.basisR,
+                                           &m_estimator.m_priors.basisG,
+                                           &m_estimator.m_priors.basisB };
+
+        // samples[r] is the normalized CSS of resample r.
+        std::vector<Eigen::MatrixXf> samples(R);
+        std::vector<float> ccts(R);
+        std::vector<float> duvs(R);
+
+        parallel::parallelFor(R, [&](size_t r) {
+            std::mt19937_64 rng(mixSeed(options.seed, r));
+            std::uniform_int_distribution<int> pick(0, numPatches - 1);
+            std::normal_distribution<float> gauss(0.0f, 1.0f);
+
+            Eigen::VectorXf counts = Eigen::VectorXf::Ones(numPatches);
+            if (options.resamplePatches)
+            {
+                counts.setZero();
+                for (int i = 0; i < numPatches; ++i)
+                {
+                    counts[pick(rng)] += 1.0f;
+                }
+            }
+
+            Eigen::MatrixXf b = observations;
+            if (options.noiseScale > 0.0f)
+            {
+                for (int i = 0; i < numPatches; ++i)
+                {
+                    for (int ch = 0; ch < 3; ++ch)
+                    {
+                        b(i, ch) += options.noiseScale * patchSigma[i][ch] * gauss(rng);
+                    }
+                }
+            }
+
+            auto gridObjective = [&](size_t g) {
+                float err = 0.0f;
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    err += weightedFit(m_factors[g][ch].A, counts, b.col(ch), m_options.lambda, nullptr);
+                }
+                return err;
+            };
+
+            auto assemble = [&](const Eigen::Vector3f& w, int ch) -> Eigen::MatrixXf {
+                return w[0] * m_estimator.m_systems[ch][0]
+                     + w[1] * m_estimator.m_systems[ch][1]
+                     + w[2] * m_estimator.m_systems[ch][2];
+            };
+
+            auto objective = [&](const Eigen::Vector3f& w) {
+                float err = 0.0f;
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    err += weightedFit(assemble(w, ch), counts, b.col(ch), m_options.lambda, nullptr);
+                }
+                return err;
+            };
+
+            Candidate best = searchIlluminant(m_estimator.m_daylight, objective, m_options, gridObjective);
+
+            Eigen::Vector3f w = m_estimator.m_daylight.weightsAt(best.cct, best.duv);
+            Eigen::MatrixXf css(numBands, 3);
+            const Eigen::VectorXf rowScale = counts.cwiseSqrt();
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                Eigen::VectorXf x;
+                if (m_options.regularization == tikhonov::LambdaSelection::Fixed)
+                {
+                    weightedFit(assemble(w, ch), counts, b.col(ch), m_options.lambda, &x);
+                }
+                else
+                {
+                    // Weights folded into the rows so GCV / L-curve see the resampled system.
+                    tikhonov::TikhonovPath path(rowScale.asDiagonal() * assemble(w, ch));
+                    regularizedFit(path, rowScale.cwiseProduct(b.col(ch)), m_options, x);
+                }
+                css.col(ch) = *bases[ch] * x;
+            }
+            normalizeCss(css);
+
+            samples[r] = std::move(css);
+            ccts[r] = best.cct;
+            duvs[r] = best.duv;
+        }, options.threads);
+
+        BootstrapResult res;
+        res.grid = m_estimator.m_priors.grid;
+        res.resamples = options.resamples;
+        res.percentiles = options.percentiles;
+        res.cct = std::move(ccts);
+        res.duv = std::move(duvs);
+        res.mean = Eigen::MatrixXf::Zero(numBands, 3);
+        res.stddev = Eigen::MatrixXf::Zero(numBands, 3);
+        res.bands.assign(options.percentiles.size(), Eigen::MatrixXf(numBands, 3));
+
+        // Per-wavelength, per-channel statistics across resamples.
+        parallel::parallelFor(static_cast<size_t>(numBands) * 3, [&](size_t idx) {
+            const Eigen::Index row = static_cast<Eigen::Index>(idx / 3);
+            const Eigen::Index ch = static_cast<Eigen::Index>(idx % 3);
+
+            std::vector<float> v(R);
+            double sum = 0.0;
+            double sumSq = 0.0;
+            for (size_t r = 0; r < R; ++r)
+            {
+                v[r] = samples[r](row, ch);
+                sum += v[r];
+                sumSq += static_cast<double>(v[r]) * v[r];
+            }
+            const double m = sum / static_cast<double>(R);
+            res.mean(row, ch) = static_cast<float>(m);
+            res.stddev(row, ch) = static_cast<float>(std::sqrt(std::max(0.0, sumSq / static_cast<double>(R) - m * m)));
+
+            for (size_t p = 0; p < options.percentiles.size(); ++p)
+            {
+                const float q = std::clamp(options.percentiles[p], 0.0f, 100.0f) / 100.0f;
+                const size_t k = std::min(R - 1, static_cast<size_t>(std::lround(q * static_cast<float>(R - 1))));
+                std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+                res.bands[p](row, ch) = v[k];
+            }
+        }, options.threads);
 
         return res;
     }
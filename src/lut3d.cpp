@@ -0,0 +1,278 @@
+#include "css/lut3d.hpp"
+
+#include "css/parallel.hpp"
+#include "simd/lut3d_impl.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace css::lut
+{
+    namespace
+    {
+        // Pixels per shaper + lookup pass: 3 KiB of floats, in L1.
+        constexpr size_t kChunk = 256;
+        constexpr int kShaperPoints = 4096;
+
+        // Same corners and weights as detail::applyLutRows, one pixel at a time.
+        void applyLutScalar(const detail::Grid& grid, const float* in, float* out, size_t count)
+        {
+            const int n = grid.size;
+            const float last = static_cast<float>(n - 1);
+            const size_t sr = 3, sg = 3 * static_cast<size_t>(n), sb = sg * n;
+            for (size_t i = 0; i < count; ++i)
+            {
+                float f[3];
+                size_t base = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float v = in[3 * i + c] * last;
+                    const float x = v > 0.0f ? std::min(v, last) : 0.0f; // NaN -> 0
+                    const float cell = std::min(std::floor(x), last - 1.0f);
+                    f[c] = x - cell;
+                    base += static_cast<size_t>(cell) * (c == 0 ? sb : c == 1 ? sg : sr);
+                }
+                const float fb = f[0], fg = f[1], fr = f[2];
+
+                const float hi = std::max(fr, std::max(fg, fb));
+                const float lo = std::min(fr, std::min(fg, fb));
+                const float mid = (fr + (fg + fb)) - (hi + lo);
+                const size_t first = fg <= fr ? (fb <= fr ? sr : sb) : (fb <= fg ? sg : sb);
+                const size_t least = fr <= fg ? (fr <= fb ? sr : sb) : (fg <= fb ? sg : sb);
+                const size_t diagonal = sr + sg + sb;
+
+                const float* t = grid.table;
+                for (int c = 0; c < 3; ++c)
+                {
+                    out[3 * i + c] = (1.0f - hi) * t[base + c] + (hi - mid) * t[base + first + c] +
+                                     (mid - lo) * t[base + diagonal - least + c] + lo * t[base + diagonal + c];
+                }
+            }
+        }
+
+        // Grid coordinates -> outputs, in place allowed.
+        void lookup(const Lut3D& lut, const float* coords, float* out, size_t count, kernel::Isa isa)
+        {
+            detail::Grid grid;
+            grid.table = lut.table.data();
+            grid.size = lut.size;
+            switch (isa)
+            {
+#if defined(CAMSPEC_X86_KERNELS)
+            case kernel::Isa::AVX512:
+                detail::applyLutRowsAvx512(grid, coords, out, count);
+                return;
+            case kernel::Isa::AVX2:
+                detail::applyLutRowsAvx2(grid, coords, out, count);
+                return;
+            case kernel::Isa::SSE42:
+                detail::applyLutRowsSse42(grid, coords, out, count);
+                return;
+#endif
+            default:
+                applyLutScalar(grid, coords, out, count);
+                return;
+            }
+        }
+
+        void checkLut(const Lut3D& lut)
+        {
+            if (lut.size < 2 || lut.table.size() != 3 * static_cast<size_t>(lut.size) * lut.size * lut.size)
+            {
+                throw std::runtime_error("3D LUT is empty or its table does not match its size");
+            }
+        }
+
+        template <class T>
+        void applyRowQuantized(const Lut3D& lut, const float* in, T* out, size_t count, kernel::Isa isa)
+        {
+            constexpr float maxCode = static_cast<float>(std::numeric_limits<T>::max());
+            float buffer[3 * kChunk];
+            for (size_t i = 0; i < count; i += kChunk)
+            {
+                const size_t n = std::min(kChunk, count - i);
+                kernel::applyRow(lut.shaper, in + 3 * i, buffer, n, isa);
+                lookup(lut, buffer, buffer, n, isa);
+                T* dst = out + 3 * i;
+                for (size_t k = 0; k < 3 * n; ++k)
+                {
+                    const float v = buffer[k] > 0.0f ? std::min(buffer[k], 1.0f) : 0.0f; // NaN -> 0
+                    dst[k] = static_cast<T>(v * maxCode + 0.5f);
+                }
+            }
+        }
+
+        // Piecewise-linear tone curve over [0, 1]; empty = identity.
+        double toneValue(const std::vector<float>& curve, double v)
+        {
+            if (curve.empty())
+            {
+                return v;
+            }
+            const double x = std::clamp(v, 0.0, 1.0) * static_cast<double>(curve.size() - 1);
+            const size_t i = std::min(static_cast<size_t>(x), curve.size() - 2);
+            return curve[i] + (x - static_cast<double>(i)) * (curve[i + 1] - curve[i]);
+        }
+    } // namespace
+
+    Lut3D bake(const Transform& fn, int size, const transfer::TransferFunction& shaper,
+               const Eigen::Matrix3f& inputMatrix)
+    {
+        // Table offsets must stay exact in float lanes (below 2^24).
+        if (size < 2 || size > 129)
+        {
+            throw std::runtime_error("3D LUT size must be between 2 and 129, got " + std::to_string(size));
+        }
+
+        Lut3D lut;
+        lut.size = size;
+        lut.shaper.matrix = inputMatrix;
+        lut.shaper.encoding = shaper;
+        if (shaper.curve != transfer::Curve::Linear)
+        {
+            lut.shaper.lut = std::make_shared<const transfer::EncodeLut>(shaper);
+        }
+
+        // Linear value of every grid coordinate.
+        std::vector<float> axis(static_cast<size_t>(size));
+        for (int i = 0; i < size; ++i)
+        {
+            axis[i] = static_cast<float>(transfer::decodeReference(shaper, static_cast<double>(i) / (size - 1)));
+        }
+
+        const size_t n = static_cast<size_t>(size);
+        lut.table.resize(3 * n * n * n);
+        parallel::parallelFor(n, [&](size_t b) {
+            for (size_t g = 0; g < n; ++g)
+            {
+                for (size_t r = 0; r < n; ++r)
+                {
+                    const Eigen::Vector3f out = fn(Eigen::Vector3f(axis[b], axis[g], axis[r]));
+                    float* entry = lut.table.data() + 3 * (r + n * (g + n * b));
+                    entry[0] = out[0];
+                    entry[1] = out[1];
+                    entry[2] = out[2];
+                }
+            }
+        });
+        return lut;
+    }
+
+    Lut3D bake(const profile::Profile& prof, const BakeOptions& options)
+    {
+        if (options.toneCurve.size() == 1)
+        {
+            throw std::runtime_error("Tone curve needs at least two samples");
+        }
+
+        // Root-polynomial terms have no place in the shaper, so those
+        // profiles always run in the grid.
+        kernel::ColorTransform inGrid = kernel::makeTransform(prof, transfer::TransferFunction{transfer::Curve::Linear});
+        const bool matrixInShaper = options.matrixInShaper && prof.model == profile::Model::Linear;
+        const Eigen::Matrix3f matrix = inGrid.matrix;
+        if (matrixInShaper)
+        {
+            inGrid.matrix = Eigen::Matrix3f::Identity();
+        }
+        return bake([&](const Eigen::Vector3f& bgr) {
+            Eigen::Vector3f linear;
+            kernel::applyRow(inGrid, bgr.data(), linear.data(), 1, kernel::Isa::Scalar);
+            Eigen::Vector3f out;
+            for (int c = 0; c < 3; ++c)
+            {
+                const double encoded = transfer::encodeReference(options.encoding, linear[c]);
+                out[c] = static_cast<float>(toneValue(options.toneCurve, encoded));
+            }
+            return out;
+        }, options.size, options.shaper, matrixInShaper ? matrix : Eigen::Matrix3f::Identity());
+    }
+
+    void applyRow(const Lut3D& lut, const float* in, float* out, size_t count, kernel::Isa isa)
+    {
+        checkLut(lut);
+        isa = std::min(isa, kernel::detectIsa());
+        for (size_t i = 0; i < count; i += kChunk)
+        {
+            const size_t n = std::min(kChunk, count - i);
+            float buffer[3 * kChunk];
+            kernel::applyRow(lut.shaper, in + 3 * i, buffer, n, isa);
+            lookup(lut, buffer, out + 3 * i, n, isa);
+        }
+    }
+
+    void applyRow(const Lut3D& lut, const float* in, std::uint16_t* out, size_t count, kernel::Isa isa)
+    {
+        checkLut(lut);
+        applyRowQuantized(lut, in, out, count, std::min(isa, kernel::detectIsa()));
+    }
+
+    void applyRow(const Lut3D& lut, const float* in, std::uint8_t* out, size_t count, kernel::Isa isa)
+    {
+        checkLut(lut);
+        applyRowQuantized(lut, in, out, count, std::min(isa, kernel::detectIsa()));
+    }
+
+    void writeCube(const Lut3D& lut, const std::string& path, const std::string& title)
+    {
+        checkLut(lut);
+        if (!lut.shaper.matrix.isIdentity())
+        {
+            throw std::runtime_error("A .cube file cannot hold the shaper matrix; bake without matrixInShaper");
+        }
+        std::ofstream out(path);
+        if (!out)
+        {
+            throw std::runtime_error("Failed to open for writing: " + path);
+        }
+
+        char line[96];
+        auto triple = [&](float r, float g, float b) {
+            std::snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", r, g, b);
+            out << line;
+        };
+
+        // Shaper input that reaches code 1.0 (above 1 for PQ).
+        const bool shaped = lut.shaper.encoding.curve != transfer::Curve::Linear;
+        const double top = transfer::decodeReference(lut.shaper.encoding, 1.0);
+
+        out << "TITLE \"" << title << "\"\n";
+        if (shaped)
+        {
+            std::snprintf(line, sizeof(line), "LUT_1D_INPUT_RANGE 0.0 %.6f\n", top);
+            out << "LUT_1D_SIZE " << kShaperPoints << "\n" << line;
+        }
+        out << "LUT_3D_SIZE " << lut.size << "\n";
+        if (shaped)
+        {
+            out << "LUT_3D_INPUT_RANGE 0.0 1.0\n";
+        }
+        out << "\n";
+
+        if (shaped)
+        {
+            for (int i = 0; i < kShaperPoints; ++i)
+            {
+                const float v = static_cast<float>(
+                    transfer::encodeReference(lut.shaper.encoding, top * i / (kShaperPoints - 1)));
+                triple(v, v, v);
+            }
+            out << "\n";
+        }
+
+        // Entries are BGR in .cube order; the file wants R G B.
+        for (size_t i = 0; i < lut.table.size(); i += 3)
+        {
+            triple(lut.table[i + 2], lut.table[i + 1], lut.table[i]);
+        }
+
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write .cube file: " + path);
+        }
+    }
+} // namespace css::lut
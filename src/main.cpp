@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -7,14 +12,20 @@
 #include <opencv2/core.hpp>
 
 #include "css/chart.hpp"
+#include "css/colorspace.hpp"
 #include "css/io.hpp"
+#include "css/lut3d.hpp"
 #include "css/pipeline.hpp"
 
 #include "css/profile.hpp"
 // New headers
 #include "css/priors.hpp"
 #include "css/jiang.hpp"
+#include "css/illuminant.hpp"
 #include "css/spectral.hpp"
+#include "css/parallel.hpp"
+#include "css/render.hpp"
+#include "css/spectral_db.hpp"
 
 namespace fs = std::filesystem;
 
@@ -25,17 +36,75 @@ namespace
         std::cout << "camspec - DNG + ColorChecker calibration\n\n"
                   << "Usage:\n"
                   << "  camspec calibrate --input chart.dng --profile-out prof.txt \\\n"
-                  << "                     [--ref-data data/colorchecker_24_D65.csv] \\\n"
+                  << "                     [--ref-data colorchecker.csv] \\\n"
                   << "                     [--camera-name MyCamera] \\\n"
-                  << "                     [--illuminant D65] \\\n"
-                  << "                     [--corners x0,y0,x1,y1,x2,y2,x3,y3]\n"
+                  << "                     [--illuminant D65|A|F11|3200K] \\\n"
+                  << "                     [--spectral-ref] [--adaptation bradford|none] [--assets assets.yaml] \\\n"
+                  << "                     [--spds spds.csv] \\\n"
+                  << "                     [--corners x0,y0,x1,y1,x2,y2,x3,y3] \\\n"
+                  << "                     [--lambda gcv|lcurve|<value>] [--model linear|rp2|rp3]\n"
                   << "\n"
+                  << "  --model fits a root-polynomial correction (3x6 or 3x13) instead of a 3x3 matrix.\n"
+                  << "  --ref-data overrides the built-in ColorChecker 24 reference (data/colorchecker_24_D65.csv).\n"
+                  << "  Without it, illuminants other than D65 (or --spectral-ref) compute the reference from\n"
+                  << "  the chart reflectances in --assets, adapted to the D65 white of linear sRGB.\n"
+                  << "  --spds adds measured SPDs (wavelength_nm,<name>,...) that --illuminant can name.\n"
                   << "  If --corners is omitted, an interactive corner picker will launch.\n"
                   << "  Click corners in order: Patch 1 (top-left), Patch 6 (top-right),\n"
                   << "                          Patch 19 (bottom-left), Patch 24 (bottom-right).\n"
                   << "\n"
-                  << "  camspec apply --input img.dng --profile prof.txt --output out.tif\n"
-                  << "  camspec recover-css --input chart.dng --output css.csv [--assets assets.yaml] [--corners ...]\n"
+                  << "  camspec apply --input img.dng --profile prof.txt --output out.tif [--threads N] \\\n"
+                  << "                [--transfer srgb|rec709|pq[:white_nits]|hlg|gamma:<g>|linear] [--fixed-point] \\\n"
+                  << "                [--demosaic mhc|bilinear] [--lut 17|33|65] \\\n"
+                  << "                [--output-space <space>] [--cat bradford|cat16|none]\n"
+                  << "    --lut bakes the profile and transfer function into an N^3 3D LUT and applies that.\n"
+                  << "    --output-space renders into linear_srgb, linear_rec2020, linear_p3, aces_ap0, aces_ap1,\n"
+                  << "    xyz_d65 or xyz_d50; the conversion (white adapted with --cat) is folded into the\n"
+                  << "    profile matrix, so it costs nothing per pixel.\n"
+                  << "  camspec bake-lut --profile prof.txt --output look.cube [--size 17|33|65] \\\n"
+                  << "                   [--transfer srgb|rec709|pq[:white_nits]|hlg|gamma:<g>|linear] [--shaper <curve>] \\\n"
+                  << "                   [--output-space <space>] [--cat bradford|cat16|none]\n"
+                  << "    Writes the profile as a .cube 3D LUT on linear camera RGB, with --shaper (sRGB by\n"
+                  << "    default) as a 1D input shaper.\n"
+                  << "  camspec recover-css --input chart.dng --output css.csv [--assets assets.yaml] [--corners ...] \\\n"
+                  << "                      [--off-planckian] [--lambda gcv|lcurve|<value>] [--bootstrap N [--seed S]]\n"
+                  << "                      [--family blackbody|daylight|cie|spds.csv]\n"
+                  << "    --lambda regularizes the fit: a fixed value, or picked per channel by GCV / L-curve.\n"
+                  << "    --family searches an illuminant family instead of the daylight locus; a CSV\n"
+                  << "    (wavelength_nm,<name>,...) adds e.g. CIE F-series or measured LED SPDs.\n"
+                  << "    --bootstrap writes percentile bands to <output>_bands.csv.\n"
+                  << "    Repeat --input (and --corners, in the same order) to solve one CSS jointly\n"
+                  << "    from captures under different illuminants.\n"
+                  << "  camspec recover-css-batch --list charts.csv --output-dir out/ [--assets assets.yaml] \\\n"
+                  << "                            [--off-planckian] [--lambda gcv|lcurve|<value>]\n"
+                  << "    charts.csv lines: path,x0,y0,x1,y1,x2,y2,x3,y3 (writes out/<name>_css.csv)\n"
+                  << "  camspec render (--css css.csv | --db db.csdb --camera NAME) \\\n"
+                  << "                 (--reflectances spectra.csv | --db db.csdb --reflectance-set NAME) --output rgb.csv \\\n"
+                  << "                 [--illuminants D65,A,3200K | --family blackbody|daylight|cie|spds.csv] \\\n"
+                  << "                 [--normalize] [--percent]\n"
+                  << "    Predicts camera RGB for every reflectance under every illuminant.\n"
+                  << "    spectra.csv: name,<wavelength_nm>,... header, one spectrum per line (streamed).\n"
+                  << "    --normalize scales each illuminant so a perfect white has G = 1.\n"
+                  << "  camspec synthesize-profile --css css.csv (--profile-out prof.txt | --output-dir out/) \\\n"
+                  << "                 [--illuminants D65,A,3200K | --family blackbody|daylight|cie|spds.csv] \\\n"
+                  << "                 [--reflectances spectra.csv [--percent] | --assets assets.yaml] \\\n"
+                  << "                 [--reference D65] [--camera-name MyCamera] [--lambda gcv|lcurve|<value>] \\\n"
+                  << "                 [--model linear|rp2|rp3]\n"
+                  << "    Builds profiles without a chart shot: training spectra are rendered through the CSS\n"
+                  << "    and through the CIE 1931 observer (under --reference) and the matrix is fitted.\n"
+                  << "    Several illuminants write out/<camera>_<illuminant>.txt.\n"
+                  << "  camspec build-priors --output priors.yaml|priors.cspri [--css-dir camSpecSensitivity | --css-db db.csdb [--dataset NAME]] \\\n"
+                  << "                 [--components 3] [--grid first,last,step] [--svd auto|exact|randomized] \\\n"
+                  << "                 [--reflectances chart.csv [--percent] | --template assets.yaml] [--raw-scale]\n"
+                  << "    Per-channel PCA bases from a directory of CSS CSVs (wavelength_nm,R,G,B).\n"
+                  << "    Chart reflectances come from --reflectances or the --template priors.\n"
+                  << "  camspec db-pack --output db.csdb [--grid first,last,step] [--sensitivities dir/]... \\\n"
+                  << "                  [--reflectances spectra.csv [--percent]]... [--illuminants spds.csv]...\n"
+                  << "    Packs curves into a columnar, memory-mapped spectral database (one dataset per source).\n"
+                  << "  camspec db-info --db db.csdb\n"
+                  << "  camspec priors-compile [--input assets.yaml] [--output assets.cspri]\n"
+                  << "    Converts YAML priors to the memory-mapped binary format. --assets accepts\n"
+                  << "    either format; a compiled assets.cspri is preferred when no --assets is given.\n"
                   << std::endl;
     }
 
@@ -74,14 +143,60 @@ namespace
         return filename;
     }
 
+    // Prefer a compiled assets.cspri (see priors-compile) over parsing assets.yaml.
+    std::string findPriorsFile()
+    {
+        std::string compiled = findDataFile("assets.cspri");
+        return fs::exists(compiled) ? compiled : findDataFile("assets.yaml");
+    }
+
+    // Binary priors are solved against in place from the mapping; YAML is parsed into memory.
+    css::jiang::JiangEstimator loadEstimator(const std::string& path)
+    {
+        if (css::priors::isPriorsBinary(path))
+        {
+            return css::jiang::JiangEstimator(std::make_shared<const css::priors::MappedPriors>(path));
+        }
+        return css::jiang::JiangEstimator(css::priors::loadPriorsFromYaml(path));
+    }
+
+    // --lambda gcv | lcurve | <value>
+    void parseLambda(const std::string& val, css::tikhonov::LambdaSelection& selection, float& lambda)
+    {
+        if (val == "gcv")
+        {
+            selection = css::tikhonov::LambdaSelection::GCV;
+        }
+        else if (val == "lcurve")
+        {
+            selection = css::tikhonov::LambdaSelection::LCurve;
+        }
+        else
+        {
+            selection = css::tikhonov::LambdaSelection::Fixed;
+            lambda = std::stof(val);
+            if (lambda < 0.0f)
+            {
+                throw std::runtime_error("--lambda must be non-negative");
+            }
+        }
+    }
+
     int runCalibrate(const std::vector<std::string>& args)
     {
         std::string inputPath;
         std::string profileOutPath;
-        std::string refDataPath = findDataFile("colorchecker_24_D65.csv");
+        std::string refDataPath; // empty = reference compiled in from data/
         std::string cameraName = "camera";
         std::string illuminant = "D65";
+        std::string assetsPath = findPriorsFile();
+        std::string spdsPath;
+        bool spectralRef = false;
+        css::refdata::Adaptation adaptation = css::refdata::Adaptation::Bradford;
         css::chart::ChartConfig chartCfg;
+        css::tikhonov::LambdaSelection regularization = css::tikhonov::LambdaSelection::Fixed;
+        float lambda = 1e-4f;
+        css::profile::Model model = css::profile::Model::Linear;
 
         bool haveCorners = false;
 
@@ -124,6 +239,33 @@ namespace
             {
                 illuminant = next("--illuminant");
             }
+            else if (a == "--spectral-ref")
+            {
+                spectralRef = true;
+            }
+            else if (a == "--adaptation")
+            {
+                std::string val = next("--adaptation");
+                if (val == "bradford") adaptation = css::refdata::Adaptation::Bradford;
+                else if (val == "none") adaptation = css::refdata::Adaptation::None;
+                else throw std::runtime_error("--adaptation must be bradford or none");
+            }
+            else if (a == "--assets")
+            {
+                assetsPath = next("--assets");
+            }
+            else if (a == "--spds")
+            {
+                spdsPath = next("--spds");
+            }
+            else if (a == "--lambda")
+            {
+                parseLambda(next("--lambda"), regularization, lambda);
+            }
+            else if (a == "--model")
+            {
+                model = css::profile::parseModel(next("--model"));
+            }
             else if (a == "--corners")
             {
                 std::string val = next("--corners");
@@ -163,12 +305,36 @@ namespace
             chartCfg = css::chart::pickCornersInteractively(img);
         }
 
-        std::cout << "Loading reference data: " << refDataPath << std::endl;
         css::pipeline::CalibrateConfig cfg;
         cfg.chart = chartCfg;
         cfg.refDataCsvPath = refDataPath;
         cfg.illuminant = illuminant;
+        cfg.spectralReference = spectralRef;
+        cfg.adaptation = adaptation;
+
+        if (refDataPath.empty() && (spectralRef || illuminant != "D65"))
+        {
+            auto priors = css::priors::loadPriors(assetsPath);
+            cfg.chartReflectance = priors.reflectance;
+            cfg.chartGrid = priors.grid;
+            if (!spdsPath.empty())
+            {
+                auto library = std::make_shared<css::illuminant::IlluminantLibrary>(priors.grid);
+                library->loadCsv(spdsPath, fs::path(spdsPath).stem().string());
+                cfg.illuminants = library;
+            }
+            std::cout << "Reference data: ColorChecker 24 spectra from " << assetsPath << " under " << illuminant
+                      << (adaptation == css::refdata::Adaptation::Bradford ? ", Bradford-adapted to D65" : "")
+                      << std::endl;
+        }
+        else
+        {
+            std::cout << "Reference data: " << (refDataPath.empty() ? "built-in ColorChecker 24 (D65)" : refDataPath) << std::endl;
+        }
         cfg.cameraName = cameraName;
+        cfg.regularization = regularization;
+        cfg.lambda = lambda;
+        cfg.model = model;
 
         std::cout << "Running calibration..." << std::endl;
         auto prof = css::pipeline::calibrateFromChart(img, cfg);
@@ -191,6 +357,12 @@ namespace
         std::string inputPath;
         std::string profilePath;
         std::string outputPath;
+        css::pipeline::ApplyOptions applyOpts;
+        applyOpts.depth = CV_16U;
+        bool fixedPoint = false;
+        int lutSize = 0;
+        std::string outputSpace;
+        css::colorspace::Cat cat = css::colorspace::Cat::Bradford;
 
         for (size_t i = 0; i < args.size(); ++i)
         {
@@ -215,6 +387,34 @@ namespace
             {
                 outputPath = next("--output");
             }
+            else if (a == "--threads")
+            {
+                applyOpts.threads = static_cast<unsigned>(std::stoul(next("--threads")));
+            }
+            else if (a == "--transfer")
+            {
+                applyOpts.transfer = css::transfer::parseTransfer(next("--transfer"));
+            }
+            else if (a == "--fixed-point")
+            {
+                fixedPoint = true;
+            }
+            else if (a == "--demosaic")
+            {
+                applyOpts.demosaic = css::demosaic::parseMethod(next("--demosaic"));
+            }
+            else if (a == "--lut")
+            {
+                lutSize = std::stoi(next("--lut"));
+            }
+            else if (a == "--output-space")
+            {
+                outputSpace = next("--output-space");
+            }
+            else if (a == "--cat")
+            {
+                cat = css::colorspace::parseCat(next("--cat"));
+            }
         }
 
         if (inputPath.empty() || profilePath.empty() || outputPath.empty())
@@ -222,23 +422,56 @@ namespace
             throw std::runtime_error("apply: missing required arguments");
         }
 
-        cv::Mat img = css::io::loadDngAsLinearRgb(inputPath);
         auto prof = css::profile::loadProfile(profilePath);
+        if (!outputSpace.empty())
+        {
+            prof = css::colorspace::retarget(prof, outputSpace, cat);
+        }
+
+        // TIFF output renders in one tiled pass; other formats go through full frames.
+        std::string ext = fs::path(outputPath).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if ((ext == ".tif" || ext == ".tiff") && lutSize == 0)
+        {
+            css::pipeline::renderDngToTiff(inputPath, prof, outputPath, applyOpts, fixedPoint);
+            std::cout << "Applied profile and wrote " << outputPath << std::endl;
+            return 0;
+        }
 
-        cv::Mat corrected = css::pipeline::applyProfile(img, prof, true);
-        css::io::saveImage(outputPath, corrected, 16);
+        cv::Mat corrected;
+        if (lutSize > 0)
+        {
+            css::lut::BakeOptions bake;
+            bake.size = lutSize;
+            bake.encoding = applyOpts.transfer;
+            const css::lut::Lut3D lut = css::lut::bake(prof, bake);
+            cv::Mat img = css::io::loadDngAsLinearRgb(inputPath, applyOpts.demosaic);
+            corrected = css::pipeline::applyLut(img, lut, applyOpts);
+        }
+        else if (fixedPoint)
+        {
+            const css::io::RawImage16 raw = css::io::loadDngAsRgb16(inputPath, applyOpts.demosaic);
+            corrected = css::pipeline::applyProfileFixed(raw.image, raw.whiteLevel, prof, applyOpts);
+        }
+        else
+        {
+            cv::Mat img = css::io::loadDngAsLinearRgb(inputPath, applyOpts.demosaic);
+            corrected = css::pipeline::applyProfile(img, prof, applyOpts);
+        }
+        css::io::saveImage(outputPath, corrected);
 
         std::cout << "Applied profile and wrote " << outputPath << std::endl;
         return 0;
     }
 
-    int runRecoverCss(const std::vector<std::string>& args)
+    int runBakeLut(const std::vector<std::string>& args)
     {
-        std::string inputPath;
+        std::string profilePath;
         std::string outputPath;
-        std::string assetsPath = findDataFile("assets.yaml");
-        css::chart::ChartConfig chartCfg;
-        bool haveCorners = false;
+        css::lut::BakeOptions bake;
+        bake.matrixInShaper = false; // a .cube has nowhere to put the matrix
+        std::string outputSpace;
+        css::colorspace::Cat cat = css::colorspace::Cat::Bradford;
 
         for (size_t i = 0; i < args.size(); ++i)
         {
@@ -248,41 +481,72 @@ namespace
                 return args[++i];
             };
 
-            if (a == "--input") inputPath = next("--input");
+            if (a == "--profile") profilePath = next("--profile");
             else if (a == "--output") outputPath = next("--output");
-            else if (a == "--assets") assetsPath = next("--assets");
-            else if (a == "--corners")
-            {
-                std::string val = next("--corners");
-                std::vector<float> c;
-                std::string token;
-                std::stringstream ss(val);
-                while(std::getline(ss, token, ',')) c.push_back(std::stof(token));
-                if (c.size() != 8) throw std::runtime_error("Expected 8 coords for corners");
-                chartCfg.topLeft = {c[0], c[1]};
-                chartCfg.topRight = {c[2], c[3]};
-                chartCfg.bottomRight = {c[4], c[5]};
-                chartCfg.bottomLeft = {c[6], c[7]};
-                haveCorners = true;
-            }
+            else if (a == "--size") bake.size = std::stoi(next("--size"));
+            else if (a == "--transfer") bake.encoding = css::transfer::parseTransfer(next("--transfer"));
+            else if (a == "--shaper") bake.shaper = css::transfer::parseTransfer(next("--shaper"));
+            else if (a == "--output-space") outputSpace = next("--output-space");
+            else if (a == "--cat") cat = css::colorspace::parseCat(next("--cat"));
         }
 
-        if (inputPath.empty() || outputPath.empty())
+        if (profilePath.empty() || outputPath.empty())
         {
-            throw std::runtime_error("recover-css: missing --input or --output");
+            throw std::runtime_error("bake-lut: missing required arguments");
         }
 
-        // 1. Load Priors
-        std::cout << "Loading priors from " << assetsPath << std::endl;
-        auto priors = css::priors::loadPriorsFromYaml(assetsPath);
+        auto prof = css::profile::loadProfile(profilePath);
+        if (!outputSpace.empty())
+        {
+            prof = css::colorspace::retarget(prof, outputSpace, cat);
+        }
+        const css::lut::Lut3D lut = css::lut::bake(prof, bake);
+        css::lut::writeCube(lut, outputPath, prof.cameraName.empty() ? "camspec" : prof.cameraName);
+
+        std::cout << "Wrote " << bake.size << "^3 LUT (" << css::transfer::transferName(bake.encoding)
+                  << ", shaper " << css::transfer::transferName(bake.shaper) << ") to " << outputPath << std::endl;
+        return 0;
+    }
 
+    css::chart::ChartConfig parseCorners(const std::string& val)
+    {
+        std::vector<float> c;
+        std::string token;
+        std::stringstream ss(val);
+        while(std::getline(ss, token, ',')) c.push_back(std::stof(token));
+        if (c.size() != 8) throw std::runtime_error("Expected 8 coords for corners");
+        css::chart::ChartConfig chartCfg;
+        chartCfg.topLeft = {c[0], c[1]};
+        chartCfg.topRight = {c[2], c[3]};
+        chartCfg.bottomRight = {c[4], c[5]};
+        chartCfg.bottomLeft = {c[6], c[7]};
+        return chartCfg;
+    }
+
+    void saveCss(const std::string& outputPath, const Eigen::MatrixXf& curves,
+                 const css::spectral::SpectralGrid& grid)
+    {
+        // Convert curves (grid.count x 3) to samples on the priors' grid.
+        auto sens = css::spectral::fromMatrix(curves, grid, "Recovered");
+        css::spectral::saveSpectralSensitivityCsv(outputPath, sens);
+    }
+
+    std::vector<Eigen::Vector3f> loadChartPatches(const std::string& inputPath,
+                                                  const css::chart::ChartConfig* corners,
+                                                  std::vector<Eigen::Vector3f>* patchSigma = nullptr)
+    {
         // 2. Load Image
         std::cout << "Loading DNG: " << inputPath << std::endl;
         cv::Mat img = css::io::loadDngAsLinearRgb(inputPath);
         std::cout << "Image loaded: " << img.cols << "x" << img.rows << std::endl;
 
         // 3. Get Corners
-        if (!haveCorners)
+        css::chart::ChartConfig chartCfg;
+        if (corners)
+        {
+            chartCfg = *corners;
+        }
+        else
         {
              std::cout << "No corners provided, launching interactive corner picker..." << std::endl;
              chartCfg = css::chart::pickCornersInteractively(img);
@@ -303,32 +567,825 @@ namespace
             rgbPatches.emplace_back(s.meanBgr[0], s.meanBgr[1], s.meanBgr[2]);
         }
 
+        if (patchSigma)
+        {
+            // Standard error of the patch mean, same channel order as rgbPatches.
+            patchSigma->clear();
+            for (const auto& s : samples)
+            {
+                float n = static_cast<float>(std::max(1, s.pixelCount));
+                patchSigma->emplace_back(s.stdBgr[0], s.stdBgr[1], s.stdBgr[2]);
+                patchSigma->back() /= std::sqrt(n);
+            }
+        }
+        return rgbPatches;
+    }
+
+    void saveBands(const std::string& path, const css::jiang::BootstrapResult& boot)
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            throw std::runtime_error("Failed to open bands CSV for writing: " + path);
+        }
+
+        const char* channels[] = {"R", "G", "B"};
+        out << "wavelength_nm";
+        for (const char* ch : channels)
+        {
+            for (float p : boot.percentiles)
+            {
+                out << "," << ch << "_p" << p;
+            }
+            out << "," << ch << "_std";
+        }
+        out << "\n";
+
+        for (int i = 0; i < boot.mean.rows(); ++i)
+        {
+            out << boot.grid.wavelength(i);
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                for (const auto& band : boot.bands)
+                {
+                    out << "," << band(i, ch);
+                }
+                out << "," << boot.stddev(i, ch);
+            }
+            out << "\n";
+        }
+    }
+
+    int runRecoverCss(const std::vector<std::string>& args)
+    {
+        std::vector<std::string> inputPaths;
+        std::string outputPath;
+        std::string assetsPath = findPriorsFile();
+        std::vector<css::chart::ChartConfig> chartCfgs; // one per --input, in order
+        css::jiang::SearchOptions searchOpts;
+        css::jiang::BootstrapOptions bootOpts;
+        bool bootstrap = false;
+        std::string familyName;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--input") inputPaths.push_back(next("--input"));
+            else if (a == "--output") outputPath = next("--output");
+            else if (a == "--assets") assetsPath = next("--assets");
+            else if (a == "--off-planckian") searchOpts.model = css::jiang::IlluminantModel::OffPlanckian;
+            else if (a == "--lambda") parseLambda(next("--lambda"), searchOpts.regularization, searchOpts.lambda);
+            else if (a == "--corners") chartCfgs.push_back(parseCorners(next("--corners")));
+            else if (a == "--bootstrap")
+            {
+                bootOpts.resamples = std::stoi(next("--bootstrap"));
+                bootstrap = true;
+            }
+            else if (a == "--seed") bootOpts.seed = std::stoull(next("--seed"));
+            else if (a == "--family") familyName = next("--family");
+        }
+
+        if (inputPaths.empty() || outputPath.empty())
+        {
+            throw std::runtime_error("recover-css: missing --input or --output");
+        }
+        if (bootstrap && inputPaths.size() != 1)
+        {
+            throw std::runtime_error("recover-css: --bootstrap takes a single --input");
+        }
+        if (!familyName.empty() && (inputPaths.size() != 1 || bootstrap))
+        {
+            throw std::runtime_error("recover-css: --family takes a single --input and no --bootstrap");
+        }
+
+        // 1. Load Priors
+        std::cout << "Loading priors from " << assetsPath << std::endl;
+        const css::jiang::JiangEstimator estimator = loadEstimator(assetsPath);
+
+        std::vector<std::vector<Eigen::Vector3f>> captures;
+        std::vector<Eigen::Vector3f> patchSigma;
+        for (size_t i = 0; i < inputPaths.size(); ++i)
+        {
+            captures.push_back(loadChartPatches(inputPaths[i], i < chartCfgs.size() ? &chartCfgs[i] : nullptr,
+                                                i == 0 ? &patchSigma : nullptr));
+        }
+
         // 5. Solve
         std::cout << "Running Jiang Estimator..." << std::endl;
-        css::jiang::JiangEstimator estimator(priors);
-        auto result = estimator.solve(rgbPatches);
+        Eigen::MatrixXf curves;
 
-        std::cout << "Optimization Complete:\n"
-                  << "  Estimated CCT: " << result.estimatedCct << " K\n"
-                  << "  RMS Error:     " << result.rmsError << "\n";
+        if (!familyName.empty())
+        {
+            css::illuminant::IlluminantLibrary library;
+            if (fs::is_regular_file(familyName))
+            {
+                std::string stem = fs::path(familyName).stem().string();
+                library.loadCsv(familyName, stem);
+                familyName = stem;
+            }
 
-        // 6. Save
-        css::spectral::SpectralSensitivity sens;
-        sens.cameraName = "Recovered";
-        // Convert result.css (33x3) to samples. Wavelengths are 400 + 10*i
-        for(int i=0; i < result.css.rows(); ++i)
+            auto result = estimator.solveFamily(captures[0], library.family(familyName), searchOpts);
+
+            std::cout << "Optimization Complete:\n"
+                      << "  Illuminant:    " << result.illuminantLabel << " (" << familyName << ")\n"
+                      << "  RMS Error:     " << result.rmsError << "\n";
+            curves = result.css;
+        }
+        else if (captures.size() == 1)
         {
-            css::spectral::SpectralSample s;
-            s.wavelengthNm = 400.0f + 10.0f * i;
-            s.rgbResponse = result.css.row(i);
-            sens.samples.push_back(s);
+            auto result = estimator.solve(captures[0], searchOpts);
+
+            std::cout << "Optimization Complete:\n"
+                      << "  Estimated CCT: " << result.estimatedCct << " K\n";
+            if (searchOpts.model == css::jiang::IlluminantModel::OffPlanckian)
+            {
+                std::cout << "  Estimated Duv: " << result.estimatedDuv << "\n";
+            }
+            std::cout << "  RMS Error:     " << result.rmsError << "\n";
+            if (searchOpts.regularization != css::tikhonov::LambdaSelection::Fixed || searchOpts.lambda > 0.0f)
+            {
+                std::cout << "  Lambda (RGB):  " << result.lambda.transpose() << "\n";
+            }
+            curves = result.css;
+
+            if (bootstrap)
+            {
+                std::cout << "Running " << bootOpts.resamples << " bootstrap resamples..." << std::endl;
+                css::jiang::JiangBatchSolver solver(estimator, searchOpts);
+                auto boot = solver.bootstrap(captures[0], patchSigma, bootOpts);
+
+                fs::path bandsPath = fs::path(outputPath);
+                bandsPath.replace_filename(bandsPath.stem().string() + "_bands.csv");
+                saveBands(bandsPath.string(), boot);
+                std::cout << "Saved bootstrap bands to " << bandsPath.string() << std::endl;
+            }
         }
-        
-        css::spectral::saveSpectralSensitivityCsv(outputPath, sens);
+        else
+        {
+            auto result = estimator.solveJoint(captures, searchOpts);
+
+            std::cout << "Joint Optimization Complete (" << result.iterations << " iterations):\n";
+            for (size_t i = 0; i < result.captures.size(); ++i)
+            {
+                const auto& c = result.captures[i];
+                std::cout << "  [" << i << "] " << inputPaths[i] << ": CCT " << c.estimatedCct << " K";
+                if (searchOpts.model == css::jiang::IlluminantModel::OffPlanckian)
+                {
+                    std::cout << ", Duv " << c.estimatedDuv;
+                }
+                std::cout << ", exposure " << c.exposure << ", RMS " << c.rmsError << "\n";
+            }
+            std::cout << "  RMS Error:     " << result.rmsError << "\n";
+            if (searchOpts.regularization != css::tikhonov::LambdaSelection::Fixed || searchOpts.lambda > 0.0f)
+            {
+                std::cout << "  Lambda (RGB):  " << result.lambda.transpose() << "\n";
+            }
+            curves = result.css;
+        }
+
+        // 6. Save
+        saveCss(outputPath, curves, estimator.priors().grid);
         std::cout << "Saved CSS to " << outputPath << std::endl;
 
         return 0;
     }
+
+    int runRecoverCssBatch(const std::vector<std::string>& args)
+    {
+        std::string listPath;
+        std::string outputDir;
+        std::string assetsPath = findPriorsFile();
+        css::jiang::SearchOptions searchOpts;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--list") listPath = next("--list");
+            else if (a == "--output-dir") outputDir = next("--output-dir");
+            else if (a == "--assets") assetsPath = next("--assets");
+            else if (a == "--off-planckian") searchOpts.model = css::jiang::IlluminantModel::OffPlanckian;
+            else if (a == "--lambda") parseLambda(next("--lambda"), searchOpts.regularization, searchOpts.lambda);
+        }
+
+        if (listPath.empty() || outputDir.empty())
+        {
+            throw std::runtime_error("recover-css-batch: missing --list or --output-dir");
+        }
+
+        // Each line: path,x0,y0,x1,y1,x2,y2,x3,y3 (corners are required, no picker in batch mode)
+        std::ifstream in(listPath);
+        if (!in)
+        {
+            throw std::runtime_error("Failed to open chart list: " + listPath);
+        }
+
+        std::vector<std::string> inputPaths;
+        std::vector<css::chart::ChartConfig> chartCfgs;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+
+            auto pos = line.find(',');
+            if (pos == std::string::npos)
+            {
+                throw std::runtime_error("recover-css-batch: expected path,x0,...,y3 in line: " + line);
+            }
+            inputPaths.push_back(line.substr(0, pos));
+            chartCfgs.push_back(parseCorners(line.substr(pos + 1)));
+        }
+
+        fs::create_directories(outputDir);
+
+        // 1. Load priors and factorize the per-illuminant systems once for the whole batch.
+        std::cout << "Loading priors from " << assetsPath << std::endl;
+        css::jiang::JiangBatchSolver solver(loadEstimator(assetsPath), searchOpts);
+
+        // 2. Load, sample and solve every chart in parallel.
+        std::cout << "Solving " << inputPaths.size() << " charts..." << std::endl;
+        std::vector<std::string> status(inputPaths.size());
+        css::parallel::parallelFor(inputPaths.size(), [&](size_t i) {
+            std::ostringstream msg;
+            try
+            {
+                cv::Mat img = css::io::loadDngAsLinearRgb(inputPaths[i]);
+                auto samples = css::chart::sampleChartPatches(img, chartCfgs[i]);
+
+                std::vector<Eigen::Vector3f> rgbPatches;
+                rgbPatches.reserve(samples.size());
+                for (const auto& s : samples)
+                {
+                    rgbPatches.emplace_back(s.meanBgr[0], s.meanBgr[1], s.meanBgr[2]);
+                }
+
+                auto result = solver.solve(rgbPatches);
+
+                std::string outPath = (fs::path(outputDir) / (fs::path(inputPaths[i]).stem().string() + "_css.csv")).string();
+                saveCss(outPath, result.css, result.grid);
+
+                msg << inputPaths[i] << ": CCT " << result.estimatedCct << " K";
+                if (searchOpts.model == css::jiang::IlluminantModel::OffPlanckian)
+                {
+                    msg << ", Duv " << result.estimatedDuv;
+                }
+                msg << ", RMS " << result.rmsError << " -> " << outPath;
+            }
+            catch (const std::exception& e)
+            {
+                msg << inputPaths[i] << ": FAILED (" << e.what() << ")";
+            }
+            status[i] = msg.str();
+        });
+
+        int failures = 0;
+        for (const auto& s : status)
+        {
+            std::cout << "  " << s << "\n";
+            failures += s.find(": FAILED") != std::string::npos ? 1 : 0;
+        }
+        std::cout << "Batch complete: " << (inputPaths.size() - failures) << "/" << inputPaths.size()
+                  << " charts recovered." << std::endl;
+
+        return failures == 0 ? 0 : 1;
+    }
+
+    // CSS CSV as a (count x 3) matrix on its own (uniform) sampling.
+    Eigen::MatrixXf loadCssMatrix(const std::string& path, css::spectral::SpectralGrid& grid)
+    {
+        auto sens = css::spectral::loadSpectralSensitivityCsv(path);
+        const float first = sens.samples.front().wavelengthNm;
+        const float last = sens.samples.back().wavelengthNm;
+        grid = css::spectral::SpectralGrid::range(
+            first, last, sens.samples.size() > 1 ? (last - first) / static_cast<float>(sens.samples.size() - 1) : 1.0f);
+        return css::spectral::toMatrix(sens, grid);
+    }
+
+    // --family blackbody|daylight|cie|spds.csv, else --illuminants D65,A,3200K,...
+    Eigen::MatrixXf selectIlluminants(const css::spectral::SpectralGrid& grid,
+                                      const std::string& illuminantList,
+                                      std::string familyName,
+                                      std::vector<std::string>& labels)
+    {
+        css::illuminant::IlluminantLibrary library(grid);
+        labels.clear();
+        if (!familyName.empty())
+        {
+            if (fs::is_regular_file(familyName))
+            {
+                std::string stem = fs::path(familyName).stem().string();
+                library.loadCsv(familyName, stem);
+                familyName = stem;
+            }
+            const auto& set = library.family(familyName);
+            labels = set.labels;
+            return set.spectra;
+        }
+
+        std::stringstream ss(illuminantList);
+        std::string label;
+        while (std::getline(ss, label, ','))
+        {
+            labels.push_back(label);
+        }
+        Eigen::MatrixXf spds(grid.count, static_cast<Eigen::Index>(labels.size()));
+        for (size_t l = 0; l < labels.size(); ++l)
+        {
+            spds.col(static_cast<Eigen::Index>(l)) = library.spectrum(labels[l]);
+        }
+        return spds;
+    }
+
+    int runPriorsCompile(const std::vector<std::string>& args)
+    {
+        std::string inputPath = findDataFile("assets.yaml");
+        std::string outputPath;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--input") inputPath = next("--input");
+            else if (a == "--output") outputPath = next("--output");
+        }
+
+        if (outputPath.empty())
+        {
+            outputPath = (fs::path(inputPath).parent_path() / (fs::path(inputPath).stem().string() + ".cspri")).string();
+        }
+
+        std::cout << "Compiling priors " << inputPath << " -> " << outputPath << std::endl;
+        auto priors = css::priors::loadPriorsFromYaml(inputPath);
+        css::priors::savePriorsBinary(outputPath, priors);
+
+        // Read back through the mapped loader so a bad file never ships.
+        css::priors::MappedPriors check(outputPath);
+        std::cout << "  Grid:        " << check.grid().start << "-" << check.grid().end() << "nm @ "
+                  << check.grid().step << "nm (" << check.grid().count << " bands)\n"
+                  << "  Components:  " << check.basisR().cols() << "/" << check.basisG().cols() << "/"
+                  << check.basisB().cols() << "\n"
+                  << "  Patches:     " << check.reflectance().cols() << "\n"
+                  << "  Hash:        " << std::hex << check.contentHash() << std::dec << std::endl;
+        return 0;
+    }
+
+    int runBuildPriors(const std::vector<std::string>& args)
+    {
+        std::string cssDir = findDataFile("camSpecSensitivity");
+        std::string cssDbPath;
+        std::string datasetName;
+        std::string outputPath;
+        std::string templatePath = findPriorsFile();
+        std::string reflectancePath;
+        float scale = 1.0f;
+        css::spectral::SpectralGrid grid;
+        bool gridSet = false;
+        css::priors::BuildOptions options;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--css-dir") cssDir = next("--css-dir");
+            else if (a == "--css-db") cssDbPath = next("--css-db");
+            else if (a == "--dataset") datasetName = next("--dataset");
+            else if (a == "--output") outputPath = next("--output");
+            else if (a == "--template") templatePath = next("--template");
+            else if (a == "--reflectances") reflectancePath = next("--reflectances");
+            else if (a == "--percent") scale = 0.01f;
+            else if (a == "--components") options.basis.components = std::stoi(next("--components"));
+            else if (a == "--raw-scale") options.normalize = false;
+            else if (a == "--grid")
+            {
+                // first,last,step in nm
+                std::vector<float> g;
+                std::string token;
+                std::stringstream ss(next("--grid"));
+                while (std::getline(ss, token, ',')) g.push_back(std::stof(token));
+                if (g.size() != 3 || !(g[2] > 0.0f)) throw std::runtime_error("Expected --grid first,last,step");
+                grid = css::spectral::SpectralGrid::range(g[0], g[1], g[2]);
+                gridSet = true;
+            }
+            else if (a == "--svd")
+            {
+                std::string m = next("--svd");
+                if (m == "auto") options.basis.method = css::pca::SvdMethod::Auto;
+                else if (m == "exact") options.basis.method = css::pca::SvdMethod::Exact;
+                else if (m == "randomized") options.basis.method = css::pca::SvdMethod::Randomized;
+                else throw std::runtime_error("--svd must be auto, exact or randomized");
+            }
+        }
+
+        if (outputPath.empty())
+        {
+            throw std::runtime_error("build-priors: missing --output");
+        }
+
+        // 1. Sensitivities, R G B per camera side by side on the grid: a database
+        //    dataset read in place, or a directory of CSVs loaded in parallel.
+        std::unique_ptr<css::spectral::SpectralDatabase> db;
+        Eigen::MatrixXf loaded;
+        const float* packedData = nullptr;
+        Eigen::Index packedCols = 0;
+        if (!cssDbPath.empty())
+        {
+            std::cout << "Reading sensitivities from " << cssDbPath << std::endl;
+            db = std::make_unique<css::spectral::SpectralDatabase>(cssDbPath);
+            auto view = datasetName.empty() ? db->first(css::spectral::DatasetKind::Sensitivity)
+                                            : db->dataset(datasetName);
+            if (view.channels() != 3)
+            {
+                throw std::runtime_error("build-priors: dataset " + view.name() + " is not a sensitivity set");
+            }
+            if (!gridSet)
+            {
+                grid = view.grid();
+            }
+            if (view.grid() == grid)
+            {
+                packedData = view.matrix().data();
+                packedCols = view.matrix().cols();
+            }
+            else
+            {
+                loaded = css::spectral::resample(view.matrix(), view.grid(), grid);
+            }
+        }
+        else
+        {
+            std::cout << "Loading sensitivities from " << cssDir << std::endl;
+            std::vector<std::string> skipped;
+            auto curves = css::spectral::loadSensitivityDirectory(cssDir, grid, nullptr, &skipped);
+            for (const auto& s : skipped)
+            {
+                std::cout << "  Skipped " << s << "\n";
+            }
+            loaded.resize(grid.count, 3 * static_cast<Eigen::Index>(curves.size()));
+            for (size_t j = 0; j < curves.size(); ++j)
+            {
+                loaded.middleCols(3 * static_cast<Eigen::Index>(j), 3) = curves[j];
+            }
+        }
+        if (!packedData)
+        {
+            packedData = loaded.data();
+            packedCols = loaded.cols();
+        }
+        Eigen::Map<const Eigen::MatrixXf> packed(packedData, grid.count, packedCols);
+        std::cout << "  " << packed.cols() / 3 << " cameras on " << grid.start << "-" << grid.end()
+                  << "nm @ " << grid.step << "nm" << std::endl;
+
+        // 2. Chart reflectances: a reflectance CSV, or those of an existing priors file.
+        Eigen::MatrixXf reflectance;
+        if (!reflectancePath.empty())
+        {
+            reflectance = css::render::loadReflectanceCsv(reflectancePath, grid, nullptr, scale);
+        }
+        else
+        {
+            auto base = css::priors::loadPriors(templatePath);
+            reflectance = css::spectral::resample(base.reflectance, base.grid, grid);
+        }
+
+        // 3. Per-channel PCA and output.
+        Eigen::Vector3f explained;
+        auto priors = css::priors::buildPriors(packed, reflectance, grid, options, &explained);
+        css::priors::savePriors(outputPath, priors);
+
+        std::cout << "Wrote " << outputPath << " (" << options.basis.components << " components/channel)\n"
+                  << "  Energy kept (RGB): " << explained.transpose() << std::endl;
+        return 0;
+    }
+
+    int runDbPack(const std::vector<std::string>& args)
+    {
+        std::string outputPath;
+        css::spectral::SpectralGrid grid;
+        float scale = 1.0f;
+        std::vector<std::pair<css::spectral::DatasetKind, std::string>> sources;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--output") outputPath = next("--output");
+            else if (a == "--percent") scale = 0.01f;
+            else if (a == "--sensitivities") sources.emplace_back(css::spectral::DatasetKind::Sensitivity, next("--sensitivities"));
+            else if (a == "--reflectances") sources.emplace_back(css::spectral::DatasetKind::Reflectance, next("--reflectances"));
+            else if (a == "--illuminants") sources.emplace_back(css::spectral::DatasetKind::Illuminant, next("--illuminants"));
+            else if (a == "--grid")
+            {
+                std::vector<float> g;
+                std::string token;
+                std::stringstream ss(next("--grid"));
+                while (std::getline(ss, token, ',')) g.push_back(std::stof(token));
+                if (g.size() != 3 || !(g[2] > 0.0f)) throw std::runtime_error("Expected --grid first,last,step");
+                grid = css::spectral::SpectralGrid::range(g[0], g[1], g[2]);
+            }
+        }
+
+        if (outputPath.empty() || sources.empty())
+        {
+            throw std::runtime_error("db-pack: missing --output or any --sensitivities/--reflectances/--illuminants");
+        }
+
+        // One dataset per source, named after the directory / file stem.
+        std::vector<css::spectral::Dataset> datasets;
+        for (const auto& [kind, path] : sources)
+        {
+            css::spectral::Dataset ds;
+            ds.name = fs::path(path).filename().replace_extension().string();
+            ds.kind = kind;
+            ds.grid = grid;
+
+            if (kind == css::spectral::DatasetKind::Sensitivity)
+            {
+                std::vector<std::string> skipped;
+                auto curves = css::spectral::loadSensitivityDirectory(path, grid, &ds.items, &skipped);
+                for (const auto& s : skipped)
+                {
+                    std::cout << "  Skipped " << s << "\n";
+                }
+                ds.channels = 3;
+                ds.data.resize(grid.count, 3 * static_cast<Eigen::Index>(curves.size()));
+                for (size_t j = 0; j < curves.size(); ++j)
+                {
+                    ds.data.middleCols(3 * static_cast<Eigen::Index>(j), 3) = curves[j];
+                }
+            }
+            else if (kind == css::spectral::DatasetKind::Reflectance)
+            {
+                ds.data = css::render::loadReflectanceCsv(path, grid, &ds.items, scale);
+            }
+            else
+            {
+                auto set = css::illuminant::loadIlluminantCsv(path, ds.name, grid);
+                ds.items = set.labels;
+                ds.data = set.spectra;
+            }
+
+            std::cout << "  " << ds.name << ": " << ds.items.size() << " items" << std::endl;
+            datasets.push_back(std::move(ds));
+        }
+
+        css::spectral::saveSpectralDatabase(outputPath, datasets);
+        std::cout << "Wrote " << outputPath << " (" << datasets.size() << " datasets)" << std::endl;
+        return 0;
+    }
+
+    int runDbInfo(const std::vector<std::string>& args)
+    {
+        if (args.size() < 2 || args[0] != "--db")
+        {
+            throw std::runtime_error("db-info: expected --db file.csdb");
+        }
+
+        css::spectral::SpectralDatabase db(args[1], true);
+        const char* kinds[] = {"generic", "sensitivity", "reflectance", "illuminant"};
+        std::cout << args[1] << ": " << db.size() << " datasets, hash " << std::hex << db.contentHash() << std::dec << "\n";
+        for (size_t d = 0; d < db.size(); ++d)
+        {
+            auto view = db.dataset(d);
+            auto kind = static_cast<size_t>(view.kind());
+            std::cout << "  " << view.name() << " [" << (kind < 4 ? kinds[kind] : "?") << "] "
+                      << view.size() << " items, " << view.grid().start << "-" << view.grid().end()
+                      << "nm @ " << view.grid().step << "nm\n";
+        }
+        return 0;
+    }
+
+    int runRender(const std::vector<std::string>& args)
+    {
+        std::string cssPath;
+        std::string reflectancePath;
+        std::string outputPath;
+        std::string dbPath;
+        std::string cameraName;
+        std::string reflectanceSet;
+        std::string illuminantList = "D65";
+        std::string familyName;
+        bool normalize = false;
+        float scale = 1.0f;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--css") cssPath = next("--css");
+            else if (a == "--reflectances") reflectancePath = next("--reflectances");
+            else if (a == "--output") outputPath = next("--output");
+            else if (a == "--db") dbPath = next("--db");
+            else if (a == "--camera") cameraName = next("--camera");
+            else if (a == "--reflectance-set") reflectanceSet = next("--reflectance-set");
+            else if (a == "--illuminants") illuminantList = next("--illuminants");
+            else if (a == "--family") familyName = next("--family");
+            else if (a == "--normalize") normalize = true;
+            else if (a == "--percent") scale = 0.01f;
+        }
+
+        std::unique_ptr<css::spectral::SpectralDatabase> db;
+        if (!dbPath.empty())
+        {
+            db = std::make_unique<css::spectral::SpectralDatabase>(dbPath);
+        }
+        const bool cssFromDb = db && !cameraName.empty();
+        const bool reflFromDb = db && !reflectanceSet.empty();
+        if ((cssPath.empty() && !cssFromDb) || (reflectancePath.empty() && !reflFromDb) || outputPath.empty())
+        {
+            throw std::runtime_error("render: missing --css (or --db --camera), --reflectances (or --db --reflectance-set) or --output");
+        }
+
+        // 1. Render on the CSS's own sampling; reflectances and SPDs are resampled to it.
+        css::spectral::SpectralGrid grid;
+        Eigen::MatrixXf cssMatrix = cssFromDb ? Eigen::MatrixXf(db->camera(cameraName, &grid))
+                                              : loadCssMatrix(cssPath, grid);
+
+        // 2. Illuminants: a whole family, or a list of member labels.
+        std::vector<std::string> labels;
+        Eigen::MatrixXf spds = selectIlluminants(grid, illuminantList, familyName, labels);
+
+        css::render::SpectralRenderer renderer(cssMatrix, spds, grid, normalize);
+
+        // 3. Stream the reflectance database through the renderer.
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            throw std::runtime_error("Failed to open output for writing: " + outputPath);
+        }
+        out << "name,illuminant,R,G,B\n";
+
+        auto writeBlock = [&](const Eigen::MatrixXf& rgb, const auto& nameAt) {
+            for (Eigen::Index j = 0; j < rgb.cols(); ++j)
+            {
+                for (size_t l = 0; l < labels.size(); ++l)
+                {
+                    auto px = rgb.col(j).segment<3>(3 * static_cast<Eigen::Index>(l));
+                    out << nameAt(j) << "," << labels[l] << ","
+                        << px[0] << "," << px[1] << "," << px[2] << "\n";
+                }
+            }
+        };
+
+        size_t count = 0;
+        if (reflFromDb)
+        {
+            // Database spectra are rendered straight from the mapping, block by block;
+            // only a grid mismatch goes through a resampling buffer.
+            auto view = db->dataset(reflectanceSet);
+            if (view.channels() != 1)
+            {
+                throw std::runtime_error("render: dataset " + view.name() + " does not hold one spectrum per item");
+            }
+            std::cout << "Rendering " << view.name() << " (" << view.size() << " spectra) under "
+                      << labels.size() << " illuminant(s)..." << std::endl;
+            auto all = view.matrix();
+            css::spectral::Resampler resampler(view.grid(), grid);
+            const bool direct = view.grid() == grid;
+            const Eigen::Index block = 8192;
+            Eigen::MatrixXf spectra;
+            Eigen::MatrixXf rgb;
+            for (Eigen::Index c0 = 0; c0 < all.cols(); c0 += block)
+            {
+                const Eigen::Index cols = std::min(block, all.cols() - c0);
+                rgb.resize(renderer.weights().rows(), cols);
+                if (direct)
+                {
+                    renderer.render(all.middleCols(c0, cols), rgb);
+                }
+                else
+                {
+                    spectra.resize(grid.count, cols);
+                    resampler.apply(all.middleCols(c0, cols), spectra);
+                    renderer.render(spectra, rgb);
+                }
+                writeBlock(rgb, [&](Eigen::Index j) { return view.itemName(c0 + j); });
+                count += static_cast<size_t>(cols);
+            }
+        }
+        else
+        {
+            std::cout << "Rendering " << reflectancePath << " under " << labels.size() << " illuminant(s)..." << std::endl;
+            css::render::ReflectanceReader reader(reflectancePath, grid, scale);
+            count = css::render::renderStream(reader, renderer,
+                [&](const std::vector<std::string>& names, const Eigen::MatrixXf& rgb) {
+                    writeBlock(rgb, [&](Eigen::Index j) { return names[static_cast<size_t>(j)]; });
+                });
+        }
+
+        std::cout << "Rendered " << count << " spectra x " << labels.size()
+                  << " illuminant(s) to " << outputPath << std::endl;
+        return 0;
+    }
+
+    int runSynthesizeProfile(const std::vector<std::string>& args)
+    {
+        std::string cssPath;
+        std::string profileOutPath;
+        std::string outputDir;
+        std::string reflectancePath;
+        std::string assetsPath = findPriorsFile();
+        std::string illuminantList = "D65";
+        std::string familyName;
+        float scale = 1.0f;
+        css::pipeline::SynthesisConfig cfg;
+
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            const auto& a = args[i];
+            auto next = [&](const char* opt) -> std::string {
+                if (i + 1 >= args.size()) throw std::runtime_error(std::string("Missing value for ") + opt);
+                return args[++i];
+            };
+
+            if (a == "--css") cssPath = next("--css");
+            else if (a == "--profile-out") profileOutPath = next("--profile-out");
+            else if (a == "--output-dir") outputDir = next("--output-dir");
+            else if (a == "--reflectances") reflectancePath = next("--reflectances");
+            else if (a == "--percent") scale = 0.01f;
+            else if (a == "--assets") assetsPath = next("--assets");
+            else if (a == "--illuminants") illuminantList = next("--illuminants");
+            else if (a == "--family") familyName = next("--family");
+            else if (a == "--reference") cfg.referenceIlluminant = next("--reference");
+            else if (a == "--camera-name") cfg.cameraName = next("--camera-name");
+            else if (a == "--lambda") parseLambda(next("--lambda"), cfg.regularization, cfg.lambda);
+            else if (a == "--model") cfg.model = css::profile::parseModel(next("--model"));
+        }
+
+        if (cssPath.empty() || (profileOutPath.empty() && outputDir.empty()))
+        {
+            throw std::runtime_error("synthesize-profile: missing --css or --profile-out / --output-dir");
+        }
+
+        css::spectral::SpectralGrid grid;
+        Eigen::MatrixXf cssMatrix = loadCssMatrix(cssPath, grid);
+
+        std::vector<std::string> labels;
+        Eigen::MatrixXf spds = selectIlluminants(grid, illuminantList, familyName, labels);
+        if (labels.size() > 1 && outputDir.empty())
+        {
+            throw std::runtime_error("synthesize-profile: several illuminants need --output-dir");
+        }
+
+        // Training spectra: a reflectance database, or the chart reflectances from the priors.
+        Eigen::MatrixXf reflectances;
+        if (!reflectancePath.empty())
+        {
+            reflectances = css::render::loadReflectanceCsv(reflectancePath, grid, nullptr, scale);
+        }
+        else
+        {
+            auto priors = css::priors::loadPriors(assetsPath);
+            reflectances = css::spectral::resample(priors.reflectance, priors.grid, grid);
+        }
+
+        std::cout << "Synthesizing " << labels.size() << " profile(s) from "
+                  << reflectances.cols() << " training spectra..." << std::endl;
+        auto profiles = css::pipeline::synthesizeProfiles(cssMatrix, spds, labels, reflectances, grid, cfg);
+
+        if (!outputDir.empty())
+        {
+            fs::create_directories(outputDir);
+        }
+        for (const auto& prof : profiles)
+        {
+            std::string path = outputDir.empty()
+                                   ? profileOutPath
+                                   : (fs::path(outputDir) / (cfg.cameraName + "_" + prof.illuminant + ".txt")).string();
+            if (!css::profile::saveProfile(path, prof))
+            {
+                throw std::runtime_error("Failed to save profile to " + path);
+            }
+            std::cout << "  " << prof.illuminant << " -> " << path << "\n";
+        }
+
+        return 0;
+    }
 } // namespace
 
 int main(int argc, char** argv)
@@ -365,11 +1422,51 @@ int main(int argc, char** argv)
             std::cout << "Running apply command..." << std::endl;
             return runApply(args);
         }
+        if (cmd == "bake-lut")
+        {
+            std::cout << "Running bake-lut command..." << std::endl;
+            return runBakeLut(args);
+        }
         if (cmd == "recover-css")
         {
             std::cout << "Running recover-css command..." << std::endl;
             return runRecoverCss(args);
         }
+        if (cmd == "recover-css-batch")
+        {
+            std::cout << "Running recover-css-batch command..." << std::endl;
+            return runRecoverCssBatch(args);
+        }
+        if (cmd == "db-pack")
+        {
+            std::cout << "Running db-pack command..." << std::endl;
+            return runDbPack(args);
+        }
+        if (cmd == "db-info")
+        {
+            std::cout << "Running db-info command..." << std::endl;
+            return runDbInfo(args);
+        }
+        if (cmd == "build-priors")
+        {
+            std::cout << "Running build-priors command..." << std::endl;
+            return runBuildPriors(args);
+        }
+        if (cmd == "priors-compile")
+        {
+            std::cout << "Running priors-compile command..." << std::endl;
+            return runPriorsCompile(args);
+        }
+        if (cmd == "synthesize-profile")
+        {
+            std::cout << "Running synthesize-profile command..." << std::endl;
+            return runSynthesizeProfile(args);
+        }
+        if (cmd == "render")
+        {
+            std::cout << "Running render command..." << std::endl;
+            return runRender(args);
+        }
 
         std::cout << "Unknown command: " << cmd << std::endl;
         printUsage();
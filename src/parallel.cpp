@@ -0,0 +1,162 @@
+#include "css/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace css::parallel
+{
+    namespace
+    {
+        thread_local bool t_inWorker = false;
+    } // namespace
+
+    ThreadPool::ThreadPool(unsigned threads)
+    {
+        if (threads == 0)
+        {
+            unsigned hw = std::thread::hardware_concurrency();
+            threads = hw > 1 ? hw - 1 : 0;
+        }
+
+        m_workers.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& t : m_workers)
+        {
+            t.join();
+        }
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        t_inWorker = true;
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_stop && m_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count,
+                                 const std::function<void(size_t)>& fn,
+                                 unsigned maxThreads)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        unsigned participants = concurrency();
+        if (maxThreads > 0)
+        {
+            participants = std::min(participants, maxThreads);
+        }
+        participants = static_cast<unsigned>(std::min<size_t>(participants, count));
+
+        if (participants <= 1 || t_inWorker)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        struct Shared
+        {
+            std::atomic<size_t> next{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+            unsigned pending = 0;
+        };
+        auto shared = std::make_shared<Shared>();
+        shared->pending = participants - 1;
+
+        auto drain = [shared, count, &fn] {
+            for (;;)
+            {
+                size_t i = shared->next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count || shared->failed.load(std::memory_order_relaxed))
+                {
+                    break;
+                }
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    if (!shared->error)
+                    {
+                        shared->error = std::current_exception();
+                    }
+                    shared->failed = true;
+                }
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (unsigned t = 0; t + 1 < participants; ++t)
+            {
+                m_tasks.emplace_back([shared, drain] {
+                    drain();
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    if (--shared->pending == 0)
+                    {
+                        shared->done.notify_one();
+                    }
+                });
+            }
+        }
+        m_cv.notify_all();
+
+        drain();
+
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->done.wait(lock, [&] { return shared->pending == 0; });
+        if (shared->error)
+        {
+            std::rethrow_exception(shared->error);
+        }
+    }
+
+    ThreadPool& sharedPool()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void parallelFor(size_t count,
+                     const std::function<void(size_t)>& fn,
+                     unsigned maxThreads)
+    {
+        sharedPool().parallelFor(count, fn, maxThreads);
+    }
+} // namespace css::parallel
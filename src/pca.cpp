@@ -0,0 +1,97 @@
+#include "css/pca.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+namespace css::pca
+{
+    namespace
+    {
+        // Below this many rows or columns a thin SVD of the data is cheap enough.
+        constexpr Eigen::Index kExactLimit = 256;
+
+        Eigen::MatrixXf orthonormalize(const Eigen::MatrixXf& Y)
+        {
+            Eigen::HouseholderQR<Eigen::MatrixXf> qr(Y);
+            return qr.householderQ() * Eigen::MatrixXf::Identity(Y.rows(), Y.cols());
+        }
+
+        // Halko, Martinsson & Tropp (2011), Algorithms 4.4 and 5.1.
+        void randomizedSvd(const Eigen::MatrixXf& data, const BasisOptions& options,
+                           Eigen::MatrixXf& U, Eigen::VectorXf& s)
+        {
+            const Eigen::Index sketch = std::min<Eigen::Index>(
+                options.components + std::max(options.oversampling, 0), std::min(data.rows(), data.cols()));
+
+            std::mt19937_64 rng(options.seed);
+            std::normal_distribution<float> gauss(0.0f, 1.0f);
+            Eigen::MatrixXf omega(data.cols(), sketch);
+            for (Eigen::Index j = 0; j < omega.cols(); ++j)
+            {
+                for (Eigen::Index i = 0; i < omega.rows(); ++i)
+                {
+                    omega(i, j) = gauss(rng);
+                }
+            }
+
+            Eigen::MatrixXf Q = orthonormalize(data * omega);
+            for (int it = 0; it < options.powerIterations; ++it)
+            {
+                Q = orthonormalize(data.transpose() * Q);
+                Q = orthonormalize(data * Q);
+            }
+
+            // Small (sketch x cols) problem carries the spectrum of the range.
+            Eigen::MatrixXf B = Q.transpose() * data;
+            Eigen::BDCSVD<Eigen::MatrixXf> svd(B, Eigen::ComputeThinU);
+            U = Q * svd.matrixU();
+            s = svd.singularValues();
+        }
+    } // namespace
+
+    Basis principalBasis(const Eigen::MatrixXf& data, const BasisOptions& options)
+    {
+        const Eigen::Index k = options.components;
+        if (k <= 0 || k > std::min(data.rows(), data.cols()))
+        {
+            throw std::runtime_error("principalBasis: components must be in [1, min(rows, cols)]");
+        }
+
+        SvdMethod method = options.method;
+        if (method == SvdMethod::Auto)
+        {
+            method = std::min(data.rows(), data.cols()) <= kExactLimit ? SvdMethod::Exact : SvdMethod::Randomized;
+        }
+
+        Eigen::MatrixXf U;
+        Eigen::VectorXf s;
+        if (method == SvdMethod::Exact)
+        {
+            Eigen::BDCSVD<Eigen::MatrixXf> svd(data, Eigen::ComputeThinU);
+            U = svd.matrixU();
+            s = svd.singularValues();
+        }
+        else
+        {
+            randomizedSvd(data, options, U, s);
+        }
+
+        Basis basis;
+        basis.vectors = U.leftCols(k);
+        basis.singularValues = s.head(k);
+
+        for (Eigen::Index c = 0; c < k; ++c)
+        {
+            if (basis.vectors.col(c).sum() < 0.0f)
+            {
+                basis.vectors.col(c) = -basis.vectors.col(c);
+            }
+        }
+
+        const float total = data.squaredNorm();
+        basis.explainedEnergy = total > 0.0f ? basis.singularValues.squaredNorm() / total : 0.0f;
+        return basis;
+    }
+} // namespace css::pca
@@ -2,14 +2,46 @@
 
 #include "css/calib.hpp"
 #include "css/chart.hpp"
+#include "css/color_kernel.hpp"
+#include "css/colorimetry.hpp"
+#include "css/demosaic.hpp"
+#include "css/illuminant.hpp"
+#include "css/lut3d.hpp"
+#include "css/parallel.hpp"
 #include "css/profile.hpp"
 #include "css/refdata.hpp"
+#include "css/render.hpp"
+#include "css/tiff_writer.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
+#include <vector>
+#include <opencv2/imgproc.hpp>
 
 namespace css::pipeline
 {
+    namespace
+    {
+        // Run rowFn(y) over `rows` rows in tiles of about options.tileBytes on the shared pool.
+        template <class RowFn>
+        void forEachRowTile(int rows, size_t rowBytes, const ApplyOptions& options, RowFn rowFn)
+        {
+            const int tileRows = static_cast<int>(std::clamp<size_t>(options.tileBytes / rowBytes, 1, static_cast<size_t>(rows)));
+            const size_t tiles = static_cast<size_t>((rows + tileRows - 1) / tileRows);
+
+            parallel::parallelFor(tiles, [&](size_t t) {
+                const int y0 = static_cast<int>(t) * tileRows;
+                const int y1 = std::min(y0 + tileRows, rows);
+                for (int y = y0; y < y1; ++y)
+                {
+                    rowFn(y);
+                }
+            }, options.threads);
+        }
+    } // namespace
+
     profile::Profile calibrateFromChart(const cv::Mat& chartImage,
                                         const CalibrateConfig& cfg)
     {
@@ -27,9 +59,26 @@ namespace css::pipeline
                                      std::to_string(samples.size()));
         }
 
-        auto refs = refdata::loadColorChecker24Csv(cfg.refDataCsvPath,
-                                                   cfg.illuminant,
-                                                   "linear_srgb");
+        refdata::RefSet refs;
+        if (!cfg.refDataCsvPath.empty())
+        {
+            refs = refdata::loadColorChecker24Csv(cfg.refDataCsvPath, cfg.illuminant, "linear_srgb");
+        }
+        else if (cfg.spectralReference || cfg.illuminant != "D65")
+        {
+            if (cfg.chartReflectance.size() == 0)
+            {
+                throw std::runtime_error("calibrateFromChart: illuminant " + cfg.illuminant +
+                                         " needs chart reflectances or a reference CSV");
+            }
+            refs = *refdata::cachedReference("ColorChecker24", cfg.chartReflectance, cfg.chartGrid,
+                                             cfg.illuminant, "linear_srgb", cfg.adaptation,
+                                             cfg.illuminants.get());
+        }
+        else
+        {
+            refs = refdata::defaultColorChecker24(cfg.illuminant, "linear_srgb");
+        }
 
         // Map by index.
         std::vector<Eigen::Vector3f> measured;
@@ -51,12 +100,14 @@ namespace css::pipeline
             reference.push_back(ref.linearSrgb);
         }
 
-        if (measured.size() < 6)
+        if (measured.size() < static_cast<size_t>(std::max(6, profile::termCount(cfg.model))))
         {
             throw std::runtime_error("Too few matching patches for calibration");
         }
 
-        auto calibRes = calib::solveColorMatrix(measured, reference, true, 1e-4f);
+        auto calibRes = cfg.regularization == tikhonov::LambdaSelection::Fixed
+                            ? calib::solveColorMatrix(measured, reference, true, cfg.lambda, cfg.model)
+                            : calib::solveColorMatrix(measured, reference, true, cfg.regularization, cfg.model);
 
         profile::Profile prof;
         prof.cameraName = cfg.cameraName;
@@ -65,59 +116,300 @@ namespace css::pipeline
         prof.targetColorSpace = "linear_srgb";
         prof.colorMatrix = calibRes.colorMatrix;
         prof.whiteBalance = calibRes.whiteBalance;
+        prof.model = calibRes.model;
+        prof.rootMatrix = calibRes.rootMatrix;
 
         return prof;
     }
 
-    namespace
+    std::vector<profile::Profile> synthesizeProfiles(const Eigen::MatrixXf& css,
+                                                     const Eigen::MatrixXf& illuminants,
+                                                     const std::vector<std::string>& labels,
+                                                     const Eigen::MatrixXf& reflectances,
+                                                     const spectral::SpectralGrid& grid,
+                                                     const SynthesisConfig& cfg)
     {
-        float srgbEncode(float v)
+        if (static_cast<Eigen::Index>(labels.size()) != illuminants.cols())
         {
-            v = std::clamp(v, 0.0f, 1.0f);
-            if (v <= 0.0031308f)
+            throw std::runtime_error("synthesizeProfiles: one label per illuminant required");
+        }
+        if (reflectances.rows() != grid.count ||
+            reflectances.cols() < std::max(6, profile::termCount(cfg.model)))
+        {
+            throw std::runtime_error("synthesizeProfiles: need at least 6 training reflectances on the grid, "
+                                     "and no fewer than the model has terms");
+        }
+
+        // Reference: linear sRGB of each training spectrum, white at Y = 1.
+        illuminant::IlluminantLibrary library(grid);
+        render::SpectralRenderer observer(colorimetry::cie1931(grid),
+                                          library.spectrum(cfg.referenceIlluminant), grid, true);
+        Eigen::MatrixXf target = colorimetry::xyzToLinearSrgb() * observer.render(reflectances);
+
+        // Camera: all illuminants in one pass, exposure-normalized (white G = 1).
+        render::SpectralRenderer camera(css, illuminants, grid, true);
+        Eigen::MatrixXf rgb = camera.render(reflectances);
+        Eigen::MatrixXf white = camera.render(Eigen::MatrixXf::Ones(grid.count, 1));
+
+        const Eigen::Index n = reflectances.cols();
+        std::vector<Eigen::Vector3f> reference(static_cast<size_t>(n));
+        for (Eigen::Index j = 0; j < n; ++j)
+        {
+            reference[static_cast<size_t>(j)] = target.col(j);
+        }
+
+        std::vector<profile::Profile> profiles(labels.size());
+        parallel::parallelFor(labels.size(), [&](size_t l) {
+            const Eigen::Index row = 3 * static_cast<Eigen::Index>(l);
+            Eigen::Vector3f w = white.block<3, 1>(row, 0);
+            if (!(w.minCoeff() > 0.0f))
             {
-                return 12.92f * v;
+                throw std::runtime_error("synthesizeProfiles: no camera response to white under " + labels[l]);
             }
-            return 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+            Eigen::Vector3f wb = w.cwiseInverse() * w.y();
+
+            std::vector<Eigen::Vector3f> measured(static_cast<size_t>(n));
+            for (Eigen::Index j = 0; j < n; ++j)
+            {
+                measured[static_cast<size_t>(j)] = rgb.block<3, 1>(row, j).cwiseProduct(wb);
+            }
+
+            auto calibRes = cfg.regularization == tikhonov::LambdaSelection::Fixed
+                                ? calib::solveColorMatrix(measured, reference, false, cfg.lambda, cfg.model)
+                                : calib::solveColorMatrix(measured, reference, false, cfg.regularization,
+                                                          cfg.model);
+
+            profile::Profile& prof = profiles[l];
+            prof.cameraName = cfg.cameraName;
+            prof.illuminant = labels[l];
+            prof.chartType = "synthetic:" + std::to_string(n);
+            prof.targetColorSpace = "linear_srgb";
+            prof.colorMatrix = calibRes.colorMatrix;
+            prof.whiteBalance = wb;
+            prof.model = calibRes.model;
+            prof.rootMatrix = calibRes.rootMatrix;
+        });
+
+        return profiles;
+    }
+
+    cv::Mat applyProfile(const cv::Mat& linearBgr,
+                         const profile::Profile& prof,
+                         const ApplyOptions& options)
+    {
+        CV_Assert(linearBgr.type() == CV_32FC3);
+        CV_Assert(options.depth == CV_32F || options.depth == CV_16U || options.depth == CV_8U);
+
+        cv::Mat out(linearBgr.size(), CV_MAKETYPE(options.depth, 3));
+        if (linearBgr.empty())
+        {
+            return out;
         }
-    } // namespace
+
+        // White balance folded into the matrix, in BGR order: no per-pixel swaps.
+        const kernel::ColorTransform transform = kernel::makeTransform(prof, options.transfer);
+        const kernel::Isa isa = kernel::detectIsa();
+
+        const size_t cols = static_cast<size_t>(linearBgr.cols);
+        forEachRowTile(linearBgr.rows, cols * 3 * sizeof(float) + cols * out.elemSize(), options, [&](int y) {
+            const float* src = linearBgr.ptr<float>(y);
+            if (options.depth == CV_16U)
+                kernel::applyRow(transform, src, out.ptr<std::uint16_t>(y), cols, isa);
+            else if (options.depth == CV_8U)
+                kernel::applyRow(transform, src, out.ptr<std::uint8_t>(y), cols, isa);
+            else
+                kernel::applyRow(transform, src, out.ptr<float>(y), cols, isa);
+        });
+
+        return out;
+    }
+
+    cv::Mat applyProfileFixed(const cv::Mat& bgr16,
+                              float whiteLevel,
+                              const profile::Profile& prof,
+                              const ApplyOptions& options)
+    {
+        CV_Assert(bgr16.type() == CV_16UC3);
+        CV_Assert(options.depth == CV_16U || options.depth == CV_8U);
+
+        cv::Mat out(bgr16.size(), CV_MAKETYPE(options.depth, 3));
+        if (bgr16.empty())
+        {
+            return out;
+        }
+
+        const kernel::FixedTransform transform =
+            kernel::makeFixedTransform(prof, options.transfer, whiteLevel, options.depth == CV_8U ? 8 : 16);
+        const kernel::Isa isa = kernel::detectIsa();
+
+        const size_t cols = static_cast<size_t>(bgr16.cols);
+        forEachRowTile(bgr16.rows, cols * 3 * sizeof(std::uint16_t) + cols * out.elemSize(), options, [&](int y) {
+            const std::uint16_t* src = bgr16.ptr<std::uint16_t>(y);
+            if (options.depth == CV_16U)
+                kernel::applyRowFixed(transform, src, out.ptr<std::uint16_t>(y), cols, isa);
+            else
+                kernel::applyRowFixed(transform, src, out.ptr<std::uint8_t>(y), cols, isa);
+        });
+
+        return out;
+    }
+
+    cv::Mat applyLut(const cv::Mat& linearBgr,
+                     const lut::Lut3D& lut,
+                     const ApplyOptions& options)
+    {
+        CV_Assert(linearBgr.type() == CV_32FC3);
+        CV_Assert(options.depth == CV_32F || options.depth == CV_16U || options.depth == CV_8U);
+
+        cv::Mat out(linearBgr.size(), CV_MAKETYPE(options.depth, 3));
+        if (linearBgr.empty())
+        {
+            return out;
+        }
+
+        const kernel::Isa isa = kernel::detectIsa();
+        const size_t cols = static_cast<size_t>(linearBgr.cols);
+        forEachRowTile(linearBgr.rows, cols * 3 * sizeof(float) + cols * out.elemSize(), options, [&](int y) {
+            const float* src = linearBgr.ptr<float>(y);
+            if (options.depth == CV_16U)
+                lut::applyRow(lut, src, out.ptr<std::uint16_t>(y), cols, isa);
+            else if (options.depth == CV_8U)
+                lut::applyRow(lut, src, out.ptr<std::uint8_t>(y), cols, isa);
+            else
+                lut::applyRow(lut, src, out.ptr<float>(y), cols, isa);
+        });
+
+        return out;
+    }
 
     cv::Mat applyProfile(const cv::Mat& linearBgr,
                          const profile::Profile& prof,
                          bool applySrgbGamma)
     {
-        CV_Assert(linearBgr.type() == CV_32FC3);
+        ApplyOptions options;
+        options.transfer.curve = applySrgbGamma ? transfer::Curve::Srgb : transfer::Curve::Linear;
+        return applyProfile(linearBgr, prof, options);
+    }
+
+    void renderMosaicToTiff(const io::RawMosaic& mosaic,
+                            const profile::Profile& prof,
+                            const std::string& tiffPath,
+                            const ApplyOptions& options,
+                            bool fixedPoint)
+    {
+        const bool cfa = mosaic.bayerCode != -1;
+        CV_Assert(mosaic.data.type() == (cfa ? CV_16UC1 : CV_16UC3));
+        CV_Assert(options.depth == CV_16U || options.depth == CV_8U);
 
-        cv::Mat out(linearBgr.size(), linearBgr.type());
+        // Rows come in as the full-frame path's BGR; flipping the matrix
+        // rows makes the kernel produce the file's RGB directly.
+        kernel::ColorTransform transform = kernel::makeTransform(prof, options.transfer);
+        transform.matrix = Eigen::Matrix3f(transform.matrix.colwise().reverse());
+        transform.roots = Eigen::Matrix<float, 3, profile::kMaxRootTerms>(transform.roots.colwise().reverse());
+        const int outputBits = options.depth == CV_8U ? 8 : 16;
+        kernel::FixedTransform fixed;
+        if (fixedPoint)
+        {
+            fixed = kernel::makeFixedTransform(transform, mosaic.whiteLevel, outputBits);
+        }
+        const kernel::Isa isa = kernel::detectIsa();
 
-        const Eigen::Matrix3f& M = prof.colorMatrix;
-        const Eigen::Vector3f& wb = prof.whiteBalance;
+        // Raw and output samples per pixel; demosaicing only keeps a few rows.
+        const size_t pixelBytes = sizeof(std::uint16_t) * (cfa ? 1 : 3) + static_cast<size_t>(outputBits / 8) * 3;
+        const int side = std::max(16, static_cast<int>(std::sqrt(static_cast<double>(options.tileBytes) / pixelBytes)) / 16 * 16);
+        const float scale = 1.0f / mosaic.whiteLevel;
 
-        for (int y = 0; y < linearBgr.rows; ++y)
+        const int width = mosaic.data.cols;
+        const int height = mosaic.data.rows;
+        demosaic::MosaicView view;
+        if (cfa)
         {
-            const auto* inPtr = linearBgr.ptr<cv::Vec3f>(y);
-            auto* outPtr = out.ptr<cv::Vec3f>(y);
-            for (int x = 0; x < linearBgr.cols; ++x)
-            {
-                const cv::Vec3f& bgr = inPtr[x];
-                Eigen::Vector3f camRgb(bgr[2], bgr[1], bgr[0]); // BGR -> RGB
+            view.data = mosaic.data.ptr<std::uint16_t>();
+            view.stride = mosaic.data.step / sizeof(std::uint16_t);
+            view.width = width;
+            view.height = height;
+            view.cfa = demosaic::cfaFromBayerCode(mosaic.bayerCode);
+            view.black = mosaic.black;
+            view.scale = fixedPoint ? 1.0f : scale; // fixed point takes codes
+        }
+        io::TiledTiffWriter writer(tiffPath, width, height, outputBits, side, side);
+        const int across = writer.tilesAcross();
+
+        parallel::parallelFor(static_cast<size_t>(across) * writer.tilesDown(), [&](size_t index) {
+            const int x0 = static_cast<int>(index % across) * side;
+            const int y0 = static_cast<int>(index / across) * side;
+            const int cols = std::min(side, width - x0);
+            const int rows = std::min(side, height - y0);
 
-                camRgb = camRgb.cwiseProduct(wb);
-                Eigen::Vector3f tgt = M * camRgb;
+            cv::Mat tile = cv::Mat::zeros(side, side, CV_MAKETYPE(options.depth, 3));
+            std::vector<float> linear(3 * static_cast<size_t>(cols));
+            std::vector<std::uint16_t> codes(3 * static_cast<size_t>(cols));
 
-                if (applySrgbGamma)
+            // Black-subtracted codes, or linear values clipped at 1, to tile row y.
+            auto emitCodes = [&](int y, const std::uint16_t* src) {
+                if (outputBits == 8)
+                    kernel::applyRowFixed(fixed, src, tile.ptr<std::uint8_t>(y), cols, isa);
+                else
+                    kernel::applyRowFixed(fixed, src, tile.ptr<std::uint16_t>(y), cols, isa);
+            };
+            auto emitLinear = [&](int y) {
+                if (outputBits == 8)
+                    kernel::applyRow(transform, linear.data(), tile.ptr<std::uint8_t>(y), cols, isa);
+                else
+                    kernel::applyRow(transform, linear.data(), tile.ptr<std::uint16_t>(y), cols, isa);
+            };
+
+            if (cfa)
+            {
+                demosaic::demosaicRows(view, options.demosaic, x0, y0, cols, rows, [&](int y, const float* bgr) {
+                    if (fixedPoint)
+                    {
+                        for (size_t k = 0; k < codes.size(); ++k)
+                        {
+                            codes[k] = static_cast<std::uint16_t>(std::min(bgr[k] + 0.5f, 65535.0f));
+                        }
+                        emitCodes(y - y0, codes.data());
+                        return;
+                    }
+                    for (size_t k = 0; k < linear.size(); ++k)
+                    {
+                        linear[k] = std::min(bgr[k], 1.0f);
+                    }
+                    emitLinear(y - y0);
+                }, isa);
+            }
+            else
+            {
+                cv::Mat region;
+                cv::subtract(mosaic.data(cv::Rect(x0, y0, cols, rows)), cv::Scalar::all(mosaic.black), region);
+                for (int y = 0; y < rows; ++y)
                 {
-                    tgt[0] = srgbEncode(tgt[0]);
-                    tgt[1] = srgbEncode(tgt[1]);
-                    tgt[2] = srgbEncode(tgt[2]);
+                    const std::uint16_t* src = region.ptr<std::uint16_t>(y);
+                    if (fixedPoint)
+                    {
+                        emitCodes(y, src);
+                        continue;
+                    }
+                    for (size_t k = 0; k < linear.size(); ++k)
+                    {
+                        linear[k] = std::min(static_cast<float>(src[k]) * scale, 1.0f);
+                    }
+                    emitLinear(y);
                 }
-
-                // Back to BGR for OpenCV.
-                outPtr[x] = cv::Vec3f(tgt[2], tgt[1], tgt[0]);
             }
-        }
 
-        return out;
+            writer.writeTile(x0 / side, y0 / side, tile.data, tile.step);
+        }, options.threads);
+
+        writer.close();
     }
-} // namespace css::pipeline
 
+    void renderDngToTiff(const std::string& dngPath,
+                         const profile::Profile& prof,
+                         const std::string& tiffPath,
+                         const ApplyOptions& options,
+                         bool fixedPoint)
+    {
+        renderMosaicToTiff(io::loadDngMosaic(dngPath), prof, tiffPath, options, fixedPoint);
+    }
+} // namespace css::pipeline
@@ -1,7 +1,11 @@
 #include "css/priors.hpp"
 #include <opencv2/core.hpp>
+#include <cstring>
+#include <fstream>
+#include <new>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
 
 namespace
 {
@@ -11,22 +15,45 @@ namespace
         if (cvMat.empty()) return Eigen::MatrixXf();
         
         // YAML 'dt: d' means double (CV_64F)
+        if (cvMat.type() != CV_64F && cvMat.type() != CV_32F)
+        {
+            throw std::runtime_error("Unsupported cv::Mat type in yaml loader (expected float or double)");
+        }
+
+        // One conversion pass, then row copies (cv::Mat is row-major).
+        cv::Mat f32;
+        cvMat.convertTo(f32, CV_32F);
+
         Eigen::MatrixXf eigMat(cvMat.rows, cvMat.cols);
-        
-        for(int r = 0; r < cvMat.rows; ++r)
+        for (int r = 0; r < cvMat.rows; ++r)
         {
-            for(int c = 0; c < cvMat.cols; ++c)
-            {
-                if (cvMat.type() == CV_64F)
-                    eigMat(r, c) = static_cast<float>(cvMat.at<double>(r, c));
-                else if (cvMat.type() == CV_32F)
-                    eigMat(r, c) = cvMat.at<float>(r, c);
-                else
-                    throw std::runtime_error("Unsupported cv::Mat type in yaml loader (expected float or double)");
-            }
+            eigMat.row(r) = Eigen::Map<const Eigen::RowVectorXf>(f32.ptr<float>(r), cvMat.cols);
         }
         return eigMat;
     }
+
+    constexpr char kBinaryMagic[8] = {'C', 'S', 'P', 'R', 'I', 'O', 'R', 'S'};
+    constexpr std::uint32_t kBinaryVersion = 1;
+    constexpr std::uint32_t kByteOrderMark = 0x01020304; // read back swapped on a host of the other byte order
+
+    // On-disk header of the binary priors format (writer's byte order, see byteOrder).
+    struct BinaryHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerBytes;
+        float gridStart;
+        float gridStep;
+        std::int32_t gridCount;
+        std::int32_t componentsR;
+        std::int32_t componentsG;
+        std::int32_t componentsB;
+        std::int32_t patches;
+        std::uint32_t byteOrder; // kByteOrderMark
+        std::uint64_t payloadBytes;
+        std::uint64_t contentHash;
+    };
+    static_assert(sizeof(BinaryHeader) == 64, "binary priors header must stay 64 bytes");
 }
 
 namespace css::priors
@@ -58,6 +85,293 @@ namespace css::priors
         result.basisB = cvToEigen(b);
         result.reflectance = cvToEigen(refl);
 
+        if (!fs["wavelength_start"].empty())
+        {
+            result.grid.start = static_cast<float>(fs["wavelength_start"].real());
+        }
+        if (!fs["wavelength_step"].empty())
+        {
+            result.grid.step = static_cast<float>(fs["wavelength_step"].real());
+        }
+        result.grid.count = static_cast<int>(result.reflectance.rows());
+
+        if (result.basisR.rows() != result.grid.count ||
+            result.basisG.rows() != result.grid.count ||
+            result.basisB.rows() != result.grid.count)
+        {
+            throw std::runtime_error("PCA basis rows != reflectance rows in " + path);
+        }
+
+        return result;
+    }
+
+    void savePriorsToYaml(const std::string& path, const CameraPriors& priors)
+    {
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened())
+        {
+            throw std::runtime_error("Failed to open priors file for writing: " + path);
+        }
+
+        auto toCv = [](const Eigen::MatrixXf& m) {
+            cv::Mat out(static_cast<int>(m.rows()), static_cast<int>(m.cols()), CV_32F);
+            for (int r = 0; r < out.rows; ++r)
+            {
+                Eigen::Map<Eigen::RowVectorXf>(out.ptr<float>(r), out.cols) = m.row(r);
+            }
+            return out;
+        };
+
+        fs << "basis_r" << toCv(priors.basisR);
+        fs << "basis_g" << toCv(priors.basisG);
+        fs << "basis_b" << toCv(priors.basisB);
+        fs << "reflectance" << toCv(priors.reflectance);
+        fs << "wavelength_start" << static_cast<double>(priors.grid.start);
+        fs << "wavelength_step" << static_cast<double>(priors.grid.step);
+        fs.release();
+    }
+
+    void savePriorsBinary(const std::string& path, const CameraPriors& priors)
+    {
+        const Eigen::Index n = priors.grid.count;
+        if (priors.basisR.rows() != n || priors.basisG.rows() != n ||
+            priors.basisB.rows() != n || priors.reflectance.rows() != n)
+        {
+            throw std::runtime_error("savePriorsBinary: matrices do not match the spectral grid");
+        }
+
+        // Payload: the four matrices back to back, column-major float32.
+        std::vector<unsigned char> payload;
+        for (const Eigen::MatrixXf* m : {&priors.basisR, &priors.basisG, &priors.basisB, &priors.reflectance})
+        {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(m->data());
+            payload.insert(payload.end(), bytes, bytes + m->size() * sizeof(float));
+        }
+
+        BinaryHeader header{};
+        std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+        header.version = kBinaryVersion;
+        header.headerBytes = sizeof(BinaryHeader);
+        header.byteOrder = kByteOrderMark;
+        header.gridStart = priors.grid.start;
+        header.gridStep = priors.grid.step;
+        header.gridCount = priors.grid.count;
+        header.componentsR = static_cast<std::int32_t>(priors.basisR.cols());
+        header.componentsG = static_cast<std::int32_t>(priors.basisG.cols());
+        header.componentsB = static_cast<std::int32_t>(priors.basisB.cols());
+        header.patches = static_cast<std::int32_t>(priors.reflectance.cols());
+        header.payloadBytes = payload.size();
+        header.contentHash = io::fnv1a64(payload.data(), payload.size());
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+        {
+            throw std::runtime_error("Failed to open priors file for writing: " + path);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write priors file: " + path);
+        }
+    }
+
+    bool isPriorsBinary(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(kBinaryMagic)] = {};
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+    }
+
+    MappedPriors::MappedPriors(const std::string& path, bool verifyHash)
+        : m_file(path)
+    {
+        if (m_file.size() < sizeof(BinaryHeader))
+        {
+            throw std::runtime_error("Binary priors file too small: " + path);
+        }
+
+        BinaryHeader header;
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0)
+        {
+            throw std::runtime_error("Not a binary priors file: " + path);
+        }
+        if (header.version != kBinaryVersion || header.headerBytes != sizeof(BinaryHeader))
+        {
+            throw std::runtime_error("Unsupported binary priors version in " + path);
+        }
+        if (header.byteOrder != kByteOrderMark)
+        {
+            throw std::runtime_error("Unsupported binary priors byte order in " + path);
+        }
+
+        const std::int64_t n = header.gridCount;
+        const std::int64_t floats = n * (static_cast<std::int64_t>(header.componentsR) + header.componentsG +
+                                         header.componentsB + header.patches);
+        if (n <= 0 || header.componentsR <= 0 || header.componentsG <= 0 || header.componentsB <= 0 ||
+            header.patches <= 0 || header.payloadBytes != static_cast<std::uint64_t>(floats) * sizeof(float) ||
+            m_file.size() - sizeof(BinaryHeader) < header.payloadBytes)
+        {
+            throw std::runtime_error("Corrupt binary priors header in " + path);
+        }
+
+        const unsigned char* payload = m_file.data() + sizeof(BinaryHeader);
+        if (verifyHash && io::fnv1a64(payload, header.payloadBytes) != header.contentHash)
+        {
+            throw std::runtime_error("Binary priors content hash mismatch in " + path);
+        }
+
+        m_grid.start = header.gridStart;
+        m_grid.step = header.gridStep;
+        m_grid.count = header.gridCount;
+        m_hash = header.contentHash;
+
+        // The 64-byte header keeps the payload float-aligned within the page-aligned mapping.
+        const float* p = reinterpret_cast<const float*>(payload);
+        new (&m_basisR) ConstMap(p, n, header.componentsR);
+        p += n * header.componentsR;
+        new (&m_basisG) ConstMap(p, n, header.componentsG);
+        p += n * header.componentsG;
+        new (&m_basisB) ConstMap(p, n, header.componentsB);
+        p += n * header.componentsB;
+        new (&m_reflectance) ConstMap(p, n, header.patches);
+    }
+
+    CameraPriors MappedPriors::toPriors() const
+    {
+        CameraPriors result;
+        result.basisR = m_basisR;
+        result.basisG = m_basisG;
+        result.basisB = m_basisB;
+        result.reflectance = m_reflectance;
+        result.grid = m_grid;
+        return result;
+    }
+
+    PriorsView::PriorsView(const CameraPriors& priors)
+        : basisR(priors.basisR),
+          basisG(priors.basisG),
+          basisB(priors.basisB),
+          reflectance(priors.reflectance),
+          grid(priors.grid)
+    {
+    }
+
+    PriorsView::PriorsView(const MappedPriors& priors)
+        : basisR(priors.basisR()),
+          basisG(priors.basisG()),
+          basisB(priors.basisB()),
+          reflectance(priors.reflectance()),
+          grid(priors.grid())
+    {
+    }
+
+    CameraPriors loadPriors(const std::string& path)
+    {
+        if (isPriorsBinary(path))
+        {
+            return MappedPriors(path).toPriors();
+        }
+        return loadPriorsFromYaml(path);
+    }
+
+    void savePriors(const std::string& path, const CameraPriors& priors)
+    {
+        const std::string ext = ".cspri";
+        if (path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0)
+        {
+            savePriorsBinary(path, priors);
+        }
+        else
+        {
+            savePriorsToYaml(path, priors);
+        }
+    }
+
+    CameraPriors buildPriors(const std::vector<Eigen::MatrixXf>& curves,
+                             const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const BuildOptions& options,
+                             Eigen::Vector3f* explained)
+    {
+        Eigen::MatrixXf packed(grid.count, 3 * static_cast<Eigen::Index>(curves.size()));
+        for (size_t j = 0; j < curves.size(); ++j)
+        {
+            if (curves[j].rows() != grid.count || curves[j].cols() != 3)
+            {
+                throw std::runtime_error("buildPriors: every curve set must be grid.count x 3");
+            }
+            packed.middleCols(3 * static_cast<Eigen::Index>(j), 3) = curves[j];
+        }
+        return buildPriors(packed, reflectance, grid, options, explained);
+    }
+
+    CameraPriors buildPriors(const Eigen::Ref<const Eigen::MatrixXf>& packed,
+                             const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const BuildOptions& options,
+                             Eigen::Vector3f* explained)
+    {
+        if (reflectance.rows() != grid.count)
+        {
+            throw std::runtime_error("buildPriors: reflectance does not match the spectral grid");
+        }
+        if (packed.rows() != grid.count || packed.cols() % 3 != 0)
+        {
+            throw std::runtime_error("buildPriors: packed curves must be grid.count x 3M");
+        }
+
+        // One data matrix per channel, one column per camera.
+        const Eigen::Index m = packed.cols() / 3;
+        Eigen::MatrixXf data[3];
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            data[ch].resize(grid.count, m);
+            for (Eigen::Index j = 0; j < m; ++j)
+            {
+                data[ch].col(j) = packed.col(3 * j + ch);
+                float peak = data[ch].col(j).cwiseAbs().maxCoeff();
+                if (options.normalize && peak > 0.0f)
+                {
+                    data[ch].col(j) /= peak;
+                }
+            }
+        }
+
+        CameraPriors result;
+        Eigen::MatrixXf* bases[] = { &result.basisR, &result.basisG, &result.basisB };
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            pca::Basis basis = pca::principalBasis(data[ch], options.basis);
+            *bases[ch] = basis.vectors;
+            if (explained)
+            {
+                (*explained)[ch] = basis.explainedEnergy;
+            }
+        }
+        result.reflectance = reflectance;
+        result.grid = grid;
+        return result;
+    }
+
+    CameraPriors resamplePriors(const CameraPriors& priors,
+                                const spectral::SpectralGrid& grid,
+                                spectral::ResampleMethod method)
+    {
+        if (priors.grid == grid)
+        {
+            return priors;
+        }
+
+        spectral::Resampler resampler(priors.grid, grid, method);
+
+        CameraPriors result;
+        result.basisR = resampler.apply(priors.basisR);
+        result.basisG = resampler.apply(priors.basisG);
+        result.basisB = resampler.apply(priors.basisB);
+        result.reflectance = resampler.apply(priors.reflectance);
+        result.grid = grid;
         return result;
     }
 }
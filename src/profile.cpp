@@ -1,11 +1,72 @@
 #include "css/profile.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 
 namespace css::profile
 {
+    int termCount(Model model)
+    {
+        switch (model)
+        {
+        case Model::RootPoly2: return 6;
+        case Model::RootPoly3: return 13;
+        default: return 3;
+        }
+    }
+
+    Model parseModel(const std::string& name)
+    {
+        if (name == "linear")
+            return Model::Linear;
+        if (name == "rp2")
+            return Model::RootPoly2;
+        if (name == "rp3")
+            return Model::RootPoly3;
+        throw std::runtime_error("Unknown color model: " + name + " (expected linear, rp2 or rp3)");
+    }
+
+    const char* modelName(Model model)
+    {
+        switch (model)
+        {
+        case Model::RootPoly2: return "rp2";
+        case Model::RootPoly3: return "rp3";
+        default: return "linear";
+        }
+    }
+
+    Eigen::Matrix<float, kMaxRootTerms, 1> rootTerms(const Eigen::Vector3f& rgb, Model model)
+    {
+        Eigen::Matrix<float, kMaxRootTerms, 1> t = Eigen::Matrix<float, kMaxRootTerms, 1>::Zero();
+        if (model == Model::Linear)
+        {
+            return t;
+        }
+
+        const float r = std::max(rgb[0], 0.0f);
+        const float g = std::max(rgb[1], 0.0f);
+        const float b = std::max(rgb[2], 0.0f);
+        t[0] = std::sqrt(r * g);
+        t[1] = std::sqrt(g * b);
+        t[2] = std::sqrt(r * b);
+        if (model == Model::RootPoly3)
+        {
+            const float cr = std::cbrt(r), cg = std::cbrt(g), cb = std::cbrt(b);
+            t[3] = cr * cg * cg;
+            t[4] = cg * cb * cb;
+            t[5] = cr * cb * cb;
+            t[6] = cg * cr * cr;
+            t[7] = cb * cg * cg;
+            t[8] = cb * cr * cr;
+            t[9] = cr * cg * cb;
+        }
+        return t;
+    }
+
     bool saveProfile(const std::string& path, const Profile& p)
     {
         std::ofstream out(path);
@@ -37,6 +98,25 @@ namespace css::profile
             << p.whiteBalance[1] << " "
             << p.whiteBalance[2] << "\n";
 
+        if (p.model != Model::Linear)
+        {
+            out << "model=" << modelName(p.model) << "\n";
+            out << "R=";
+            const int terms = termCount(p.model) - 3;
+            for (int r = 0; r < 3; ++r)
+            {
+                for (int c = 0; c < terms; ++c)
+                {
+                    out << p.rootMatrix(r, c);
+                    if (!(r == 2 && c == terms - 1))
+                    {
+                        out << " ";
+                    }
+                }
+            }
+            out << "\n";
+        }
+
         return true;
     }
 
@@ -51,6 +131,7 @@ namespace css::profile
         Profile p;
         p.chartType = "ColorChecker24";
         p.targetColorSpace = "linear_srgb";
+        std::string roots;
 
         std::string line;
         while (std::getline(in, line))
@@ -99,6 +180,32 @@ namespace css::profile
                    >> p.whiteBalance[1]
                    >> p.whiteBalance[2];
             }
+            else if (key == "model")
+            {
+                p.model = parseModel(value);
+            }
+            else if (key == "R")
+            {
+                roots = value;
+            }
+        }
+
+        // Parsed last: the coefficient count depends on the model.
+        if (!roots.empty())
+        {
+            std::stringstream ss(roots);
+            const int terms = termCount(p.model) - 3;
+            for (int r = 0; r < 3; ++r)
+            {
+                for (int c = 0; c < terms; ++c)
+                {
+                    ss >> p.rootMatrix(r, c);
+                }
+            }
+            if (!ss)
+            {
+                throw std::runtime_error("Truncated root-polynomial coefficients in profile: " + path);
+            }
         }
 
         return p;
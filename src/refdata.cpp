@@ -1,8 +1,17 @@
 #include "css/refdata.hpp"
+#include "css/colorimetry.hpp"
+#include "css/colorspace.hpp"
+#include "css/embedded_data.hpp"
+#include "css/illuminant.hpp"
+#include "css/mapped_file.hpp"
+#include "css/resample.hpp"
 
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
 
 namespace css::refdata
 {
@@ -24,6 +33,8 @@ namespace css::refdata
         bool firstLine = true;
         while (std::getline(in, line))
         {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back(); // CRLF files
             if (line.empty())
                 continue;
 
@@ -87,5 +98,144 @@ namespace css::refdata
 
         return set;
     }
+
+    RefSet defaultColorChecker24(const std::string& illuminant,
+                                 const std::string& colorSpace)
+    {
+        static_assert(embedded::kColorChecker24Count == 24, "data/colorchecker_24_D65.csv must hold 24 patches");
+
+        RefSet set;
+        set.illuminant = illuminant;
+        set.colorSpace = colorSpace;
+        set.patches.reserve(embedded::kColorChecker24Count);
+        for (const auto& row : embedded::kColorChecker24D65)
+        {
+            PatchRef p;
+            p.index = row.index;
+            p.name = row.name;
+            p.linearSrgb = Eigen::Vector3f(row.r, row.g, row.b);
+            set.patches.push_back(p);
+        }
+        return set;
+    }
+
+    RefSet spectralReference(const Eigen::MatrixXf& reflectance,
+                             const spectral::SpectralGrid& grid,
+                             const Eigen::VectorXf& illuminantSpd,
+                             const std::string& illuminant,
+                             const std::string& colorSpace,
+                             Adaptation adaptation)
+    {
+        if (reflectance.rows() != grid.count || illuminantSpd.size() != grid.count)
+        {
+            throw std::runtime_error("spectralReference: reflectance and SPD must have grid.count rows");
+        }
+
+        const colorspace::ColorSpace space = colorspace::find(colorSpace);
+
+        const Eigen::MatrixXf cmf = colorimetry::cie1931(grid);
+        const Eigen::Vector3f white = cmf.transpose() * illuminantSpd;
+        if (!(white.y() > 0.0f))
+        {
+            throw std::runtime_error("spectralReference: illuminant has no luminance on this grid");
+        }
+
+        // Patch XYZ (3 x N), perfect reflector at Y = 1.
+        const Eigen::MatrixXf xyz = (cmf.transpose() * illuminantSpd.asDiagonal() * reflectance) / white.y();
+
+        Eigen::Matrix3f toTarget = Eigen::Matrix3f::Identity();
+        if (adaptation == Adaptation::Bradford)
+        {
+            toTarget = colorimetry::bradfordAdaptation(white / white.y(), space.white);
+        }
+        toTarget = space.fromXyz * toTarget;
+        const Eigen::MatrixXf target = toTarget * xyz;
+
+        const bool colorChecker = reflectance.cols() == embedded::kColorChecker24Count;
+
+        RefSet set;
+        set.illuminant = illuminant;
+        set.colorSpace = colorSpace;
+        set.patches.reserve(reflectance.cols());
+        for (Eigen::Index i = 0; i < reflectance.cols(); ++i)
+        {
+            PatchRef p;
+            p.index = static_cast<int>(i);
+            p.name = colorChecker ? embedded::kColorChecker24D65[i].name : "Patch " + std::to_string(i + 1);
+            p.linearSrgb = target.col(i);
+            set.patches.push_back(p);
+        }
+        return set;
+    }
+
+    namespace
+    {
+        // (chart, spectra hash, grid start/step/count, illuminant, color space, adaptation)
+        using CacheKey = std::tuple<std::string, std::uint64_t, float, float, int, std::string, std::string, int>;
+
+        std::mutex& cacheMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::map<CacheKey, std::shared_ptr<const RefSet>>& cache()
+        {
+            static std::map<CacheKey, std::shared_ptr<const RefSet>> entries;
+            return entries;
+        }
+
+        std::uint64_t spectraHash(const Eigen::MatrixXf& reflectance)
+        {
+            return io::fnv1a64(reinterpret_cast<const unsigned char*>(reflectance.data()),
+                               sizeof(float) * static_cast<size_t>(reflectance.size()));
+        }
+    } // namespace
+
+    std::shared_ptr<const RefSet> cachedReference(const std::string& chart,
+                                                  const Eigen::MatrixXf& reflectance,
+                                                  const spectral::SpectralGrid& grid,
+                                                  const std::string& illuminant,
+                                                  const std::string& colorSpace,
+                                                  Adaptation adaptation,
+                                                  const illuminant::IlluminantLibrary* library)
+    {
+        const CacheKey key(chart, spectraHash(reflectance), grid.start, grid.step, grid.count,
+                           illuminant, colorSpace, static_cast<int>(adaptation));
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            auto it = cache().find(key);
+            if (it != cache().end())
+            {
+                return it->second;
+            }
+        }
+
+        // Computed outside the lock; a racing thread's identical result wins.
+        Eigen::VectorXf spd;
+        if (library)
+        {
+            spd = library->spectrum(illuminant);
+            if (library->grid() != grid)
+            {
+                spd = spectral::resample(spd, library->grid(), grid);
+            }
+        }
+        else
+        {
+            spd = illuminant::IlluminantLibrary(grid).spectrum(illuminant);
+        }
+        auto set = std::make_shared<const RefSet>(
+            spectralReference(reflectance, grid, spd, illuminant, colorSpace, adaptation));
+
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        return cache().emplace(key, std::move(set)).first->second;
+    }
+
+    void clearReferenceCache()
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        cache().clear();
+    }
 } // namespace css::refdata
 
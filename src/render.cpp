@@ -0,0 +1,246 @@
+#include "css/render.hpp"
+#include "css/parallel.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace css::render
+{
+    namespace
+    {
+        // Columns per GEMM task: large enough to amortize dispatch, small
+        // enough that the output block stays in cache.
+        constexpr Eigen::Index kBlockCols = 2048;
+
+        spectral::SpectralGrid readHeader(std::ifstream& in, const std::string& path)
+        {
+            if (!in)
+            {
+                throw std::runtime_error("Failed to open reflectance CSV: " + path);
+            }
+
+            std::string line;
+            if (!std::getline(in, line))
+            {
+                throw std::runtime_error("Empty reflectance CSV: " + path);
+            }
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            std::stringstream ss(line);
+            std::string token;
+            std::getline(ss, token, ','); // name column
+            std::vector<float> wavelengths;
+            while (std::getline(ss, token, ','))
+            {
+                wavelengths.push_back(std::stof(token));
+            }
+            if (wavelengths.size() < 2)
+            {
+                throw std::runtime_error("Reflectance CSV header needs name,<wavelength_nm>,...: " + path);
+            }
+
+            spectral::SpectralGrid source;
+            source.start = wavelengths.front();
+            source.count = static_cast<int>(wavelengths.size());
+            source.step = (wavelengths.back() - source.start) / static_cast<float>(source.count - 1);
+            for (int i = 0; i < source.count; ++i)
+            {
+                if (std::abs(wavelengths[i] - source.wavelength(i)) > 1e-2f * source.step)
+                {
+                    throw std::runtime_error("Reflectance CSV wavelengths are not uniformly spaced: " + path);
+                }
+            }
+            return source;
+        }
+    } // namespace
+
+    SpectralRenderer::SpectralRenderer(const Eigen::MatrixXf& css,
+                                       const Eigen::MatrixXf& illuminants,
+                                       const spectral::SpectralGrid& grid,
+                                       bool normalizeWhite)
+        : m_grid(grid)
+    {
+        if (css.rows() != grid.count || css.cols() != 3)
+        {
+            throw std::runtime_error("SpectralRenderer: CSS must be grid.count x 3.");
+        }
+        if (illuminants.rows() != grid.count || illuminants.cols() == 0)
+        {
+            throw std::runtime_error("SpectralRenderer: illuminants must be grid.count x L.");
+        }
+
+        const Eigen::Index L = illuminants.cols();
+        m_weights.resize(3 * L, grid.count);
+        for (Eigen::Index l = 0; l < L; ++l)
+        {
+            auto w = m_weights.middleRows(3 * l, 3);
+            w = (css.array().colwise() * illuminants.col(l).array()).transpose() * grid.step;
+
+            if (normalizeWhite)
+            {
+                float white = w.row(1).sum();
+                if (!(white > 0.0f))
+                {
+                    throw std::runtime_error("SpectralRenderer: illuminant gives no green response to white.");
+                }
+                w /= white;
+            }
+        }
+    }
+
+    Eigen::MatrixXf SpectralRenderer::render(const Eigen::MatrixXf& reflectances) const
+    {
+        Eigen::MatrixXf out(m_weights.rows(), reflectances.cols());
+        render(reflectances, out);
+        return out;
+    }
+
+    void SpectralRenderer::render(const Eigen::Ref<const Eigen::MatrixXf>& reflectances, Eigen::Ref<Eigen::MatrixXf> out) const
+    {
+        if (reflectances.rows() != m_grid.count)
+        {
+            throw std::runtime_error("SpectralRenderer: reflectances do not match the spectral grid.");
+        }
+        if (out.rows() != m_weights.rows() || out.cols() != reflectances.cols())
+        {
+            throw std::runtime_error("SpectralRenderer: output must be 3L x N.");
+        }
+
+        const Eigen::Index n = reflectances.cols();
+        const size_t blocks = static_cast<size_t>((n + kBlockCols - 1) / kBlockCols);
+        parallel::parallelFor(blocks, [&](size_t b) {
+            Eigen::Index c0 = static_cast<Eigen::Index>(b) * kBlockCols;
+            Eigen::Index cols = std::min(kBlockCols, n - c0);
+            out.middleCols(c0, cols).noalias() = m_weights * reflectances.middleCols(c0, cols);
+        });
+    }
+
+    Eigen::MatrixXf SpectralRenderer::render(const Eigen::MatrixXf& reflectances, int l) const
+    {
+        if (l < 0 || l >= numIlluminants())
+        {
+            throw std::runtime_error("SpectralRenderer: illuminant index out of range.");
+        }
+        if (reflectances.rows() != m_grid.count)
+        {
+            throw std::runtime_error("SpectralRenderer: reflectances do not match the spectral grid.");
+        }
+        return m_weights.middleRows(3 * l, 3) * reflectances;
+    }
+
+    ReflectanceReader::ReflectanceReader(const std::string& path,
+                                         const spectral::SpectralGrid& grid,
+                                         float scale)
+        : m_in(path),
+          m_path(path),
+          m_source(readHeader(m_in, path)),
+          m_resampler(m_source, grid),
+          m_scale(scale)
+    {
+    }
+
+    int ReflectanceReader::next(int maxCount, Eigen::MatrixXf& block, std::vector<std::string>& names)
+    {
+        if (maxCount <= 0)
+        {
+            throw std::runtime_error("ReflectanceReader: block size must be positive.");
+        }
+        if (m_raw.cols() < maxCount)
+        {
+            m_raw.resize(m_source.count, maxCount);
+        }
+
+        names.clear();
+        int count = 0;
+        std::string line;
+        while (count < maxCount && std::getline(m_in, line))
+        {
+            ++m_line;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            auto comma = line.find(',');
+            if (comma == std::string::npos)
+            {
+                throw std::runtime_error("Reflectance CSV: missing values at line " + std::to_string(m_line) + " of " + m_path);
+            }
+            names.push_back(line.substr(0, comma));
+
+            // strtof straight off the line buffer: this loop is the reader's hot path.
+            const char* p = line.c_str() + comma + 1;
+            for (int i = 0; i < m_source.count; ++i)
+            {
+                char* end = nullptr;
+                errno = 0;
+                float v = std::strtof(p, &end);
+                if (end == p || errno == ERANGE)
+                {
+                    throw std::runtime_error("Reflectance CSV: expected " + std::to_string(m_source.count) +
+                                             " values at line " + std::to_string(m_line) + " of " + m_path);
+                }
+                m_raw(i, count) = v * m_scale;
+                p = (*end == ',') ? end + 1 : end;
+            }
+            ++count;
+        }
+
+        block.resize(m_resampler.to().count, count);
+        if (count > 0)
+        {
+            m_resampler.apply(m_raw.leftCols(count), block);
+        }
+        return count;
+    }
+
+    Eigen::MatrixXf loadReflectanceCsv(const std::string& path,
+                                       const spectral::SpectralGrid& grid,
+                                       std::vector<std::string>* names,
+                                       float scale)
+    {
+        ReflectanceReader reader(path, grid, scale);
+
+        std::vector<Eigen::MatrixXf> blocks;
+        std::vector<std::string> blockNames;
+        Eigen::Index total = 0;
+        Eigen::MatrixXf block;
+        while (reader.next(8192, block, blockNames) > 0)
+        {
+            total += block.cols();
+            blocks.push_back(block);
+            if (names) names->insert(names->end(), blockNames.begin(), blockNames.end());
+        }
+
+        Eigen::MatrixXf all(grid.count, total);
+        Eigen::Index c = 0;
+        for (const auto& b : blocks)
+        {
+            all.middleCols(c, b.cols()) = b;
+            c += b.cols();
+        }
+        return all;
+    }
+
+    size_t renderStream(ReflectanceReader& reader,
+                        const SpectralRenderer& renderer,
+                        const std::function<void(const std::vector<std::string>&, const Eigen::MatrixXf&)>& sink,
+                        int blockSize)
+    {
+        Eigen::MatrixXf block;
+        Eigen::MatrixXf rgb;
+        std::vector<std::string> names;
+        size_t total = 0;
+        int count = 0;
+        while ((count = reader.next(blockSize, block, names)) > 0)
+        {
+            rgb.resize(renderer.weights().rows(), count);
+            renderer.render(block, rgb);
+            sink(names, rgb);
+            total += static_cast<size_t>(count);
+        }
+        return total;
+    }
+} // namespace css::render
@@ -0,0 +1,204 @@
+#include "css/resample.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace css::spectral
+{
+    namespace
+    {
+        // Sprague polynomial coefficients (x24): rows a0..a5, columns p[i-2]..p[i+3].
+        constexpr double kSpragueA[6][6] = {
+            {  0.0,   0.0,  24.0,    0.0,   0.0,   0.0 },
+            {  2.0, -16.0,   0.0,   16.0,  -2.0,   0.0 },
+            { -1.0,  16.0, -30.0,   16.0,  -1.0,   0.0 },
+            { -9.0,  39.0, -70.0,   66.0, -33.0,   7.0 },
+            { 13.0, -64.0, 126.0, -124.0,  61.0, -12.0 },
+            { -5.0,  25.0, -50.0,   50.0, -25.0,   5.0 },
+        };
+
+        // Boundary extrapolation (x209) for the two padding samples at each end.
+        constexpr double kSpragueC[4][6] = {
+            {  884.0, -1960.0,  3033.0, -2648.0,  1080.0,  -180.0 }, // p[-2] from p[0..5]
+            {  508.0,  -540.0,   488.0,  -367.0,   144.0,   -24.0 }, // p[-1] from p[0..5]
+            {  -24.0,   144.0,  -367.0,   488.0,  -540.0,   508.0 }, // p[n]   from p[n-6..n-1]
+            { -180.0,  1080.0, -2648.0,  3033.0, -1960.0,   884.0 }, // p[n+1] from p[n-6..n-1]
+        };
+
+        using RowD = Eigen::RowVectorXd;
+
+        void linearRow(double pos, int n, RowD& row)
+        {
+            pos = std::clamp(pos, 0.0, static_cast<double>(n - 1));
+            int i = std::min(static_cast<int>(pos), std::max(n - 2, 0));
+            double t = pos - i;
+            row[i] += 1.0 - t;
+            if (t > 0.0)
+            {
+                row[i + 1] += t;
+            }
+        }
+
+        // Padded samples p[-2..n+1] as combinations of the n original samples.
+        Eigen::MatrixXd spraguePadding(int n)
+        {
+            Eigen::MatrixXd P = Eigen::MatrixXd::Zero(n + 4, n);
+            P.block(2, 0, n, n).setIdentity();
+            for (int k = 0; k < 6; ++k)
+            {
+                P(0, k) = kSpragueC[0][k] / 209.0;
+                P(1, k) = kSpragueC[1][k] / 209.0;
+                P(n + 2, n - 6 + k) = kSpragueC[2][k] / 209.0;
+                P(n + 3, n - 6 + k) = kSpragueC[3][k] / 209.0;
+            }
+            return P;
+        }
+
+        void spragueRow(double pos, int n, const Eigen::MatrixXd& padding, RowD& row)
+        {
+            if (pos <= 0.0 || pos >= n - 1)
+            {
+                row[pos <= 0.0 ? 0 : n - 1] += 1.0;
+                return;
+            }
+
+            const int i = std::min(static_cast<int>(pos), n - 2);
+            const double t = pos - i;
+
+            double w[6] = {};
+            double tm = 1.0;
+            for (int m = 0; m < 6; ++m, tm *= t)
+            {
+                for (int k = 0; k < 6; ++k)
+                {
+                    w[k] += tm * kSpragueA[m][k] / 24.0;
+                }
+            }
+
+            // p[i-2+k] is padded row i+k.
+            for (int k = 0; k < 6; ++k)
+            {
+                row += w[k] * padding.row(i + k);
+            }
+        }
+
+        // Mean of the linear interpolant over [a, b] (wavelengths in nm).
+        void rebinRow(double a, double b, const SpectralGrid& from, RowD& row)
+        {
+            const double x0 = from.start;
+            const double h = from.step;
+            const int n = from.count;
+
+            a = std::max(a, x0);
+            b = std::min(b, static_cast<double>(from.end()));
+            if (b - a <= 1e-9 * h)
+            {
+                // Bin outside (or at the edge of) the source range.
+                linearRow((0.5 * (a + b) - x0) / h, n, row);
+                return;
+            }
+
+            const int first = std::clamp(static_cast<int>(std::floor((a - x0) / h)), 0, n - 2);
+            const int last = std::clamp(static_cast<int>(std::ceil((b - x0) / h)) - 1, 0, n - 2);
+            for (int k = first; k <= last; ++k)
+            {
+                const double xk = x0 + h * k;
+                const double u = std::max(a, xk);
+                const double v = std::min(b, xk + h);
+                if (v <= u)
+                    continue;
+
+                const double tu = (u - xk) / h;
+                const double tv = (v - xk) / h;
+                const double rise = 0.5 * (tv * tv - tu * tu) * h;
+                row[k] += (tv - tu) * h - rise;
+                row[k + 1] += rise;
+            }
+            row /= (b - a);
+        }
+    } // namespace
+
+    Resampler::Resampler(const SpectralGrid& from, const SpectralGrid& to, ResampleMethod method)
+        : m_from(from),
+          m_to(to)
+    {
+        if (from.count < 1 || to.count < 1 || !(from.step > 0.0f) || !(to.step > 0.0f))
+        {
+            throw std::runtime_error("Resampler: invalid spectral grid.");
+        }
+
+        if (method == ResampleMethod::Auto)
+        {
+            if (to.step > from.step * (1.0f + 1e-6f))
+                method = ResampleMethod::Rebin;
+            else
+                method = from.count >= 6 ? ResampleMethod::Sprague : ResampleMethod::Linear;
+        }
+        if (method == ResampleMethod::Sprague && from.count < 6)
+        {
+            throw std::runtime_error("Resampler: Sprague interpolation needs at least 6 samples.");
+        }
+        if (from.count == 1)
+        {
+            m_op = Eigen::MatrixXf::Ones(to.count, 1);
+            return;
+        }
+
+        const Eigen::MatrixXd padding = method == ResampleMethod::Sprague ? spraguePadding(from.count)
+                                                                          : Eigen::MatrixXd();
+
+        Eigen::MatrixXd op = Eigen::MatrixXd::Zero(to.count, from.count);
+        for (int j = 0; j < to.count; ++j)
+        {
+            const double lambda = static_cast<double>(to.start) + static_cast<double>(to.step) * j;
+            const double pos = (lambda - from.start) / from.step;
+
+            RowD row = RowD::Zero(from.count);
+            switch (method)
+            {
+            case ResampleMethod::Linear:
+                linearRow(pos, from.count, row);
+                break;
+            case ResampleMethod::Sprague:
+                spragueRow(pos, from.count, padding, row);
+                break;
+            case ResampleMethod::Rebin:
+                rebinRow(lambda - 0.5 * to.step, lambda + 0.5 * to.step, from, row);
+                break;
+            case ResampleMethod::Auto:
+                break;
+            }
+            op.row(j) = row;
+        }
+        m_op = op.cast<float>();
+    }
+
+    Eigen::MatrixXf Resampler::apply(const Eigen::MatrixXf& spectra) const
+    {
+        Eigen::MatrixXf out(m_to.count, spectra.cols());
+        apply(spectra, out);
+        return out;
+    }
+
+    void Resampler::apply(const Eigen::Ref<const Eigen::MatrixXf>& spectra, Eigen::Ref<Eigen::MatrixXf> out) const
+    {
+        if (spectra.rows() != m_from.count || out.rows() != m_to.count || out.cols() != spectra.cols())
+        {
+            throw std::runtime_error("Resampler::apply: spectra do not match the source/target grids.");
+        }
+        out.noalias() = m_op * spectra;
+    }
+
+    Eigen::MatrixXf resample(const Eigen::MatrixXf& spectra,
+                             const SpectralGrid& from,
+                             const SpectralGrid& to,
+                             ResampleMethod method)
+    {
+        if (from == to)
+        {
+            return spectra;
+        }
+        return Resampler(from, to, method).apply(spectra);
+    }
+} // namespace css::spectral
@@ -0,0 +1,174 @@
+// Built with -mavx2 -mfma; only called after a runtime CPU check.
+#include "color_kernel_impl.hpp"
+#include "demosaic_impl.hpp"
+#include "lut3d_impl.hpp"
+
+#include <immintrin.h>
+
+namespace css::kernel::detail
+{
+    namespace
+    {
+        struct Avx2
+        {
+            using reg = __m256;
+            using mask = __m256;
+            static constexpr size_t kWidth = 8;
+
+            static reg set1(float v) { return _mm256_set1_ps(v); }
+            static reg load(const float* p) { return _mm256_loadu_ps(p); }
+            static reg gather(const float* base, reg index) { return _mm256_i32gather_ps(base, _mm256_cvttps_epi32(index), 4); }
+            static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+            static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+            static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+            static reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+            static reg madd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+            static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+            static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+            static reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+            static reg floor(reg a) { return _mm256_floor_ps(a); }
+            static mask lt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static mask le(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+            static reg select(mask m, reg a, reg b) { return _mm256_blendv_ps(b, a, m); }
+
+            static reg frexp(reg x, reg& e)
+            {
+                __m256i bits = _mm256_castps_si256(x);
+                e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+                bits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                       _mm256_set1_epi32(0x3f000000));
+                return _mm256_castsi256_ps(bits);
+            }
+
+            static reg ldexp(reg x, reg n)
+            {
+                __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+                return _mm256_mul_ps(x, _mm256_castsi256_ps(scale));
+            }
+
+            // 8 pixels: the 4-pixel SSE shuffles on both 128-bit lanes, with
+            // pixels 0-3 in the low lanes and 4-7 in the high lanes.
+            static void load3(const float* p, reg& c0, reg& c1, reg& c2)
+            {
+                reg m03 = _mm256_castps128_ps256(_mm_loadu_ps(p));
+                reg m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+                reg m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+                m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+                m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+                m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+                const reg xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+                const reg yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+                c0 = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+                c1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+                c2 = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+            }
+
+            static void store3(float* p, reg c0, reg c1, reg c2)
+            {
+                const reg xy = _mm256_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+                const reg yz = _mm256_shuffle_ps(c1, c2, _MM_SHUFFLE(3, 1, 3, 1));
+                const reg zx = _mm256_shuffle_ps(c2, c0, _MM_SHUFFLE(3, 1, 2, 0));
+                const reg m03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+                const reg m14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+                const reg m25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(p, _mm256_castps256_ps128(m03));
+                _mm_storeu_ps(p + 4, _mm256_castps256_ps128(m14));
+                _mm_storeu_ps(p + 8, _mm256_castps256_ps128(m25));
+                _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m03, 1));
+                _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m14, 1));
+                _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m25, 1));
+            }
+        };
+
+        // Sixteen pixels of 16-bit BGR: pixels 0-7 in the low 128-bit lanes,
+        // 8-15 in the high ones, so the per-lane blends and pshufb of the
+        // SSE4.2 kernel carry over unchanged.
+        struct Avx2i
+        {
+            using ireg = __m256i;
+            static constexpr size_t kPixels = 16;
+
+            static ireg set1(std::int16_t v) { return _mm256_set1_epi16(v); }
+            static ireg pair(std::int16_t a, std::int16_t b) { return _mm256_setr_epi16(a, b, a, b, a, b, a, b, a, b, a, b, a, b, a, b); }
+            static ireg minu16(ireg a, ireg b) { return _mm256_min_epu16(a, b); }
+            static ireg srl16(ireg a, int n) { return _mm256_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+            static ireg sra32(ireg a, int n) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+            static ireg unpacklo(ireg a, ireg b) { return _mm256_unpacklo_epi16(a, b); }
+            static ireg unpackhi(ireg a, ireg b) { return _mm256_unpackhi_epi16(a, b); }
+            static ireg madd(ireg a, ireg b) { return _mm256_madd_epi16(a, b); }
+            static ireg add32(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+            static ireg packus32(ireg a, ireg b) { return _mm256_packus_epi32(a, b); }
+
+            static ireg load2(const std::uint16_t* lo, const std::uint16_t* hi)
+            {
+                return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo))),
+                                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)), 1);
+            }
+
+            static void store2(std::uint16_t* lo, std::uint16_t* hi, ireg v)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lo), _mm256_castsi256_si128(v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(hi), _mm256_extracti128_si256(v, 1));
+            }
+
+            static void load3(const std::uint16_t* p, ireg& c0, ireg& c1, ireg& c2)
+            {
+                const ireg a = load2(p, p + 24);
+                const ireg b = load2(p + 8, p + 32);
+                const ireg c = load2(p + 16, p + 40);
+                const ireg s0 = _mm256_setr_epi8(0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11,
+                                                 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11);
+                const ireg s1 = _mm256_setr_epi8(2, 3, 8, 9, 14, 15, 4, 5, 10, 11, 0, 1, 6, 7, 12, 13,
+                                                 2, 3, 8, 9, 14, 15, 4, 5, 10, 11, 0, 1, 6, 7, 12, 13);
+                const ireg s2 = _mm256_setr_epi8(4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15,
+                                                 4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15);
+                c0 = _mm256_shuffle_epi8(_mm256_blend_epi16(_mm256_blend_epi16(a, b, 0x92), c, 0x24), s0);
+                c1 = _mm256_shuffle_epi8(_mm256_blend_epi16(_mm256_blend_epi16(c, a, 0x92), b, 0x24), s1);
+                c2 = _mm256_shuffle_epi8(_mm256_blend_epi16(_mm256_blend_epi16(b, c, 0x92), a, 0x24), s2);
+            }
+
+            static void store3(std::uint16_t* p, ireg c0, ireg c1, ireg c2)
+            {
+                const ireg s0 = _mm256_setr_epi8(0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11,
+                                                 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11);
+                const ireg s1 = _mm256_setr_epi8(10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5,
+                                                 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5);
+                const ireg s2 = _mm256_setr_epi8(4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15,
+                                                 4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15);
+                const ireg t0 = _mm256_shuffle_epi8(c0, s0);
+                const ireg t1 = _mm256_shuffle_epi8(c1, s1);
+                const ireg t2 = _mm256_shuffle_epi8(c2, s2);
+                store2(p, p + 24, _mm256_blend_epi16(_mm256_blend_epi16(t0, t1, 0x92), t2, 0x24));
+                store2(p + 8, p + 32, _mm256_blend_epi16(_mm256_blend_epi16(t2, t0, 0x92), t1, 0x24));
+                store2(p + 16, p + 40, _mm256_blend_epi16(_mm256_blend_epi16(t1, t2, 0x92), t0, 0x24));
+            }
+        };
+    } // namespace
+
+    void applyRowsAvx2(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count)
+    {
+        applyRows<Avx2>(m, terms, e, in, out, count);
+    }
+
+    void applyFixedRowsAvx2(const FixedMatrix& f, const std::uint16_t* in, std::uint16_t* out, size_t count)
+    {
+        applyFixedRows<Avx2i>(f, in, out, count);
+    }
+} // namespace css::kernel::detail
+
+namespace css::demosaic::detail
+{
+    void demosaicRowAvx2(const RowJob& job)
+    {
+        demosaicRow<kernel::detail::Avx2>(job);
+    }
+} // namespace css::demosaic::detail
+
+namespace css::lut::detail
+{
+    void applyLutRowsAvx2(const Grid& grid, const float* in, float* out, size_t count)
+    {
+        applyLutRows<kernel::detail::Avx2>(grid, in, out, count);
+    }
+} // namespace css::lut::detail
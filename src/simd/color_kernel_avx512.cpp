@@ -0,0 +1,132 @@
+// Built with -mavx512f -mavx2 -mfma; only called after a runtime CPU check.
+#include "color_kernel_impl.hpp"
+#include "demosaic_impl.hpp"
+#include "lut3d_impl.hpp"
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC's AVX-512 headers self-initialize their "undefined" placeholder registers.
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+namespace css::kernel::detail
+{
+    namespace
+    {
+        // Deinterleave: channel c of pixel i sits at 3i + c of the 48 floats
+        // held in three registers. Pass 1 picks lanes from the first two
+        // registers, pass 2 the rest from the third (idx 16+ = second operand).
+        alignas(64) constexpr int kGather1[3][16] = {
+            { 0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0 },
+            { 1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0 },
+            { 2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0 },
+        };
+        alignas(64) constexpr int kGather2[3][16] = {
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29 },
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30 },
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31 },
+        };
+
+        // Interleave: output register r lane j is float 16r + j, i.e. channel
+        // (16r + j) % 3 of pixel (16r + j) / 3. Pass 1 takes channels 0 and 1
+        // (planes c0, c1), pass 2 channel 2 (plane c2).
+        alignas(64) constexpr int kScatter1[3][16] = {
+            { 0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5 },
+            { 21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26 },
+            { 0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0 },
+        };
+        alignas(64) constexpr int kScatter2[3][16] = {
+            { 0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15 },
+            { 0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15 },
+            { 26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31 },
+        };
+
+        inline __m512i index(const int* row)
+        {
+            return _mm512_load_si512(row);
+        }
+
+        struct Avx512
+        {
+            using reg = __m512;
+            using mask = __mmask16;
+            static constexpr size_t kWidth = 16;
+
+            static reg set1(float v) { return _mm512_set1_ps(v); }
+            static reg load(const float* p) { return _mm512_loadu_ps(p); }
+            static reg gather(const float* base, reg index) { return _mm512_i32gather_ps(_mm512_cvttps_epi32(index), base, 4); }
+            static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+            static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+            static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+            static reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+            static reg madd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+            static reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+            static reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+            static reg sqrt(reg a) { return _mm512_sqrt_ps(a); }
+            static reg floor(reg a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+            static mask lt(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            static mask le(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+            static reg select(mask m, reg a, reg b) { return _mm512_mask_blend_ps(m, b, a); }
+
+            static reg frexp(reg x, reg& e)
+            {
+                __m512i bits = _mm512_castps_si512(x);
+                e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+                bits = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+                                       _mm512_set1_epi32(0x3f000000));
+                return _mm512_castsi512_ps(bits);
+            }
+
+            static reg ldexp(reg x, reg n)
+            {
+                __m512i scale = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+                return _mm512_mul_ps(x, _mm512_castsi512_ps(scale));
+            }
+
+            static void load3(const float* p, reg& c0, reg& c1, reg& c2)
+            {
+                const reg a = _mm512_loadu_ps(p);
+                const reg b = _mm512_loadu_ps(p + 16);
+                const reg c = _mm512_loadu_ps(p + 32);
+                reg* planes[3] = { &c0, &c1, &c2 };
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    const reg ab = _mm512_permutex2var_ps(a, index(kGather1[ch]), b);
+                    *planes[ch] = _mm512_permutex2var_ps(ab, index(kGather2[ch]), c);
+                }
+            }
+
+            static void store3(float* p, reg c0, reg c1, reg c2)
+            {
+                for (int r = 0; r < 3; ++r)
+                {
+                    const reg xy = _mm512_permutex2var_ps(c0, index(kScatter1[r]), c1);
+                    _mm512_storeu_ps(p + 16 * r, _mm512_permutex2var_ps(xy, index(kScatter2[r]), c2));
+                }
+            }
+        };
+    } // namespace
+
+    void applyRowsAvx512(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count)
+    {
+        applyRows<Avx512>(m, terms, e, in, out, count);
+    }
+} // namespace css::kernel::detail
+
+namespace css::demosaic::detail
+{
+    void demosaicRowAvx512(const RowJob& job)
+    {
+        demosaicRow<kernel::detail::Avx512>(job);
+    }
+} // namespace css::demosaic::detail
+
+namespace css::lut::detail
+{
+    void applyLutRowsAvx512(const Grid& grid, const float* in, float* out, size_t count)
+    {
+        applyLutRows<kernel::detail::Avx512>(grid, in, out, count);
+    }
+} // namespace css::lut::detail
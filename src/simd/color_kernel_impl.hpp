@@ -0,0 +1,371 @@
+#pragma once
+
+// Shared body of the per-ISA color kernels. Each src/simd/color_kernel_<isa>.cpp
+// defines a register wrapper V and instantiates applyRows<V>; those TUs are the
+// only ones built with the ISA's flags, so they include nothing beyond the
+// intrinsics, <cstdint> and <cstring> (inline library code compiled with e.g.
+// -mavx2 could otherwise be picked by the linker for callers on older CPUs).
+//
+// V provides: reg, mask, kWidth, set1, load, add, sub, mul, div, madd (a * b + c),
+// min, max, sqrt, floor, lt, le, select (mask ? a : b), frexp (x = m * 2^e,
+// m in [0.5, 1)), ldexp (x * 2^n, n integral), gather (base[index], index
+// integral), load3 and store3 (interleaved <-> planar).
+//
+// The fixed-point rows use a second wrapper I over 16-bit lanes: ireg, kPixels,
+// set1 (int16), pair (int16 a, b in every 32-bit lane), minu16, srl16 / sra32
+// (runtime count), unpacklo / unpackhi (16-bit), madd (pmaddwd), add32, packus32
+// (saturating to uint16), load3 and store3.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace css::kernel::detail
+{
+    // Mirrors transfer::Curve (checked in src/color_kernel.cpp).
+    enum CurveId : int
+    {
+        kLinear,
+        kSrgb,
+        kRec709,
+        kPQ,
+        kHLG,
+        kGamma
+    };
+
+    struct Encoding
+    {
+        int curve = kLinear;
+        float scale = 1.0f;     // linear value -> curve input (PQ)
+        float exponent = 1.0f;  // Gamma: 1 / gamma
+    };
+
+    // Natural log for normal positive x (Cephes logf).
+    template <class V>
+    inline typename V::reg logV(typename V::reg x)
+    {
+        using reg = typename V::reg;
+        const reg one = V::set1(1.0f);
+
+        reg e;
+        reg m = V::frexp(x, e);
+        const auto small = V::lt(m, V::set1(0.707106781186547524f));
+        e = V::sub(e, V::select(small, one, V::set1(0.0f)));
+        m = V::add(V::sub(m, one), V::select(small, m, V::set1(0.0f)));
+
+        const reg z = V::mul(m, m);
+        reg y = V::set1(7.0376836292e-2f);
+        y = V::madd(y, m, V::set1(-1.1514610310e-1f));
+        y = V::madd(y, m, V::set1(1.1676998740e-1f));
+        y = V::madd(y, m, V::set1(-1.2420140846e-1f));
+        y = V::madd(y, m, V::set1(1.4249322787e-1f));
+        y = V::madd(y, m, V::set1(-1.6668057665e-1f));
+        y = V::madd(y, m, V::set1(2.0000714765e-1f));
+        y = V::madd(y, m, V::set1(-2.4999993993e-1f));
+        y = V::madd(y, m, V::set1(3.3333331174e-1f));
+        y = V::mul(V::mul(y, m), z);
+        y = V::madd(e, V::set1(-2.12194440e-4f), y);
+        y = V::madd(z, V::set1(-0.5f), y);
+        return V::madd(e, V::set1(0.693359375f), V::add(m, y));
+    }
+
+    // e^x for x in [-87, 88] (Cephes expf).
+    template <class V>
+    inline typename V::reg expV(typename V::reg x)
+    {
+        using reg = typename V::reg;
+        const reg n = V::floor(V::madd(x, V::set1(1.44269504088896341f), V::set1(0.5f)));
+        x = V::madd(n, V::set1(-0.693359375f), x);
+        x = V::madd(n, V::set1(2.12194440e-4f), x);
+
+        const reg z = V::mul(x, x);
+        reg y = V::set1(1.9875691500e-4f);
+        y = V::madd(y, x, V::set1(1.3981999507e-3f));
+        y = V::madd(y, x, V::set1(8.3334519073e-3f));
+        y = V::madd(y, x, V::set1(4.1665795894e-2f));
+        y = V::madd(y, x, V::set1(1.6666665459e-1f));
+        y = V::madd(y, x, V::set1(5.0000001201e-1f));
+        y = V::add(V::madd(y, z, x), V::set1(1.0f));
+        return V::ldexp(y, n);
+    }
+
+    // x^p for normal positive x.
+    template <class V>
+    inline typename V::reg powV(typename V::reg x, float p)
+    {
+        return expV<V>(V::mul(logV<V>(x), V::set1(p)));
+    }
+
+    template <class V>
+    inline typename V::reg clamp01(typename V::reg v)
+    {
+        return V::min(V::max(v, V::set1(0.0f)), V::set1(1.0f));
+    }
+
+    // The curves of transfer::encodeReference(). Only lanes past a knee keep
+    // the power branch, so log sees normals only.
+    template <class V>
+    inline typename V::reg srgbV(typename V::reg v)
+    {
+        using reg = typename V::reg;
+        const reg knee = V::set1(0.0031308f);
+        v = clamp01<V>(v);
+        const reg curve = V::madd(powV<V>(V::max(v, knee), 1.0f / 2.4f), V::set1(1.055f), V::set1(-0.055f));
+        return V::select(V::lt(v, knee), V::mul(v, V::set1(12.92f)), curve);
+    }
+
+    template <class V>
+    inline typename V::reg rec709V(typename V::reg v)
+    {
+        using reg = typename V::reg;
+        const reg knee = V::set1(0.018f);
+        v = clamp01<V>(v);
+        const reg curve = V::madd(powV<V>(V::max(v, knee), 0.45f), V::set1(1.099f), V::set1(-0.099f));
+        return V::select(V::lt(v, knee), V::mul(v, V::set1(4.5f)), curve);
+    }
+
+    template <class V>
+    inline typename V::reg gammaV(typename V::reg v, float exponent)
+    {
+        using reg = typename V::reg;
+        const reg zero = V::set1(0.0f);
+        v = clamp01<V>(v);
+        return V::select(V::le(v, zero), zero, powV<V>(V::max(v, V::set1(1e-30f)), exponent));
+    }
+
+    template <class V>
+    inline typename V::reg pqV(typename V::reg v, float scale)
+    {
+        using reg = typename V::reg;
+        const reg zero = V::set1(0.0f);
+        const reg u = clamp01<V>(V::mul(v, V::set1(scale)));
+        const reg one = V::set1(1.0f);
+        reg t = powV<V>(V::max(u, V::set1(1e-30f)), 2610.0f / 16384.0f);
+        t = V::select(V::le(u, zero), zero, t);
+
+        // base = (c1 + c2 t) / (1 + c3 t) = 1 - d with d = (1 - c1)(1 - t) / (1 + c3 t),
+        // as c2 - c3 = 1 - c1. Taking ln(base) from d (log1p via w = 1 - d)
+        // keeps the precision that the 78.8th power would otherwise amplify.
+        const reg d = V::div(V::mul(V::set1(672.0f / 4096.0f), V::sub(one, t)),
+                             V::madd(t, V::set1(2392.0f / 128.0f), one));
+        const reg w = V::sub(one, d);
+        const reg lnBase = V::select(V::lt(d, V::set1(1e-7f)), V::sub(zero, d),
+                                     V::mul(logV<V>(w), V::div(d, V::sub(one, w))));
+        return expV<V>(V::mul(lnBase, V::set1(2523.0f / 32.0f)));
+    }
+
+    template <class V>
+    inline typename V::reg hlgV(typename V::reg v)
+    {
+        using reg = typename V::reg;
+        const float a = 0.17883277f, b = 0.28466892f, c = 0.55991073f;
+        v = clamp01<V>(v);
+        const reg foot = V::sqrt(V::mul(v, V::set1(3.0f)));
+        const reg arg = V::max(V::madd(v, V::set1(12.0f), V::set1(-b)), V::set1(1e-30f));
+        const reg curve = V::madd(logV<V>(arg), V::set1(a), V::set1(c));
+        return V::select(V::le(v, V::set1(1.0f / 12.0f)), foot, curve);
+    }
+
+    // Cube root; lanes <= 0 give 0.
+    template <class V>
+    inline typename V::reg cbrtV(typename V::reg x)
+    {
+        using reg = typename V::reg;
+        const reg zero = V::set1(0.0f);
+        return V::select(V::le(x, zero), zero, powV<V>(V::max(x, V::set1(1e-30f)), 1.0f / 3.0f));
+    }
+
+    // The root terms of profile::rootTerms(), in its order, for Terms = 6
+    // (three square roots) or 13 (plus seven cube-root monomials, built
+    // from three cube roots). Negative inputs count as zero.
+    template <class V, int Terms>
+    inline void rootTermsV(typename V::reg r, typename V::reg g, typename V::reg b, typename V::reg* t)
+    {
+        using reg = typename V::reg;
+        const reg zero = V::set1(0.0f);
+        r = V::max(r, zero);
+        g = V::max(g, zero);
+        b = V::max(b, zero);
+        t[0] = V::sqrt(V::mul(r, g));
+        t[1] = V::sqrt(V::mul(g, b));
+        t[2] = V::sqrt(V::mul(r, b));
+        if constexpr (Terms == 13)
+        {
+            const reg cr = cbrtV<V>(r), cg = cbrtV<V>(g), cb = cbrtV<V>(b);
+            const reg rg = V::mul(cr, cg), gb = V::mul(cg, cb), rb = V::mul(cr, cb);
+            t[3] = V::mul(rg, cg);
+            t[4] = V::mul(gb, cb);
+            t[5] = V::mul(rb, cb);
+            t[6] = V::mul(rg, cr);
+            t[7] = V::mul(gb, cg);
+            t[8] = V::mul(rb, cr);
+            t[9] = V::mul(rg, cb);
+        }
+    }
+
+    // m: 3 x Terms row-major, BGR outputs; columns are the B, G, R inputs and
+    // then the root terms (Terms = 3, 6 or 13). encode: reg -> reg. The term
+    // count is a template argument, so the linear kernel is unchanged and
+    // each root-polynomial order gets its own fully unrolled body.
+    template <class V, int Terms, class Encode>
+    void applyRowsWith(const float* m, Encode encode, const float* in, float* out, size_t count)
+    {
+        using reg = typename V::reg;
+        constexpr size_t W = V::kWidth;
+
+        reg k[3 * Terms];
+        for (int i = 0; i < 3 * Terms; ++i)
+        {
+            k[i] = V::set1(m[i]);
+        }
+
+        auto block = [&](const float* src, float* dst) {
+            reg c[Terms];
+            V::load3(src, c[0], c[1], c[2]);
+            if constexpr (Terms > 3)
+            {
+                rootTermsV<V, Terms>(c[2], c[1], c[0], c + 3);
+            }
+            reg o[3];
+            for (int r = 0; r < 3; ++r)
+            {
+                o[r] = V::mul(k[Terms * r], c[0]);
+                for (int j = 1; j < Terms; ++j)
+                {
+                    o[r] = V::madd(k[Terms * r + j], c[j], o[r]);
+                }
+            }
+            V::store3(dst, encode(o[0]), encode(o[1]), encode(o[2]));
+        };
+
+        size_t i = 0;
+        for (; i + W <= count; i += W)
+        {
+            block(in + 3 * i, out + 3 * i);
+        }
+
+        if (i < count)
+        {
+            float tail[3 * W] = {};
+            const size_t bytes = 3 * (count - i) * sizeof(float);
+            std::memcpy(tail, in + 3 * i, bytes);
+            block(tail, tail);
+            std::memcpy(out + 3 * i, tail, bytes);
+        }
+    }
+
+    template <class V, int Terms>
+    void applyRowsTerms(const float* m, const Encoding& e, const float* in, float* out, size_t count)
+    {
+        using reg = typename V::reg;
+        switch (e.curve)
+        {
+        case kSrgb:
+            applyRowsWith<V, Terms>(m, [](reg v) { return srgbV<V>(v); }, in, out, count);
+            break;
+        case kRec709:
+            applyRowsWith<V, Terms>(m, [](reg v) { return rec709V<V>(v); }, in, out, count);
+            break;
+        case kPQ:
+            applyRowsWith<V, Terms>(m, [&e](reg v) { return pqV<V>(v, e.scale); }, in, out, count);
+            break;
+        case kHLG:
+            applyRowsWith<V, Terms>(m, [](reg v) { return hlgV<V>(v); }, in, out, count);
+            break;
+        case kGamma:
+            applyRowsWith<V, Terms>(m, [&e](reg v) { return gammaV<V>(v, e.exponent); }, in, out, count);
+            break;
+        default:
+            applyRowsWith<V, Terms>(m, [](reg v) { return v; }, in, out, count);
+            break;
+        }
+    }
+
+    // terms: 3 (matrix), 6 or 13 (root polynomial); m as for applyRowsWith.
+    template <class V>
+    void applyRows(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count)
+    {
+        switch (terms)
+        {
+        case 6:
+            applyRowsTerms<V, 6>(m, e, in, out, count);
+            break;
+        case 13:
+            applyRowsTerms<V, 13>(m, e, in, out, count);
+            break;
+        default:
+            applyRowsTerms<V, 3>(m, e, in, out, count);
+            break;
+        }
+    }
+
+    struct FixedMatrix
+    {
+        std::int16_t m[9] = {};         // row-major, Q`fracBits`
+        std::uint16_t inputMax = 0;     // inputs clip here, then shift right
+        int inputShift = 0;
+        int fracBits = 1;
+    };
+
+    // Input codes -> 16-bit linear codes. Each pixel is two pmaddwd per output
+    // channel: (c0, c1) x (m0, m1) and (c2, 1) x (m2, rounding); the clipped,
+    // shifted inputs are below 2^15, and kernel::makeFixedTransform sizes the
+    // coefficients so no 32-bit sum can overflow.
+    template <class I>
+    void applyFixedRows(const FixedMatrix& f, const std::uint16_t* in, std::uint16_t* out, size_t count)
+    {
+        using ireg = typename I::ireg;
+        constexpr size_t W = I::kPixels;
+
+        const std::int16_t rounding = static_cast<std::int16_t>(1 << (f.fracBits - 1));
+        ireg k01[3], k2r[3];
+        for (int r = 0; r < 3; ++r)
+        {
+            k01[r] = I::pair(f.m[3 * r], f.m[3 * r + 1]);
+            k2r[r] = I::pair(f.m[3 * r + 2], rounding);
+        }
+        const ireg one = I::set1(1);
+        const ireg inputMax = I::set1(static_cast<std::int16_t>(f.inputMax));
+
+        auto block = [&](const std::uint16_t* src, std::uint16_t* dst) {
+            ireg c0, c1, c2;
+            I::load3(src, c0, c1, c2);
+            c0 = I::srl16(I::minu16(c0, inputMax), f.inputShift);
+            c1 = I::srl16(I::minu16(c1, inputMax), f.inputShift);
+            c2 = I::srl16(I::minu16(c2, inputMax), f.inputShift);
+            const ireg lo01 = I::unpacklo(c0, c1), hi01 = I::unpackhi(c0, c1);
+            const ireg lo2 = I::unpacklo(c2, one), hi2 = I::unpackhi(c2, one);
+
+            ireg o[3];
+            for (int r = 0; r < 3; ++r)
+            {
+                const ireg lo = I::sra32(I::add32(I::madd(lo01, k01[r]), I::madd(lo2, k2r[r])), f.fracBits);
+                const ireg hi = I::sra32(I::add32(I::madd(hi01, k01[r]), I::madd(hi2, k2r[r])), f.fracBits);
+                o[r] = I::packus32(lo, hi);
+            }
+            I::store3(dst, o[0], o[1], o[2]);
+        };
+
+        size_t i = 0;
+        for (; i + W <= count; i += W)
+        {
+            block(in + 3 * i, out + 3 * i);
+        }
+
+        if (i < count)
+        {
+            std::uint16_t tail[3 * W] = {};
+            const size_t bytes = 3 * (count - i) * sizeof(std::uint16_t);
+            std::memcpy(tail, in + 3 * i, bytes);
+            block(tail, tail);
+            std::memcpy(out + 3 * i, tail, bytes);
+        }
+    }
+
+    void applyRowsSse42(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count);
+    void applyRowsAvx2(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count);
+    void applyRowsAvx512(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count);
+
+    void applyFixedRowsSse42(const FixedMatrix& f, const std::uint16_t* in, std::uint16_t* out, size_t count);
+    void applyFixedRowsAvx2(const FixedMatrix& f, const std::uint16_t* in, std::uint16_t* out, size_t count);
+} // namespace css::kernel::detail
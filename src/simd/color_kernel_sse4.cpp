@@ -0,0 +1,162 @@
+// Built with -msse4.2; only called after a runtime CPU check.
+#include "color_kernel_impl.hpp"
+#include "demosaic_impl.hpp"
+#include "lut3d_impl.hpp"
+
+#include <immintrin.h>
+
+namespace css::kernel::detail
+{
+    namespace
+    {
+        struct Sse42
+        {
+            using reg = __m128;
+            using mask = __m128;
+            static constexpr size_t kWidth = 4;
+
+            static reg set1(float v) { return _mm_set1_ps(v); }
+            static reg load(const float* p) { return _mm_loadu_ps(p); }
+            static reg gather(const float* base, reg index)
+            {
+                alignas(16) std::int32_t i[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(i), _mm_cvttps_epi32(index));
+                return _mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+            }
+            static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+            static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+            static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+            static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+            static reg madd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+            static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+            static reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+            static reg floor(reg a) { return _mm_floor_ps(a); }
+            static mask lt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+            static mask le(reg a, reg b) { return _mm_cmple_ps(a, b); }
+            static reg select(mask m, reg a, reg b) { return _mm_blendv_ps(b, a, m); }
+
+            static reg frexp(reg x, reg& e)
+            {
+                __m128i bits = _mm_castps_si128(x);
+                e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+                bits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000));
+                return _mm_castsi128_ps(bits);
+            }
+
+            static reg ldexp(reg x, reg n)
+            {
+                __m128i scale = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23);
+                return _mm_mul_ps(x, _mm_castsi128_ps(scale));
+            }
+
+            // p: c0 c1 c2 c0 c1 c2 ... (4 pixels)
+            static void load3(const float* p, reg& c0, reg& c1, reg& c2)
+            {
+                const reg m03 = _mm_loadu_ps(p);     // a0 b0 c0 a1
+                const reg m14 = _mm_loadu_ps(p + 4); // b1 c1 a2 b2
+                const reg m25 = _mm_loadu_ps(p + 8); // c2 a3 b3 c3
+                const reg xy = _mm_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2)); // a2 b2 a3 b3
+                const reg yz = _mm_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1)); // b0 c0 b1 c1
+                c0 = _mm_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+                c1 = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+                c2 = _mm_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+            }
+
+            static void store3(float* p, reg c0, reg c1, reg c2)
+            {
+                const reg xy = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0)); // a0 a2 b0 b2
+                const reg yz = _mm_shuffle_ps(c1, c2, _MM_SHUFFLE(3, 1, 3, 1)); // b1 b3 c1 c3
+                const reg zx = _mm_shuffle_ps(c2, c0, _MM_SHUFFLE(3, 1, 2, 0)); // c0 c2 a1 a3
+                _mm_storeu_ps(p, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+                _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+        };
+
+        // Eight pixels of 16-bit BGR in three registers; blends gather each
+        // channel (in a rotated lane order), pshufb puts it in pixel order.
+        struct Sse42i
+        {
+            using ireg = __m128i;
+            static constexpr size_t kPixels = 8;
+
+            static ireg set1(std::int16_t v) { return _mm_set1_epi16(v); }
+            static ireg pair(std::int16_t a, std::int16_t b) { return _mm_setr_epi16(a, b, a, b, a, b, a, b); }
+            static ireg minu16(ireg a, ireg b) { return _mm_min_epu16(a, b); }
+            static ireg srl16(ireg a, int n) { return _mm_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+            static ireg sra32(ireg a, int n) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+            static ireg unpacklo(ireg a, ireg b) { return _mm_unpacklo_epi16(a, b); }
+            static ireg unpackhi(ireg a, ireg b) { return _mm_unpackhi_epi16(a, b); }
+            static ireg madd(ireg a, ireg b) { return _mm_madd_epi16(a, b); }
+            static ireg add32(ireg a, ireg b) { return _mm_add_epi32(a, b); }
+            static ireg packus32(ireg a, ireg b) { return _mm_packus_epi32(a, b); }
+
+            // a: b0 g0 r0 b1 g1 r1 b2 g2, b: r2 b3 g3 r3 b4 g4 r4 b5, c: g5 r5 b6 g6 r6 b7 g7 r7
+            static void deinterleave(ireg a, ireg b, ireg c, ireg& c0, ireg& c1, ireg& c2)
+            {
+                const ireg s0 = _mm_setr_epi8(0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11);
+                const ireg s1 = _mm_setr_epi8(2, 3, 8, 9, 14, 15, 4, 5, 10, 11, 0, 1, 6, 7, 12, 13);
+                const ireg s2 = _mm_setr_epi8(4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15);
+                c0 = _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(a, b, 0x92), c, 0x24), s0);
+                c1 = _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(c, a, 0x92), b, 0x24), s1);
+                c2 = _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(b, c, 0x92), a, 0x24), s2);
+            }
+
+            static void interleave(ireg c0, ireg c1, ireg c2, ireg& a, ireg& b, ireg& c)
+            {
+                const ireg s0 = _mm_setr_epi8(0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11);
+                const ireg s1 = _mm_setr_epi8(10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5);
+                const ireg s2 = _mm_setr_epi8(4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15);
+                const ireg t0 = _mm_shuffle_epi8(c0, s0);
+                const ireg t1 = _mm_shuffle_epi8(c1, s1);
+                const ireg t2 = _mm_shuffle_epi8(c2, s2);
+                a = _mm_blend_epi16(_mm_blend_epi16(t0, t1, 0x92), t2, 0x24);
+                b = _mm_blend_epi16(_mm_blend_epi16(t2, t0, 0x92), t1, 0x24);
+                c = _mm_blend_epi16(_mm_blend_epi16(t1, t2, 0x92), t0, 0x24);
+            }
+
+            static void load3(const std::uint16_t* p, ireg& c0, ireg& c1, ireg& c2)
+            {
+                deinterleave(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), c0, c1, c2);
+            }
+
+            static void store3(std::uint16_t* p, ireg c0, ireg c1, ireg c2)
+            {
+                ireg a, b, c;
+                interleave(c0, c1, c2, a, b, c);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 8), b);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 16), c);
+            }
+        };
+    } // namespace
+
+    void applyRowsSse42(const float* m, int terms, const Encoding& e, const float* in, float* out, size_t count)
+    {
+        applyRows<Sse42>(m, terms, e, in, out, count);
+    }
+
+    void applyFixedRowsSse42(const FixedMatrix& f, const std::uint16_t* in, std::uint16_t* out, size_t count)
+    {
+        applyFixedRows<Sse42i>(f, in, out, count);
+    }
+} // namespace css::kernel::detail
+
+namespace css::demosaic::detail
+{
+    void demosaicRowSse42(const RowJob& job)
+    {
+        demosaicRow<kernel::detail::Sse42>(job);
+    }
+} // namespace css::demosaic::detail
+
+namespace css::lut::detail
+{
+    void applyLutRowsSse42(const Grid& grid, const float* in, float* out, size_t count)
+    {
+        applyLutRows<kernel::detail::Sse42>(grid, in, out, count);
+    }
+} // namespace css::lut::detail
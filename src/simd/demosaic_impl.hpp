@@ -0,0 +1,119 @@
+#pragma once
+
+// Shared body of the per-ISA demosaic kernels, instantiated in the
+// src/simd/color_kernel_<isa>.cpp TUs with their register wrappers V (see
+// color_kernel_impl.hpp for the V operations and the include rules).
+
+#include <cstddef>
+#include <cstring>
+
+namespace css::demosaic::detail
+{
+    // Widest vector, in floats: rows must stay readable this far past
+    // count + 4 so the last block needs no bounds checks.
+    constexpr size_t kRowSlack = 16;
+
+    // One output row. The five input rows are y-2 .. y+2, already black
+    // subtracted and scaled, each starting two samples left of the first
+    // output pixel. Every row of a Bayer mosaic alternates green with one
+    // other color X; xChannel is X's index in BGR (0 or 2), xAt the parity
+    // of the X sites relative to the first output pixel.
+    struct RowJob
+    {
+        const float* rows[5] = {};
+        float* out = nullptr;  // count interleaved BGR pixels
+        size_t count = 0;
+        int xAt = 0;
+        int xChannel = 0;
+        bool mhc = true;
+    };
+
+    // Neighbor sums around each pixel give every estimate: at an X site,
+    // G = K1 and the opposite color Y = K4; at a green site, X = K2 (from
+    // the row) and Y = K3 (from the column). Malvar-He-Cutler adds the
+    // Laplacian of the center channel to the bilinear estimates.
+    template <class V>
+    void demosaicRow(const RowJob& job)
+    {
+        using reg = typename V::reg;
+        constexpr size_t W = V::kWidth;
+
+        static const float alternate[32] = {1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+                                            1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0};
+        const auto isX = V::lt(V::set1(0.5f), V::load(alternate + job.xAt));
+        const reg zero = V::set1(0.0f);
+        const reg eighth = V::set1(0.125f);
+        const reg quarter = V::set1(0.25f);
+        const reg half = V::set1(0.5f);
+        const reg two = V::set1(2.0f);
+        const reg four = V::set1(4.0f);
+        const reg six = V::set1(6.0f);
+        const reg minusThreeHalves = V::set1(-1.5f);
+
+        const float* r0 = job.rows[0];
+        const float* r1 = job.rows[1];
+        const float* r2 = job.rows[2];
+        const float* r3 = job.rows[3];
+        const float* r4 = job.rows[4];
+
+        auto block = [&](size_t i, float* dst) {
+            const reg c = V::load(r2 + i + 2);
+            const reg h1 = V::add(V::load(r2 + i + 1), V::load(r2 + i + 3));
+            const reg v1 = V::add(V::load(r1 + i + 2), V::load(r3 + i + 2));
+            const reg d1 = V::add(V::add(V::load(r1 + i + 1), V::load(r1 + i + 3)),
+                                  V::add(V::load(r3 + i + 1), V::load(r3 + i + 3)));
+            reg k1, k2, k3, k4;
+            if (job.mhc)
+            {
+                const reg h2 = V::add(V::load(r2 + i), V::load(r2 + i + 4));
+                const reg v2 = V::add(V::load(r0 + i + 2), V::load(r4 + i + 2));
+                const reg c4 = V::mul(four, c);
+                const reg c5 = V::add(c4, c);
+                k1 = V::sub(V::madd(two, V::add(h1, v1), c4), V::add(h2, v2));
+                k2 = V::madd(half, v2, V::sub(V::madd(four, h1, c5), V::add(h2, d1)));
+                k3 = V::madd(half, h2, V::sub(V::madd(four, v1, c5), V::add(v2, d1)));
+                k4 = V::madd(minusThreeHalves, V::add(h2, v2), V::madd(two, d1, V::mul(six, c)));
+                k1 = V::mul(k1, eighth);
+                k2 = V::mul(k2, eighth);
+                k3 = V::mul(k3, eighth);
+                k4 = V::mul(k4, eighth);
+            }
+            else
+            {
+                k1 = V::mul(V::add(h1, v1), quarter);
+                k2 = V::mul(h1, half);
+                k3 = V::mul(v1, half);
+                k4 = V::mul(d1, quarter);
+            }
+
+            const reg x = V::max(V::select(isX, c, k2), zero);
+            const reg g = V::max(V::select(isX, k1, c), zero);
+            const reg y = V::max(V::select(isX, k4, k3), zero);
+            if (job.xChannel == 0)
+            {
+                V::store3(dst, x, g, y);
+            }
+            else
+            {
+                V::store3(dst, y, g, x);
+            }
+        };
+
+        size_t i = 0;
+        for (; i + W <= job.count; i += W)
+        {
+            block(i, job.out + 3 * i);
+        }
+
+        if (i < job.count)
+        {
+            float tail[3 * W];
+            block(i, tail);
+            std::memcpy(job.out + 3 * i, tail, 3 * (job.count - i) * sizeof(float));
+        }
+    }
+
+    void demosaicRowSse42(const RowJob& job);
+    void demosaicRowAvx2(const RowJob& job);
+    void demosaicRowAvx512(const RowJob& job);
+} // namespace css::demosaic::detail
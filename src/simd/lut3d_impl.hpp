@@ -0,0 +1,99 @@
+#pragma once
+
+// Shared body of the per-ISA 3D LUT kernels, instantiated in the
+// src/simd/color_kernel_<isa>.cpp TUs with their register wrappers V (see
+// color_kernel_impl.hpp for the V operations and the include rules).
+
+#include <cstddef>
+#include <cstring>
+
+namespace css::lut::detail
+{
+    // size^3 BGR entries, red index fastest.
+    struct Grid
+    {
+        const float* table = nullptr;
+        int size = 0;
+    };
+
+    // Tetrahedral interpolation of `count` interleaved BGR grid coordinates
+    // in [0, 1] (clamped; NaN -> 0). The cube around a point splits into six
+    // tetrahedra along its main diagonal; sorting the fractions picks one,
+    // and the point is a blend of its four corners: the cell origin, one
+    // step along the largest fraction, one more along the middle one, and
+    // the diagonal corner. Table offsets are carried as exact float integers.
+    template <class V>
+    void applyLutRows(const Grid& grid, const float* in, float* out, size_t count)
+    {
+        using reg = typename V::reg;
+        constexpr size_t W = V::kWidth;
+
+        const float n = static_cast<float>(grid.size);
+        const reg zero = V::set1(0.0f);
+        const reg one = V::set1(1.0f);
+        const reg last = V::set1(n - 1.0f);
+        const reg lastCell = V::set1(n - 2.0f);
+        const reg sr = V::set1(3.0f);
+        const reg sg = V::set1(3.0f * n);
+        const reg sb = V::set1(3.0f * n * n);
+        const reg diagonal = V::set1(3.0f + 3.0f * n + 3.0f * n * n);
+        const float* t0 = grid.table;
+        const float* t1 = grid.table + 1;
+        const float* t2 = grid.table + 2;
+
+        auto block = [&](const float* src, float* dst) {
+            reg b, g, r;
+            V::load3(src, b, g, r);
+            b = V::min(V::max(V::mul(b, last), zero), last);
+            g = V::min(V::max(V::mul(g, last), zero), last);
+            r = V::min(V::max(V::mul(r, last), zero), last);
+            const reg ib = V::min(V::floor(b), lastCell);
+            const reg ig = V::min(V::floor(g), lastCell);
+            const reg ir = V::min(V::floor(r), lastCell);
+            const reg fb = V::sub(b, ib);
+            const reg fg = V::sub(g, ig);
+            const reg fr = V::sub(r, ir);
+            const reg base = V::mul(sr, V::madd(ib, V::set1(n * n), V::madd(ig, V::set1(n), ir)));
+
+            const reg hi = V::max(fr, V::max(fg, fb));
+            const reg lo = V::min(fr, V::min(fg, fb));
+            const reg mid = V::sub(V::add(fr, V::add(fg, fb)), V::add(hi, lo));
+            const reg first = V::select(V::le(fg, fr), V::select(V::le(fb, fr), sr, sb), V::select(V::le(fb, fg), sg, sb));
+            const reg least = V::select(V::le(fr, fg), V::select(V::le(fr, fb), sr, sb), V::select(V::le(fg, fb), sg, sb));
+
+            const reg w0 = V::sub(one, hi);
+            const reg w1 = V::sub(hi, mid);
+            const reg w2 = V::sub(mid, lo);
+            const reg i1 = V::add(base, first);
+            const reg i2 = V::sub(V::add(base, diagonal), least);
+            const reg i3 = V::add(base, diagonal);
+
+            auto corners = [&](const float* t) {
+                reg v = V::mul(w0, V::gather(t, base));
+                v = V::madd(w1, V::gather(t, i1), v);
+                v = V::madd(w2, V::gather(t, i2), v);
+                return V::madd(lo, V::gather(t, i3), v);
+            };
+            V::store3(dst, corners(t0), corners(t1), corners(t2));
+        };
+
+        size_t i = 0;
+        for (; i + W <= count; i += W)
+        {
+            block(in + 3 * i, out + 3 * i);
+        }
+
+        if (i < count)
+        {
+            float tail[3 * W] = {};
+            const size_t bytes = 3 * (count - i) * sizeof(float);
+            std::memcpy(tail, in + 3 * i, bytes);
+            block(tail, tail);
+            std::memcpy(out + 3 * i, tail, bytes);
+        }
+    }
+
+    void applyLutRowsSse42(const Grid& grid, const float* in, float* out, size_t count);
+    void applyLutRowsAvx2(const Grid& grid, const float* in, float* out, size_t count);
+    void applyLutRowsAvx512(const Grid& grid, const float* in, float* out, size_t count);
+} // namespace css::lut::detail
@@ -1,5 +1,9 @@
 #include "css/spectral.hpp"
+#include "css/parallel.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -99,5 +103,103 @@ namespace css::spectral
                 << sample.rgbResponse.z() << "\n";
         }
     }
+
+    Eigen::MatrixXf toMatrix(const SpectralSensitivity& sens,
+                             const SpectralGrid& grid,
+                             ResampleMethod method)
+    {
+        const int n = static_cast<int>(sens.samples.size());
+        if (n == 0)
+        {
+            throw std::runtime_error("toMatrix: no spectral samples");
+        }
+
+        SpectralGrid source;
+        source.start = sens.samples.front().wavelengthNm;
+        source.step = n > 1 ? (sens.samples.back().wavelengthNm - source.start) / static_cast<float>(n - 1) : 1.0f;
+        source.count = n;
+
+        Eigen::MatrixXf curves(n, 3);
+        for (int i = 0; i < n; ++i)
+        {
+            if (std::abs(sens.samples[i].wavelengthNm - source.wavelength(i)) > 1e-2f * source.step)
+            {
+                throw std::runtime_error("toMatrix: spectral samples are not uniformly spaced");
+            }
+            curves.row(i) = sens.samples[i].rgbResponse;
+        }
+
+        return resample(curves, source, grid, method);
+    }
+
+    std::vector<Eigen::MatrixXf> loadSensitivityDirectory(const std::string& directory,
+                                                          const SpectralGrid& grid,
+                                                          std::vector<std::string>* names,
+                                                          std::vector<std::string>* skipped)
+    {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(directory))
+        {
+            throw std::runtime_error("Not a directory: " + directory);
+        }
+
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".csv")
+            {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<Eigen::MatrixXf> loaded(files.size());
+        std::vector<std::string> errors(files.size());
+        parallel::parallelFor(files.size(), [&](size_t i) {
+            try
+            {
+                loaded[i] = toMatrix(loadSpectralSensitivityCsv(files[i].string()), grid);
+            }
+            catch (const std::exception& e)
+            {
+                errors[i] = files[i].string() + ": " + e.what();
+            }
+        });
+
+        std::vector<Eigen::MatrixXf> curves;
+        curves.reserve(files.size());
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                if (skipped) skipped->push_back(errors[i]);
+                continue;
+            }
+            curves.push_back(std::move(loaded[i]));
+            if (names) names->push_back(files[i].stem().string());
+        }
+        return curves;
+    }
+
+    SpectralSensitivity fromMatrix(const Eigen::MatrixXf& curves,
+                                   const SpectralGrid& grid,
+                                   const std::string& cameraName)
+    {
+        if (curves.rows() != grid.count || curves.cols() != 3)
+        {
+            throw std::runtime_error("fromMatrix: curves do not match the spectral grid");
+        }
+
+        SpectralSensitivity sens;
+        sens.cameraName = cameraName;
+        for (int i = 0; i < grid.count; ++i)
+        {
+            SpectralSample s;
+            s.wavelengthNm = grid.wavelength(i);
+            s.rgbResponse = curves.row(i);
+            sens.samples.push_back(s);
+        }
+        return sens;
+    }
 } // namespace css::spectral
 
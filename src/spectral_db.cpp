@@ -0,0 +1,342 @@
+#include "css/spectral_db.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+namespace css::spectral
+{
+    namespace
+    {
+        constexpr char kMagic[8] = {'C', 'S', 'S', 'P', 'E', 'C', 'D', 'B'};
+        constexpr std::uint32_t kVersion = 1;
+
+        // On-disk layout (little-endian). All offsets are from the start of the file.
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t headerBytes;
+            std::uint32_t datasets;
+            std::uint32_t entryBytes;
+            std::uint64_t fileBytes;
+            std::uint64_t contentHash;  // FNV-1a 64 of bytes [headerBytes, fileBytes)
+            std::uint8_t reserved[24];
+        };
+        static_assert(sizeof(FileHeader) == 64, "spectral database header must stay 64 bytes");
+
+        struct DirEntry
+        {
+            char name[64];              // NUL-terminated
+            std::uint32_t kind;
+            std::int32_t channels;
+            float gridStart;
+            float gridStep;
+            std::int32_t gridCount;
+            std::uint32_t reserved;
+            std::uint64_t items;
+            std::uint64_t dataOffset;         // float[gridCount * items * channels], 64-byte aligned
+            std::uint64_t namesOffset;        // concatenated item names
+            std::uint64_t nameOffsetsOffset;  // uint64[items + 1] into the names blob
+            std::uint64_t sortedOffset;       // uint32[items], item ids ordered by name
+        };
+        static_assert(sizeof(DirEntry) == 128, "spectral database entry must stay 128 bytes");
+
+        void align(std::vector<unsigned char>& buf, size_t to)
+        {
+            buf.resize((buf.size() + to - 1) / to * to, 0);
+        }
+
+        template <typename T>
+        std::uint64_t append(std::vector<unsigned char>& buf, const T* data, size_t count)
+        {
+            std::uint64_t offset = buf.size();
+            const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+            buf.insert(buf.end(), bytes, bytes + count * sizeof(T));
+            return offset;
+        }
+
+        std::string_view nameOf(const std::uint64_t* offsets, const char* names, std::uint32_t i)
+        {
+            return std::string_view(names + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]));
+        }
+    } // namespace
+
+    void saveSpectralDatabase(const std::string& path, const std::vector<Dataset>& datasets)
+    {
+        std::vector<unsigned char> buf(sizeof(FileHeader) + datasets.size() * sizeof(DirEntry), 0);
+        std::vector<DirEntry> entries(datasets.size());
+
+        std::set<std::string> seen;
+        for (size_t d = 0; d < datasets.size(); ++d)
+        {
+            const Dataset& ds = datasets[d];
+            if (ds.name.empty() || ds.name.size() >= sizeof(DirEntry::name) || !seen.insert(ds.name).second)
+            {
+                throw std::runtime_error("saveSpectralDatabase: dataset names must be unique and 1-63 chars: " + ds.name);
+            }
+            const Eigen::Index items = static_cast<Eigen::Index>(ds.items.size());
+            if (ds.channels <= 0 || ds.data.rows() != ds.grid.count || ds.data.cols() != items * ds.channels)
+            {
+                throw std::runtime_error("saveSpectralDatabase: data of " + ds.name + " must be grid.count x items*channels");
+            }
+
+            DirEntry& e = entries[d];
+            std::memset(&e, 0, sizeof(e));
+            std::memcpy(e.name, ds.name.data(), ds.name.size());
+            e.kind = static_cast<std::uint32_t>(ds.kind);
+            e.channels = ds.channels;
+            e.gridStart = ds.grid.start;
+            e.gridStep = ds.grid.step;
+            e.gridCount = ds.grid.count;
+            e.items = static_cast<std::uint64_t>(items);
+
+            align(buf, 64);
+            e.dataOffset = append(buf, ds.data.data(), static_cast<size_t>(ds.data.size()));
+
+            std::vector<std::uint64_t> offsets(ds.items.size() + 1, 0);
+            std::string blob;
+            for (size_t i = 0; i < ds.items.size(); ++i)
+            {
+                blob += ds.items[i];
+                offsets[i + 1] = blob.size();
+            }
+            e.namesOffset = append(buf, blob.data(), blob.size());
+
+            std::vector<std::uint32_t> sorted(ds.items.size());
+            std::iota(sorted.begin(), sorted.end(), 0u);
+            std::sort(sorted.begin(), sorted.end(), [&](std::uint32_t a, std::uint32_t b) {
+                return ds.items[a] < ds.items[b];
+            });
+            for (size_t i = 1; i < sorted.size(); ++i)
+            {
+                if (ds.items[sorted[i]] == ds.items[sorted[i - 1]])
+                {
+                    throw std::runtime_error("saveSpectralDatabase: duplicate item '" + ds.items[sorted[i]] + "' in " + ds.name);
+                }
+            }
+
+            align(buf, 8);
+            e.nameOffsetsOffset = append(buf, offsets.data(), offsets.size());
+            e.sortedOffset = append(buf, sorted.data(), sorted.size());
+        }
+
+        std::memcpy(buf.data() + sizeof(FileHeader), entries.data(), entries.size() * sizeof(DirEntry));
+
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.headerBytes = sizeof(FileHeader);
+        header.datasets = static_cast<std::uint32_t>(datasets.size());
+        header.entryBytes = sizeof(DirEntry);
+        header.fileBytes = buf.size();
+        header.contentHash = io::fnv1a64(buf.data() + sizeof(FileHeader), buf.size() - sizeof(FileHeader));
+        std::memcpy(buf.data(), &header, sizeof(header));
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+        {
+            throw std::runtime_error("Failed to open spectral database for writing: " + path);
+        }
+        out.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write spectral database: " + path);
+        }
+    }
+
+    bool isSpectralDatabase(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(magic)) == 0;
+    }
+
+    SpectralDatabase::SpectralDatabase(const std::string& path, bool verifyHash)
+        : m_file(path)
+    {
+        FileHeader header;
+        if (m_file.size() < sizeof(header))
+        {
+            throw std::runtime_error("Spectral database file too small: " + path);
+        }
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            throw std::runtime_error("Not a spectral database: " + path);
+        }
+        if (header.version != kVersion || header.headerBytes != sizeof(FileHeader) || header.entryBytes != sizeof(DirEntry))
+        {
+            throw std::runtime_error("Unsupported spectral database version in " + path);
+        }
+        if (header.fileBytes != m_file.size() ||
+            sizeof(FileHeader) + static_cast<std::uint64_t>(header.datasets) * sizeof(DirEntry) > m_file.size())
+        {
+            throw std::runtime_error("Truncated spectral database: " + path);
+        }
+        if (verifyHash &&
+            io::fnv1a64(m_file.data() + sizeof(FileHeader), m_file.size() - sizeof(FileHeader)) != header.contentHash)
+        {
+            throw std::runtime_error("Spectral database content hash mismatch in " + path);
+        }
+        m_hash = header.contentHash;
+
+        const unsigned char* base = m_file.data();
+        auto inFile = [&](std::uint64_t offset, std::uint64_t bytes) {
+            return offset <= m_file.size() && bytes <= m_file.size() - offset;
+        };
+
+        m_entries.reserve(header.datasets);
+        for (std::uint32_t d = 0; d < header.datasets; ++d)
+        {
+            DirEntry e;
+            std::memcpy(&e, base + sizeof(FileHeader) + d * sizeof(DirEntry), sizeof(e));
+            e.name[sizeof(e.name) - 1] = '\0';
+
+            // Bounding items by the file size keeps the byte counts below from overflowing.
+            const std::uint64_t floats = static_cast<std::uint64_t>(e.gridCount) * e.items * static_cast<std::uint64_t>(e.channels);
+            if (e.gridCount <= 0 || e.channels <= 0 || e.items > m_file.size() ||
+                e.dataOffset % alignof(float) != 0 || e.nameOffsetsOffset % alignof(std::uint64_t) != 0 ||
+                e.sortedOffset % alignof(std::uint32_t) != 0 ||
+                !inFile(e.dataOffset, floats * sizeof(float)) ||
+                !inFile(e.nameOffsetsOffset, (e.items + 1) * sizeof(std::uint64_t)) ||
+                !inFile(e.sortedOffset, e.items * sizeof(std::uint32_t)))
+            {
+                throw std::runtime_error("Corrupt dataset entry in spectral database: " + path);
+            }
+
+            Entry entry;
+            entry.name = e.name;
+            entry.kind = static_cast<DatasetKind>(e.kind);
+            entry.grid.start = e.gridStart;
+            entry.grid.step = e.gridStep;
+            entry.grid.count = e.gridCount;
+            entry.channels = e.channels;
+            entry.items = static_cast<Eigen::Index>(e.items);
+            entry.data = reinterpret_cast<const float*>(base + e.dataOffset);
+            entry.nameOffsets = reinterpret_cast<const std::uint64_t*>(base + e.nameOffsetsOffset);
+            entry.names = reinterpret_cast<const char*>(base + e.namesOffset);
+            entry.sorted = reinterpret_cast<const std::uint32_t*>(base + e.sortedOffset);
+
+            // One pass over the index so lookups never leave the names blob or the items.
+            for (std::uint64_t i = 0; i < e.items; ++i)
+            {
+                if (entry.nameOffsets[i] > entry.nameOffsets[i + 1] || entry.sorted[i] >= e.items)
+                {
+                    throw std::runtime_error("Corrupt dataset entry in spectral database: " + path);
+                }
+            }
+            if (!inFile(e.namesOffset, entry.nameOffsets[e.items]))
+            {
+                throw std::runtime_error("Corrupt item names in spectral database: " + path);
+            }
+            m_entries.push_back(std::move(entry));
+        }
+    }
+
+    SpectralDatabase::View SpectralDatabase::dataset(size_t index) const
+    {
+        if (index >= m_entries.size())
+        {
+            throw std::runtime_error("SpectralDatabase: dataset index out of range");
+        }
+        return View(this, index);
+    }
+
+    SpectralDatabase::View SpectralDatabase::dataset(const std::string& name) const
+    {
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].name == name)
+            {
+                return View(this, i);
+            }
+        }
+        throw std::runtime_error("SpectralDatabase: no dataset named " + name);
+    }
+
+    bool SpectralDatabase::hasDataset(const std::string& name) const
+    {
+        return std::any_of(m_entries.begin(), m_entries.end(), [&](const Entry& e) { return e.name == name; });
+    }
+
+    SpectralDatabase::View SpectralDatabase::first(DatasetKind kind) const
+    {
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].kind == kind)
+            {
+                return View(this, i);
+            }
+        }
+        throw std::runtime_error("SpectralDatabase: no dataset of the requested kind");
+    }
+
+    SpectralDatabase::ConstMap SpectralDatabase::camera(std::string_view camera, SpectralGrid* grid) const
+    {
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].kind != DatasetKind::Sensitivity)
+                continue;
+
+            View view(this, i);
+            Eigen::Index item = view.find(camera);
+            if (item >= 0)
+            {
+                if (grid) *grid = view.grid();
+                return view.item(item);
+            }
+        }
+        throw std::runtime_error("SpectralDatabase: no camera named " + std::string(camera));
+    }
+
+    const std::string& SpectralDatabase::View::name() const { return m_db->m_entries[m_index].name; }
+    DatasetKind SpectralDatabase::View::kind() const { return m_db->m_entries[m_index].kind; }
+    const SpectralGrid& SpectralDatabase::View::grid() const { return m_db->m_entries[m_index].grid; }
+    int SpectralDatabase::View::channels() const { return m_db->m_entries[m_index].channels; }
+    Eigen::Index SpectralDatabase::View::size() const { return m_db->m_entries[m_index].items; }
+
+    SpectralDatabase::ConstMap SpectralDatabase::View::matrix() const
+    {
+        const Entry& e = m_db->m_entries[m_index];
+        return ConstMap(e.data, e.grid.count, e.items * e.channels);
+    }
+
+    SpectralDatabase::ConstMap SpectralDatabase::View::item(Eigen::Index i) const
+    {
+        const Entry& e = m_db->m_entries[m_index];
+        if (i < 0 || i >= e.items)
+        {
+            throw std::runtime_error("SpectralDatabase: item index out of range in " + e.name);
+        }
+        return ConstMap(e.data + i * e.channels * e.grid.count, e.grid.count, e.channels);
+    }
+
+    std::string_view SpectralDatabase::View::itemName(Eigen::Index i) const
+    {
+        const Entry& e = m_db->m_entries[m_index];
+        if (i < 0 || i >= e.items)
+        {
+            throw std::runtime_error("SpectralDatabase: item index out of range in " + e.name);
+        }
+        return nameOf(e.nameOffsets, e.names, static_cast<std::uint32_t>(i));
+    }
+
+    Eigen::Index SpectralDatabase::View::find(std::string_view itemName) const
+    {
+        const Entry& e = m_db->m_entries[m_index];
+        const std::uint32_t* begin = e.sorted;
+        const std::uint32_t* end = e.sorted + e.items;
+        const std::uint32_t* it = std::lower_bound(begin, end, itemName, [&](std::uint32_t id, std::string_view key) {
+            return nameOf(e.nameOffsets, e.names, id) < key;
+        });
+        if (it != end && nameOf(e.nameOffsets, e.names, *it) == itemName)
+        {
+            return static_cast<Eigen::Index>(*it);
+        }
+        return -1;
+    }
+} // namespace css::spectral
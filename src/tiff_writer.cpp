@@ -0,0 +1,190 @@
+#include "css/tiff_writer.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace css::io
+{
+    namespace
+    {
+        // TIFF field types.
+        constexpr std::uint16_t kShort = 3;
+        constexpr std::uint16_t kLong = 4;
+
+        // Little-endian byte image of the header, IFD and tables.
+        struct ByteWriter
+        {
+            std::vector<unsigned char> bytes;
+
+            void u16(std::uint32_t v)
+            {
+                bytes.push_back(static_cast<unsigned char>(v));
+                bytes.push_back(static_cast<unsigned char>(v >> 8));
+            }
+
+            void u32(std::uint32_t v)
+            {
+                u16(v & 0xffff);
+                u16(v >> 16);
+            }
+
+            // One IFD entry; `value` is the value itself when it fits in 4 bytes.
+            void entry(std::uint16_t tag, std::uint16_t type, std::uint32_t count, std::uint32_t value)
+            {
+                u16(tag);
+                u16(type);
+                u32(count);
+                if (type == kShort && count == 1)
+                {
+                    u16(value);
+                    u16(0);
+                }
+                else
+                {
+                    u32(value);
+                }
+            }
+        };
+
+        bool seekTo(std::FILE* file, std::uint64_t offset)
+        {
+#ifdef _WIN32
+            return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+            return std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+#endif
+        }
+    } // namespace
+
+    TiledTiffWriter::TiledTiffWriter(const std::string& path, int width, int height, int bitsPerSample,
+                                     int tileWidth, int tileHeight)
+        : m_path(path), m_width(width), m_height(height), m_bitsPerSample(bitsPerSample),
+          m_tileWidth(tileWidth), m_tileHeight(tileHeight)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            throw std::runtime_error("TIFF image must not be empty: " + path);
+        }
+        if (bitsPerSample != 8 && bitsPerSample != 16)
+        {
+            throw std::runtime_error("TIFF writer supports 8- and 16-bit samples only");
+        }
+        if (tileWidth <= 0 || tileHeight <= 0 || tileWidth % 16 != 0 || tileHeight % 16 != 0)
+        {
+            throw std::runtime_error("TIFF tile size must be a positive multiple of 16");
+        }
+
+        const std::uint32_t tiles = static_cast<std::uint32_t>(tilesAcross()) * static_cast<std::uint32_t>(tilesDown());
+        const std::uint16_t entries = 11;
+        const std::uint32_t ifdOffset = 8;
+        const std::uint32_t bitsOffset = ifdOffset + 2 + 12u * entries + 4;
+        const std::uint32_t offsetsOffset = bitsOffset + 6 + 2; // keep the tables word-aligned
+        const std::uint32_t countsOffset = offsetsOffset + 4 * tiles;
+        m_dataOffset = countsOffset + 4 * tiles;
+        if (static_cast<double>(m_dataOffset) + static_cast<double>(tileBytes()) * tiles > 4294967295.0)
+        {
+            throw std::runtime_error("Image too large for a classic TIFF: " + path);
+        }
+
+        ByteWriter w;
+        w.u16(0x4949); // "II"
+        w.u16(42);
+        w.u32(ifdOffset);
+
+        // Entries in ascending tag order; single-tile tables live in the entry.
+        w.u16(entries);
+        w.entry(256, kLong, 1, static_cast<std::uint32_t>(width));   // ImageWidth
+        w.entry(257, kLong, 1, static_cast<std::uint32_t>(height));  // ImageLength
+        w.entry(258, kShort, 3, bitsOffset);                         // BitsPerSample
+        w.entry(259, kShort, 1, 1);                                  // Compression: none
+        w.entry(262, kShort, 1, 2);                                  // Photometric: RGB
+        w.entry(277, kShort, 1, 3);                                  // SamplesPerPixel
+        w.entry(284, kShort, 1, 1);                                  // PlanarConfiguration: chunky
+        w.entry(322, kLong, 1, static_cast<std::uint32_t>(tileWidth));
+        w.entry(323, kLong, 1, static_cast<std::uint32_t>(tileHeight));
+        w.entry(324, kLong, tiles, tiles == 1 ? m_dataOffset : offsetsOffset);           // TileOffsets
+        w.entry(325, kLong, tiles, tiles == 1 ? static_cast<std::uint32_t>(tileBytes()) : countsOffset); // TileByteCounts
+        w.u32(0); // no next IFD
+
+        for (int c = 0; c < 3; ++c)
+        {
+            w.u16(static_cast<std::uint32_t>(bitsPerSample));
+        }
+        w.u16(0);
+        for (std::uint32_t t = 0; t < tiles; ++t)
+        {
+            w.u32(m_dataOffset + t * static_cast<std::uint32_t>(tileBytes()));
+        }
+        for (std::uint32_t t = 0; t < tiles; ++t)
+        {
+            w.u32(static_cast<std::uint32_t>(tileBytes()));
+        }
+
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file)
+        {
+            throw std::runtime_error("Failed to open for writing: " + path);
+        }
+        if (std::fwrite(w.bytes.data(), 1, w.bytes.size(), m_file) != w.bytes.size())
+        {
+            std::fclose(m_file);
+            m_file = nullptr;
+            throw std::runtime_error("Failed to write TIFF header: " + path);
+        }
+    }
+
+    TiledTiffWriter::~TiledTiffWriter()
+    {
+        if (m_file)
+        {
+            std::fclose(m_file);
+        }
+    }
+
+    size_t TiledTiffWriter::tileBytes() const
+    {
+        return static_cast<size_t>(m_tileWidth) * m_tileHeight * 3 * (m_bitsPerSample / 8);
+    }
+
+    void TiledTiffWriter::writeTile(int tx, int ty, const void* pixels, size_t stride)
+    {
+        if (tx < 0 || ty < 0 || tx >= tilesAcross() || ty >= tilesDown())
+        {
+            throw std::runtime_error("TIFF tile index out of range");
+        }
+
+        const size_t rowBytes = static_cast<size_t>(m_tileWidth) * 3 * (m_bitsPerSample / 8);
+        const std::uint64_t offset = m_dataOffset + (static_cast<std::uint64_t>(ty) * tilesAcross() + tx) * tileBytes();
+        const auto* src = static_cast<const unsigned char*>(pixels);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file || !seekTo(m_file, offset))
+        {
+            m_failed = true;
+            return;
+        }
+        for (int y = 0; y < m_tileHeight; ++y)
+        {
+            if (std::fwrite(src + y * stride, 1, rowBytes, m_file) != rowBytes)
+            {
+                m_failed = true;
+                return;
+            }
+        }
+    }
+
+    void TiledTiffWriter::close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+        const bool closed = std::fclose(m_file) == 0;
+        m_file = nullptr;
+        if (m_failed || !closed)
+        {
+            throw std::runtime_error("Failed to write TIFF: " + m_path);
+        }
+    }
+} // namespace css::io
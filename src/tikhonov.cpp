@@ -0,0 +1,222 @@
+#include "css/tikhonov.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <Eigen/Dense>
+
+namespace css::tikhonov
+{
+    TikhonovPath::TikhonovPath(const Eigen::MatrixXf& A)
+    {
+        Eigen::BDCSVD<Eigen::MatrixXf> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+        const Eigen::Index r = svd.rank();
+
+        m_U = svd.matrixU().leftCols(r);
+        m_s = svd.singularValues().head(r);
+        m_V = svd.matrixV().leftCols(r);
+    }
+
+    TikhonovPath TikhonovPath::fromNormalEquations(const Eigen::MatrixXd& AtA,
+                                                   const Eigen::MatrixXd& AtB,
+                                                   double BtB,
+                                                   Eigen::Index rows,
+                                                   Projection& projection)
+    {
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(AtA);
+
+        // Eigenvalues ascend; keep s >= 1e-6 s_max (the floor selectLambda uses) in descending order.
+        const Eigen::VectorXd& ev = eig.eigenvalues();
+        const Eigen::Index k = ev.size();
+        const double floor = (k > 0 ? std::max(ev[k - 1], 0.0) : 0.0) * 1e-12;
+        Eigen::Index r = 0;
+        while (r < k && ev[k - 1 - r] > floor)
+        {
+            ++r;
+        }
+
+        TikhonovPath path;
+        Eigen::VectorXd s(r);
+        Eigen::MatrixXd V(AtA.rows(), r);
+        for (Eigen::Index i = 0; i < r; ++i)
+        {
+            s[i] = std::sqrt(ev[k - 1 - i]);
+            V.col(i) = eig.eigenvectors().col(k - 1 - i);
+        }
+        path.m_s = s.cast<float>();
+        path.m_V = V.cast<float>();
+
+        const Eigen::MatrixXd coeffs = s.cwiseInverse().asDiagonal() * (V.transpose() * AtB);
+        projection.coeffs = coeffs.cast<float>();
+        projection.outOfRange = static_cast<float>(std::max(0.0, BtB - coeffs.squaredNorm()));
+        projection.rows = rows;
+        return path;
+    }
+
+    TikhonovPath::Projection TikhonovPath::project(const Eigen::MatrixXf& B) const
+    {
+        Projection p;
+        p.coeffs = m_U.transpose() * B;
+        p.outOfRange = (B - m_U * p.coeffs).squaredNorm();
+        p.rows = B.rows();
+        return p;
+    }
+
+    Eigen::MatrixXf TikhonovPath::solve(const Projection& p, float lambda) const
+    {
+        // Filter factors s / (s^2 + lambda) applied to U^T B.
+        Eigen::VectorXf filt = m_s.array() / (m_s.array().square() + lambda);
+        return m_V * (filt.asDiagonal() * p.coeffs);
+    }
+
+    float TikhonovPath::residual(const Projection& p, float lambda) const
+    {
+        // In-range residual component: lambda / (s^2 + lambda) * c
+        Eigen::ArrayXf damp = lambda / (m_s.array().square() + lambda);
+        float inRange = (p.coeffs.array().colwise() * damp).matrix().squaredNorm();
+        return inRange + p.outOfRange;
+    }
+
+    float TikhonovPath::gcv(const Projection& p, float lambda) const
+    {
+        const float n = static_cast<float>(p.rows);
+        const float trace = (m_s.array().square() / (m_s.array().square() + lambda)).sum();
+        const float dof = n - trace;
+        if (dof <= 0.0f)
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+        return n * residual(p, lambda) / (dof * dof);
+    }
+
+    float TikhonovPath::lcurveCurvature(const Projection& p, float lambda) const
+    {
+        // Hansen's lcfun with regularization parameter mu = sqrt(lambda),
+        // filter factors f = s^2 / (s^2 + mu^2). Columns are pooled.
+        const double mu = std::sqrt(static_cast<double>(lambda));
+        if (mu <= 0.0)
+        {
+            return 0.0f;
+        }
+
+        double eta2 = 0.0, rho2 = p.outOfRange;
+        double phi = 0.0, psi = 0.0, dphi = 0.0, dpsi = 0.0;
+        for (Eigen::Index i = 0; i < m_s.size(); ++i)
+        {
+            const double s = m_s[i];
+            const double f = s * s / (s * s + mu * mu);
+            const double cf = 1.0 - f;
+            const double f1 = -2.0 * f * cf / mu;
+            const double f2 = -f1 * (3.0 - 4.0 * f) / mu;
+
+            const double beta2 = p.coeffs.row(i).cast<double>().squaredNorm();
+            const double xi2 = beta2 / (s * s);
+
+            eta2 += f * f * xi2;
+            rho2 += cf * cf * beta2;
+            phi += f * f1 * xi2;
+            psi += cf * f1 * beta2;
+            dphi += (f1 * f1 + f * f2) * xi2;
+            dpsi += (-f1 * f1 + cf * f2) * beta2;
+        }
+
+        const double eta = std::sqrt(eta2);
+        const double rho = std::sqrt(rho2);
+        if (eta <= 0.0 || rho <= 0.0)
+        {
+            return 0.0f;
+        }
+
+        const double deta = phi / eta;
+        const double drho = -psi / rho;
+        const double ddeta = dphi / eta - deta * (deta / eta);
+        const double ddrho = -dpsi / rho - drho * (drho / rho);
+
+        const double dlogeta = deta / eta;
+        const double dlogrho = drho / rho;
+        const double ddlogeta = ddeta / eta - dlogeta * dlogeta;
+        const double ddlogrho = ddrho / rho - dlogrho * dlogrho;
+
+        const double denom = std::pow(dlogrho * dlogrho + dlogeta * dlogeta, 1.5);
+        if (denom <= 0.0)
+        {
+            return 0.0f;
+        }
+        return static_cast<float>((dlogrho * ddlogeta - ddlogrho * dlogeta) / denom);
+    }
+
+    float TikhonovPath::selectLambda(const Projection& p,
+                                     LambdaSelection method,
+                                     float fixedLambda,
+                                     int gridSize) const
+    {
+        if (method == LambdaSelection::Fixed || m_s.size() == 0)
+        {
+            return fixedLambda;
+        }
+
+        // Cost to minimize as a function of log10(lambda).
+        std::function<double(double)> cost;
+        if (method == LambdaSelection::GCV)
+        {
+            cost = [&](double t) { return gcv(p, static_cast<float>(std::pow(10.0, t))); };
+        }
+        else
+        {
+            cost = [&](double t) { return -lcurveCurvature(p, static_cast<float>(std::pow(10.0, t))); };
+        }
+
+        // Path spans the squared singular values with generous margins.
+        const double sMax = m_s[0];
+        const double sMin = std::max(static_cast<double>(m_s[m_s.size() - 1]), sMax * 1e-6);
+        const double lo = std::log10(sMin * sMin) - 4.0;
+        const double hi = std::log10(sMax * sMax) + 1.0;
+
+        gridSize = std::max(gridSize, 3);
+        const double step = (hi - lo) / (gridSize - 1);
+
+        int bestIdx = 0;
+        double bestCost = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < gridSize; ++i)
+        {
+            double c = cost(lo + step * i);
+            if (c < bestCost)
+            {
+                bestCost = c;
+                bestIdx = i;
+            }
+        }
+
+        // Golden-section refinement in the bracketing grid cells.
+        double a = lo + step * std::max(0, bestIdx - 1);
+        double b = lo + step * std::min(gridSize - 1, bestIdx + 1);
+        const double g = 0.5 * (std::sqrt(5.0) - 1.0);
+        double x1 = b - g * (b - a);
+        double x2 = a + g * (b - a);
+        double c1 = cost(x1);
+        double c2 = cost(x2);
+        for (int it = 0; it < 30; ++it)
+        {
+            if (c1 < c2)
+            {
+                b = x2; x2 = x1; c2 = c1;
+                x1 = b - g * (b - a);
+                c1 = cost(x1);
+            }
+            else
+            {
+                a = x1; x1 = x2; c1 = c2;
+                x2 = a + g * (b - a);
+                c2 = cost(x2);
+            }
+        }
+
+        double t = 0.5 * (a + b);
+        if (cost(t) > bestCost)
+        {
+            t = lo + step * bestIdx;
+        }
+        return static_cast<float>(std::pow(10.0, t));
+    }
+} // namespace css::tikhonov
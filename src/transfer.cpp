@@ -0,0 +1,243 @@
+#include "css/transfer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace css::transfer
+{
+    namespace
+    {
+        // Table layout: kOctaves octaves below 1.0 with 2^kMantissaBits segments each.
+        constexpr int kOctaves = 64;
+        constexpr int kMantissaBits = 8;
+        constexpr int kSegments = kOctaves << kMantissaBits;
+        constexpr std::uint32_t kFirstBits = static_cast<std::uint32_t>(127 - kOctaves) << 23; // 2^-64
+
+        // Input below which a curve uses its closed-form foot (linear or sqrt).
+        float knee(const TransferFunction& tf)
+        {
+            switch (tf.curve)
+            {
+            case Curve::Srgb: return 0.0031308f;
+            case Curve::Rec709: return 0.018f;
+            case Curve::HLG: return 1.0f / 12.0f;
+            default: return 0.0f;
+            }
+        }
+
+        // Foot of the curve, u < knee(tf).
+        double footValue(const TransferFunction& tf, double u)
+        {
+            switch (tf.curve)
+            {
+            case Curve::Srgb: return 12.92 * u;
+            case Curve::Rec709: return 4.5 * u;
+            case Curve::HLG: return std::sqrt(3.0 * u);
+            default: return u;
+            }
+        }
+
+        // Main branch, u >= knee(tf); smooth below the knee too, so table
+        // segments straddling it interpolate one analytic curve.
+        double branchValue(const TransferFunction& tf, double u)
+        {
+            switch (tf.curve)
+            {
+            case Curve::Srgb:
+                return 1.055 * std::pow(u, 1.0 / 2.4) - 0.055;
+            case Curve::Rec709:
+                return 1.099 * std::pow(u, 0.45) - 0.099;
+            case Curve::PQ:
+            {
+                const double m1 = 2610.0 / 16384.0, m2 = 2523.0 / 4096.0 * 128.0;
+                const double c1 = 3424.0 / 4096.0, c2 = 2413.0 / 4096.0 * 32.0, c3 = 2392.0 / 4096.0 * 32.0;
+                const double t = std::pow(u, m1);
+                return std::pow((c1 + c2 * t) / (1.0 + c3 * t), m2);
+            }
+            case Curve::HLG:
+            {
+                const double a = 0.17883277, b = 1.0 - 4.0 * a, c = 0.5 - a * std::log(4.0 * a);
+                return a * std::log(std::max(12.0 * u - b, 1e-30)) + c;
+            }
+            case Curve::Gamma:
+                return std::pow(u, 1.0 / tf.gamma);
+            default:
+                return u;
+            }
+        }
+
+        double curveValue(const TransferFunction& tf, double u)
+        {
+            return u < knee(tf) ? footValue(tf, u) : branchValue(tf, u);
+        }
+
+        double inputScale(const TransferFunction& tf)
+        {
+            return tf.curve == Curve::PQ ? tf.pqWhiteNits / 10000.0 : 1.0;
+        }
+    } // namespace
+
+    TransferFunction parseTransfer(const std::string& name)
+    {
+        TransferFunction tf;
+        const auto colon = name.find(':');
+        const std::string base = name.substr(0, colon);
+        const std::string arg = colon == std::string::npos ? std::string() : name.substr(colon + 1);
+
+        if (base == "linear") tf.curve = Curve::Linear;
+        else if (base == "srgb") tf.curve = Curve::Srgb;
+        else if (base == "rec709") tf.curve = Curve::Rec709;
+        else if (base == "pq") tf.curve = Curve::PQ;
+        else if (base == "hlg") tf.curve = Curve::HLG;
+        else if (base == "gamma") tf.curve = Curve::Gamma;
+        else throw std::runtime_error("Unknown transfer function: " + name);
+
+        if (!arg.empty())
+        {
+            const float value = std::stof(arg);
+            if (!(value > 0.0f) || (tf.curve != Curve::Gamma && tf.curve != Curve::PQ))
+            {
+                throw std::runtime_error("Invalid transfer function parameter: " + name);
+            }
+            (tf.curve == Curve::Gamma ? tf.gamma : tf.pqWhiteNits) = value;
+        }
+        return tf;
+    }
+
+    std::string transferName(const TransferFunction& tf)
+    {
+        switch (tf.curve)
+        {
+        case Curve::Linear: return "linear";
+        case Curve::Srgb: return "srgb";
+        case Curve::Rec709: return "rec709";
+        case Curve::PQ: return "pq:" + std::to_string(tf.pqWhiteNits);
+        case Curve::HLG: return "hlg";
+        default: return "gamma:" + std::to_string(tf.gamma);
+        }
+    }
+
+    double encodeReference(const TransferFunction& tf, double v)
+    {
+        if (tf.curve == Curve::Linear)
+        {
+            return v;
+        }
+        return curveValue(tf, std::clamp(v * inputScale(tf), 0.0, 1.0));
+    }
+
+    double decodeReference(const TransferFunction& tf, double code)
+    {
+        if (tf.curve == Curve::Linear)
+        {
+            return code;
+        }
+
+        const double e = std::clamp(code, 0.0, 1.0);
+        double u;
+        if (e < footValue(tf, knee(tf)))
+        {
+            u = tf.curve == Curve::Srgb ? e / 12.92
+              : tf.curve == Curve::Rec709 ? e / 4.5
+              : e * e / 3.0; // HLG
+        }
+        else
+        {
+            switch (tf.curve)
+            {
+            case Curve::Srgb:
+                u = std::pow((e + 0.055) / 1.055, 2.4);
+                break;
+            case Curve::Rec709:
+                u = std::pow((e + 0.099) / 1.099, 1.0 / 0.45);
+                break;
+            case Curve::PQ:
+            {
+                const double m1 = 2610.0 / 16384.0, m2 = 2523.0 / 4096.0 * 128.0;
+                const double c1 = 3424.0 / 4096.0, c2 = 2413.0 / 4096.0 * 32.0, c3 = 2392.0 / 4096.0 * 32.0;
+                const double t = std::pow(e, 1.0 / m2);
+                u = std::pow(std::max(t - c1, 0.0) / (c2 - c3 * t), 1.0 / m1);
+                break;
+            }
+            case Curve::HLG:
+            {
+                const double a = 0.17883277, b = 1.0 - 4.0 * a, c = 0.5 - a * std::log(4.0 * a);
+                u = (std::exp((e - c) / a) + b) / 12.0;
+                break;
+            }
+            default: // Gamma
+                u = std::pow(e, static_cast<double>(tf.gamma));
+                break;
+            }
+        }
+        return u / inputScale(tf);
+    }
+
+    EncodeLut::EncodeLut(const TransferFunction& tf)
+        : m_tf(tf), m_scale(static_cast<float>(inputScale(tf))), m_knee(knee(tf))
+    {
+        if (tf.curve == Curve::Linear)
+        {
+            return;
+        }
+
+        // Knots of the main branch, then f(0) for the stretch below 2^-64.
+        m_table.resize(kSegments + 2);
+        for (int i = 0; i <= kSegments; ++i)
+        {
+            const std::uint32_t bits = kFirstBits + (static_cast<std::uint32_t>(i) << (23 - kMantissaBits));
+            float u;
+            std::memcpy(&u, &bits, sizeof(u));
+            m_table[i] = static_cast<float>(branchValue(tf, u));
+        }
+        m_table[kSegments + 1] = static_cast<float>(branchValue(tf, 0.0));
+    }
+
+    float EncodeLut::operator()(float v) const
+    {
+        if (m_table.empty())
+        {
+            return v;
+        }
+
+        float u = v * m_scale;
+        u = u > 0.0f ? std::min(u, 1.0f) : 0.0f; // NaN -> 0
+        if (u < m_knee)
+        {
+            return static_cast<float>(footValue(m_tf, u));
+        }
+
+        std::uint32_t bits;
+        std::memcpy(&bits, &u, sizeof(bits));
+        if (bits < kFirstBits)
+        {
+            const float f0 = m_table[kSegments + 1];
+            return f0 + (m_table[0] - f0) * (u * 0x1p64f);
+        }
+
+        const std::uint32_t offset = bits - kFirstBits;
+        const std::uint32_t index = offset >> (23 - kMantissaBits);
+        if (index >= static_cast<std::uint32_t>(kSegments))
+        {
+            return m_table[kSegments];
+        }
+        const float frac = static_cast<float>(offset & ((1u << (23 - kMantissaBits)) - 1)) *
+                           (1.0f / static_cast<float>(1u << (23 - kMantissaBits)));
+        return m_table[index] + (m_table[index + 1] - m_table[index]) * frac;
+    }
+
+    void EncodeLut::apply(float* values, size_t count) const
+    {
+        if (m_table.empty())
+        {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = (*this)(values[i]);
+        }
+    }
+} // namespace css::transfer
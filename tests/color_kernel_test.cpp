@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "css/color_kernel.hpp"
+
+int main()
+{
+    using css::kernel::Isa;
+
+    css::profile::Profile prof;
+    prof.colorMatrix << 1.7f, -0.5f, -0.2f,
+                        -0.3f, 1.5f, -0.2f,
+                        0.05f, -0.45f, 1.4f;
+    prof.whiteBalance = Eigen::Vector3f(2.0f, 1.0f, 1.6f);
+
+    std::mt19937 rng(41);
+    std::uniform_real_distribution<float> uni(-0.1f, 0.7f);
+    const size_t n = 4000 + 13; // ragged tail for every vector width
+    std::vector<float> in(3 * n);
+    for (float& v : in) v = uni(rng);
+    // Deep shadows, where the feet of pure gamma and PQ are steepest.
+    for (size_t i = 0; i < 300; ++i) in[i] = std::pow(10.0f, -8.0f * static_cast<float>(i) / 300.0f) * 0.01f;
+
+    const Isa best = css::kernel::detectIsa();
+    std::cout << "Detected ISA: " << css::kernel::isaName(best) << "\n";
+
+    for (const char* name : {"linear", "srgb", "rec709", "pq", "hlg", "gamma:2.6"})
+    {
+        const auto tf = css::transfer::parseTransfer(name);
+        const auto t = css::kernel::makeTransform(prof, tf);
+
+        // Reference in double, straight from the RGB profile.
+        std::vector<double> expected(3 * n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            Eigen::Vector3d rgb(in[3 * i + 2], in[3 * i + 1], in[3 * i]);
+            Eigen::Vector3d tgt = prof.colorMatrix.cast<double>() * rgb.cwiseProduct(prof.whiteBalance.cast<double>());
+            for (int c = 0; c < 3; ++c)
+            {
+                expected[3 * i + c] = css::transfer::encodeReference(tf, tgt[2 - c]);
+            }
+        }
+
+        for (Isa isa : {Isa::Scalar, Isa::SSE42, Isa::AVX2, Isa::AVX512})
+        {
+            if (isa > best)
+                continue;
+
+            // Every prefix length exercises the padded tail; results must not
+            // depend on where a pixel sits in the row.
+            std::vector<float> full(3 * n);
+            css::kernel::applyRow(t, in.data(), full.data(), n, isa);
+            double maxErr = 0.0;
+            for (size_t i = 0; i < 3 * n; ++i)
+            {
+                maxErr = std::max(maxErr, std::abs(full[i] - expected[i]) / std::max(1.0, std::abs(expected[i])));
+            }
+
+            for (size_t count = 0; count <= 40; ++count)
+            {
+                std::vector<float> part(in.begin() + 3, in.begin() + 3 + 3 * count);
+                css::kernel::applyRow(t, part.data(), part.data(), count, isa); // in place
+                if (!std::equal(part.begin(), part.end(), full.begin() + 3))
+                {
+                    std::cerr << css::kernel::isaName(isa) << ": row of " << count
+                              << " differs from the full-row result\n";
+                    return 1;
+                }
+            }
+
+            // Quantized rows: the same codes as clamping and rounding the float row.
+            std::vector<std::uint16_t> q16(3 * n);
+            std::vector<std::uint8_t> q8(3 * n);
+            css::kernel::applyRow(t, in.data(), q16.data(), n, isa);
+            css::kernel::applyRow(t, in.data(), q8.data(), n, isa);
+            for (size_t i = 0; i < 3 * n; ++i)
+            {
+                const float v = std::clamp(full[i], 0.0f, 1.0f);
+                if (q16[i] != static_cast<std::uint16_t>(v * 65535.0f + 0.5f) ||
+                    q8[i] != static_cast<std::uint8_t>(v * 255.0f + 0.5f))
+                {
+                    std::cerr << css::kernel::isaName(isa) << " " << name << ": quantized value " << i
+                              << " differs from the float row\n";
+                    return 1;
+                }
+            }
+
+            // Includes float rounding of the matrix product; half a 16-bit LSB is 7.6e-6.
+            if (maxErr > 2e-6)
+            {
+                std::cerr << css::kernel::isaName(isa) << " " << name << " error " << maxErr << "\n";
+                return 1;
+            }
+        }
+    }
+
+    // Fixed-point path on black-subtracted 14- and 16-bit codes.
+    for (float white : {16383.0f, 65535.0f})
+    {
+        std::uniform_int_distribution<int> code(0, static_cast<int>(white));
+        std::vector<std::uint16_t> raw(3 * n);
+        for (auto& v : raw) v = static_cast<std::uint16_t>(code(rng));
+
+        for (const char* name : {"linear", "srgb"})
+        {
+            const auto tf = css::transfer::parseTransfer(name);
+            const auto t16 = css::kernel::makeFixedTransform(prof, tf, white, 16);
+            const auto t8 = css::kernel::makeFixedTransform(prof, tf, white, 8);
+
+            std::vector<std::uint16_t> base16(3 * n);
+            std::vector<std::uint8_t> base8(3 * n);
+            css::kernel::applyRowFixed(t16, raw.data(), base16.data(), n, Isa::Scalar);
+            css::kernel::applyRowFixed(t8, raw.data(), base8.data(), n, Isa::Scalar);
+
+            // Against the double-precision result: a few 16-bit codes of
+            // coefficient rounding for linear output (the 16-bit linear index
+            // costs more through the steep sRGB foot), under one 8-bit code.
+            double maxErr16 = 0.0, maxErr8 = 0.0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                Eigen::Vector3d rgb(raw[3 * i + 2], raw[3 * i + 1], raw[3 * i]);
+                Eigen::Vector3d tgt = prof.colorMatrix.cast<double>() * rgb.cwiseProduct(prof.whiteBalance.cast<double>()) / white;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const double v = std::clamp(css::transfer::encodeReference(tf, tgt[2 - c]), 0.0, 1.0);
+                    maxErr16 = std::max(maxErr16, std::abs(base16[3 * i + c] - v * 65535.0));
+                    maxErr8 = std::max(maxErr8, std::abs(base8[3 * i + c] - v * 255.0));
+                }
+            }
+            if ((tf.curve == css::transfer::Curve::Linear && maxErr16 > 10.0) || maxErr8 > 1.0)
+            {
+                std::cerr << "fixed " << name << " error " << maxErr16 << " / " << maxErr8 << " codes\n";
+                return 1;
+            }
+
+            for (Isa isa : {Isa::SSE42, Isa::AVX2, Isa::AVX512})
+            {
+                if (isa > best)
+                    continue;
+                for (size_t count : {n, size_t(1), size_t(7), size_t(17), size_t(33)})
+                {
+                    std::vector<std::uint16_t> out16(raw.begin(), raw.begin() + 3 * count);
+                    std::vector<std::uint8_t> out8(3 * count);
+                    css::kernel::applyRowFixed(t16, out16.data(), out16.data(), count, isa); // in place
+                    css::kernel::applyRowFixed(t8, raw.data(), out8.data(), count, isa);
+                    if (!std::equal(out16.begin(), out16.end(), base16.begin()) ||
+                        !std::equal(out8.begin(), out8.end(), base8.begin()))
+                    {
+                        std::cerr << css::kernel::isaName(isa) << " fixed " << name << ": row of " << count
+                                  << " differs from the scalar result\n";
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Color kernel test passed\n";
+    return 0;
+}
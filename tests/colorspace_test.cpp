@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "css/color_kernel.hpp"
+#include "css/colorimetry.hpp"
+#include "css/colorspace.hpp"
+
+namespace
+{
+    bool near(const Eigen::Matrix3f& a, const Eigen::Matrix3f& b, float tol, const std::string& what)
+    {
+        const float err = (a - b).cwiseAbs().maxCoeff();
+        if (err > tol)
+        {
+            std::cerr << what << " off by " << err << "\n" << a << "\n";
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main()
+{
+    namespace cs = css::colorspace;
+
+    // Published matrices: BT.2087 (Rec.709 -> Rec.2020), the ACES AP0 NPM
+    // (S-2008-001) and Bradford D65 -> D50 (Lindbloom).
+    Eigen::Matrix3f bt2087;
+    bt2087 << 0.6274f, 0.3293f, 0.0433f,
+              0.0691f, 0.9195f, 0.0114f,
+              0.0164f, 0.0880f, 0.8956f;
+    Eigen::Matrix3f ap0;
+    ap0 << 0.9525524f, 0.0f, 0.0000937f,
+           0.3439664f, 0.7281661f, -0.0721325f,
+           0.0f, 0.0f, 1.0088252f;
+    Eigen::Matrix3f d65ToD50;
+    d65ToD50 << 1.0478112f, 0.0228866f, -0.0501270f,
+                0.0295424f, 0.9904844f, -0.0170491f,
+                -0.0092345f, 0.0150436f, 0.7521316f;
+
+    const cs::ColorSpace srgb = cs::find("linear_srgb");
+    if (!near(cs::conversion(srgb, cs::find("linear_rec2020")), bt2087, 2e-4f, "sRGB -> Rec.2020") ||
+        !near(cs::find("aces_ap0").toXyz, ap0, 1e-5f, "AP0 -> XYZ") ||
+        !near(cs::conversion(cs::find("xyz_d65"), cs::find("xyz_d50")), d65ToD50, 1e-4f, "Bradford D65 -> D50") ||
+        !near(cs::conversion(srgb, srgb), Eigen::Matrix3f::Identity(), 0.0f, "identity"))
+    {
+        return 1;
+    }
+
+    // With adaptation, white stays white in every space; both CATs agree on whites.
+    for (const std::string& name : cs::names())
+    {
+        const cs::ColorSpace to = cs::find(name);
+        for (cs::Cat cat : {cs::Cat::Bradford, cs::Cat::Cat16})
+        {
+            const Eigen::Vector3f white = to.fromXyz * to.white;
+            const Eigen::Vector3f mapped = cs::conversion(srgb, to, cat) * Eigen::Vector3f::Ones();
+            if ((mapped - white).cwiseAbs().maxCoeff() > 2e-5f)
+            {
+                std::cerr << name << " (" << cs::catName(cat) << "): white maps to " << mapped.transpose() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    // A re-targeted profile renders in one pass what two passes would.
+    css::profile::Profile prof;
+    prof.colorMatrix << 1.7f, -0.5f, -0.2f,
+                        -0.3f, 1.5f, -0.2f,
+                        0.05f, -0.45f, 1.4f;
+    prof.whiteBalance = Eigen::Vector3f(2.0f, 1.0f, 1.6f);
+    prof.targetColorSpace = "linear_srgb";
+    prof.model = css::profile::Model::RootPoly2;
+    prof.rootMatrix(0, 0) = 0.1f;
+    prof.rootMatrix(2, 1) = -0.05f;
+
+    std::mt19937 rng(50);
+    std::uniform_real_distribution<float> uni(0.0f, 0.6f);
+    const size_t n = 257;
+    std::vector<float> in(3 * n);
+    for (float& v : in) v = uni(rng);
+
+    const css::transfer::TransferFunction linear{css::transfer::Curve::Linear};
+    std::vector<float> base(3 * n), direct(3 * n);
+    css::kernel::applyRow(css::kernel::makeTransform(prof, linear), in.data(), base.data(), n);
+    for (const char* name : {"linear_rec2020", "aces_ap1", "xyz_d50"})
+    {
+        const auto target = cs::retarget(prof, name, cs::Cat::Cat16);
+        const Eigen::Matrix3f c = cs::conversion(srgb, cs::find(name), cs::Cat::Cat16);
+        css::kernel::applyRow(css::kernel::makeTransform(target, linear), in.data(), direct.data(), n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const Eigen::Vector3f rgb(base[3 * i + 2], base[3 * i + 1], base[3 * i]);
+            const Eigen::Vector3f expected = c * rgb;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (std::abs(direct[3 * i + k] - expected[2 - k]) > 1e-5f)
+                {
+                    std::cerr << name << ": folded transform differs from the two-pass result\n";
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::cout << "Color space test passed\n";
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <opencv2/imgproc.hpp>
+
+#include "css/demosaic.hpp"
+
+namespace
+{
+    using css::demosaic::Cfa;
+    using css::demosaic::Method;
+
+    int reflect(int i, int n)
+    {
+        while (i < 0 || i >= n) i = i < 0 ? -i : 2 * n - 2 - i;
+        return i;
+    }
+
+    // Straight from the definitions: channel of each site, and the filters
+    // as 5x5 stencils applied in double.
+    struct Reference
+    {
+        const std::vector<std::uint16_t>& raw;
+        int width, height;
+        Cfa cfa;
+        float black, scale;
+
+        int channel(int x, int y) const // 0 = B, 1 = G, 2 = R
+        {
+            static const int top[4][4] = {{2, 1, 1, 0}, {0, 1, 1, 2}, {1, 2, 0, 1}, {1, 0, 2, 1}};
+            return top[static_cast<int>(cfa)][2 * (y & 1) + (x & 1)];
+        }
+
+        double at(int x, int y) const
+        {
+            const int v = raw[static_cast<size_t>(reflect(y, height)) * width + reflect(x, width)];
+            return std::max(static_cast<double>(v) - black, 0.0) * scale;
+        }
+
+        double stencil(int x, int y, const double (&k)[5][5]) const
+        {
+            double sum = 0.0;
+            for (int dy = -2; dy <= 2; ++dy)
+                for (int dx = -2; dx <= 2; ++dx)
+                    sum += k[dy + 2][dx + 2] * at(x + dx, y + dy);
+            return sum;
+        }
+
+        double value(int x, int y, int c, Method method) const
+        {
+            const int here = channel(x, y);
+            if (here == c) return at(x, y);
+
+            const bool mhc = method == Method::MalvarHeCutler;
+            static const double gAtX[2][5][5] = {
+                {{0, 0, 0, 0, 0}, {0, 0, .25, 0, 0}, {0, .25, 0, .25, 0}, {0, 0, .25, 0, 0}, {0, 0, 0, 0, 0}},
+                {{0, 0, -1, 0, 0}, {0, 0, 2, 0, 0}, {-1, 2, 4, 2, -1}, {0, 0, 2, 0, 0}, {0, 0, -1, 0, 0}}};
+            static const double rowNeighbors[2][5][5] = {
+                {{0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}, {0, .5, 0, .5, 0}, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}},
+                {{0, 0, .5, 0, 0}, {0, -1, 0, -1, 0}, {-1, 4, 5, 4, -1}, {0, -1, 0, -1, 0}, {0, 0, .5, 0, 0}}};
+            static const double columnNeighbors[2][5][5] = {
+                {{0, 0, 0, 0, 0}, {0, 0, .5, 0, 0}, {0, 0, 0, 0, 0}, {0, 0, .5, 0, 0}, {0, 0, 0, 0, 0}},
+                {{0, 0, -1, 0, 0}, {0, -1, 4, -1, 0}, {.5, 0, 5, 0, .5}, {0, -1, 4, -1, 0}, {0, 0, -1, 0, 0}}};
+            static const double diagonal[2][5][5] = {
+                {{0, 0, 0, 0, 0}, {0, .25, 0, .25, 0}, {0, 0, 0, 0, 0}, {0, .25, 0, .25, 0}, {0, 0, 0, 0, 0}},
+                {{0, 0, -1.5, 0, 0}, {0, 2, 0, 2, 0}, {-1.5, 0, 6, 0, -1.5}, {0, 2, 0, 2, 0}, {0, 0, -1.5, 0, 0}}};
+            const double norm = mhc ? 0.125 : 1.0;
+
+            double v;
+            if (c == 1)
+                v = stencil(x, y, gAtX[mhc]);
+            else if (here != 1)
+                v = stencil(x, y, diagonal[mhc]);
+            else if (channel(x + 1, y) == c)
+                v = stencil(x, y, rowNeighbors[mhc]);
+            else
+                v = stencil(x, y, columnNeighbors[mhc]);
+            return std::max(v * norm, 0.0);
+        }
+    };
+} // namespace
+
+int main()
+{
+    using css::kernel::Isa;
+
+    // Odd sizes so windows and vector tails are ragged.
+    const int width = 157, height = 61;
+    std::vector<std::uint16_t> raw(static_cast<size_t>(width) * height);
+    std::mt19937 rng(47);
+    std::uniform_int_distribution<int> noise(0, 900);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            raw[static_cast<size_t>(y) * width + x] =
+                static_cast<std::uint16_t>(200 + 1500 * (1.0 + std::sin(0.11 * x - 0.07 * y)) + noise(rng));
+
+    const Isa best = css::kernel::detectIsa();
+    for (Cfa cfa : {Cfa::RGGB, Cfa::BGGR, Cfa::GRBG, Cfa::GBRG})
+    {
+        css::demosaic::MosaicView view;
+        view.data = raw.data();
+        view.stride = width;
+        view.width = width;
+        view.height = height;
+        view.cfa = cfa;
+        view.black = 256.0f;
+        view.scale = 1.0f / 3839.0f;
+        const Reference ref{raw, width, height, cfa, view.black, view.scale};
+
+        for (Method method : {Method::Bilinear, Method::MalvarHeCutler})
+        {
+            const char* name = css::demosaic::methodName(method);
+            std::vector<float> full(3 * raw.size());
+            for (Isa isa = Isa::Scalar; isa <= best; isa = static_cast<Isa>(static_cast<int>(isa) + 1))
+            {
+                std::vector<float> image(3 * raw.size(), -1.0f);
+                css::demosaic::demosaicRows(view, method, 0, 0, width, height, [&](int y, const float* bgr) {
+                    std::copy(bgr, bgr + 3 * width, image.begin() + 3 * static_cast<size_t>(y) * width);
+                }, isa);
+
+                double maxErr = 0.0;
+                for (int y = 0; y < height; ++y)
+                    for (int x = 0; x < width; ++x)
+                        for (int c = 0; c < 3; ++c)
+                            maxErr = std::max(maxErr, std::abs(image[3 * (static_cast<size_t>(y) * width + x) + c] -
+                                                               ref.value(x, y, c, method)));
+                if (maxErr > 1e-6)
+                {
+                    std::cerr << name << " (" << css::kernel::isaName(isa) << ", CFA " << static_cast<int>(cfa)
+                              << ") differs from the reference by " << maxErr << "\n";
+                    return 1;
+                }
+                if (isa == best)
+                {
+                    full = image;
+                }
+            }
+
+            // Windows at every phase offset, including the image edges, must
+            // reproduce the full frame bit for bit.
+            for (int y0 : {0, 1, 17, 46})
+            {
+                for (int x0 : {0, 3, 64, 120})
+                {
+                    const int cols = std::min(37, width - x0), rows = std::min(15, height - y0);
+                    bool same = true;
+                    css::demosaic::demosaicRows(view, method, x0, y0, cols, rows, [&](int y, const float* bgr) {
+                        same = same && std::equal(bgr, bgr + 3 * cols,
+                                                  full.begin() + 3 * (static_cast<size_t>(y) * width + x0));
+                    }, best);
+                    if (!same)
+                    {
+                        std::cerr << name << " window at (" << x0 << ", " << y0 << ") differs from the full frame\n";
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Bayer codes keep cv::cvtColor's phase: on a flat color both decode
+    // the same B, G, R in the interior (a swapped mapping exchanges R and B).
+    for (int code : {cv::COLOR_BayerBG2BGR, cv::COLOR_BayerRG2BGR, cv::COLOR_BayerGB2BGR, cv::COLOR_BayerGR2BGR})
+    {
+        const Cfa cfa = css::demosaic::cfaFromBayerCode(code);
+        const Reference layout{raw, width, height, cfa, 0.0f, 1.0f};
+        const std::uint16_t level[3] = {3000, 2000, 1000}; // B, G, R
+        cv::Mat mosaic(16, 16, CV_16UC1);
+        for (int y = 0; y < mosaic.rows; ++y)
+            for (int x = 0; x < mosaic.cols; ++x)
+                mosaic.at<std::uint16_t>(y, x) = level[layout.channel(x, y)];
+
+        cv::Mat expected;
+        cv::cvtColor(mosaic, expected, code);
+        const cv::Mat ours = css::demosaic::demosaicImage(mosaic, cfa, Method::Bilinear, 0.0f, 1.0f, CV_16U);
+        const cv::Rect interior(2, 2, mosaic.cols - 4, mosaic.rows - 4);
+        if (cv::norm(ours(interior), expected(interior), cv::NORM_INF) > 1.0 ||
+            expected.at<cv::Vec3w>(8, 8) != cv::Vec3w(level[0], level[1], level[2]))
+        {
+            std::cerr << "Bayer code " << code << " (CFA " << static_cast<int>(cfa)
+                      << ") does not match cv::cvtColor's phase\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Demosaic test passed\n";
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "css/daylight.hpp"
+#include "css/jiang.hpp"
+#include "css/parallel.hpp"
+#include "css/resample.hpp"
+
+namespace
+{
+    using css::spectral::SpectralGrid;
+
+    Eigen::VectorXf gaussian(const SpectralGrid& grid, float peak, float width)
+    {
+        Eigen::VectorXf v(grid.count);
+        for (int i = 0; i < grid.count; ++i)
+        {
+            const float t = (grid.wavelength(i) - peak) / width;
+            v[i] = std::exp(-0.5f * t * t);
+        }
+        return v;
+    }
+
+    Eigen::MatrixXf normalized(Eigen::MatrixXf css)
+    {
+        return css / css.maxCoeff();
+    }
+
+    // Chart values of `reflectance` under `spd` through `css`, in the
+    // estimator's forward model (sum over the grid times the step).
+    std::vector<Eigen::Vector3f> render(const Eigen::MatrixXf& reflectance, const Eigen::VectorXf& spd,
+                                       const Eigen::MatrixXf& css, float exposure, float step)
+    {
+        const Eigen::MatrixXf rgb = exposure * step * (reflectance.transpose() * spd.asDiagonal() * css);
+        std::vector<Eigen::Vector3f> patches(static_cast<size_t>(rgb.rows()));
+        for (Eigen::Index i = 0; i < rgb.rows(); ++i)
+        {
+            patches[static_cast<size_t>(i)] = rgb.row(i).transpose();
+        }
+        return patches;
+    }
+} // namespace
+
+int main()
+{
+    const SpectralGrid grid = SpectralGrid::standard();
+
+    // Known CSS, and per-channel bases that span it among other smooth curves.
+    Eigen::MatrixXf truth(grid.count, 3);
+    const float peaks[3] = {600.0f, 540.0f, 460.0f};
+    css::priors::CameraPriors priors;
+    priors.grid = grid;
+    Eigen::MatrixXf* bases[3] = {&priors.basisR, &priors.basisG, &priors.basisB};
+    for (int c = 0; c < 3; ++c)
+    {
+        truth.col(c) = gaussian(grid, peaks[c], 35.0f) + 0.15f * gaussian(grid, peaks[c] - 70.0f, 25.0f);
+        Eigen::MatrixXf& basis = *bases[c];
+        basis.resize(grid.count, 3);
+        basis.col(0) = gaussian(grid, peaks[c], 35.0f);
+        basis.col(1) = gaussian(grid, peaks[c] - 70.0f, 25.0f);
+        basis.col(2) = gaussian(grid, peaks[c] + 60.0f, 30.0f);
+    }
+
+    // 24 smooth chart reflectances in [0.05, 0.95].
+    std::mt19937 rng(27);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    priors.reflectance.resize(grid.count, 24);
+    for (int j = 0; j < 24; ++j)
+    {
+        const float a = uni(rng), b = uni(rng), peak = 420.0f + 280.0f * uni(rng);
+        priors.reflectance.col(j) = (0.05f + 0.45f * a + 0.45f * b * gaussian(grid, peak, 40.0f).array()).matrix();
+    }
+
+    // Captures under daylight at known CCTs (on the search grid) and exposures.
+    css::daylight::DaylightGenerator daylight;
+    const Eigen::MatrixXf basis =
+        css::spectral::resample(daylight.getBasis(), css::daylight::DaylightGenerator::grid(), grid);
+    const float ccts[3] = {5000.0f, 6500.0f, 9000.0f};
+    const float exposures[3] = {1.0f, 0.6f, 1.4f};
+    std::vector<std::vector<Eigen::Vector3f>> captures;
+    for (int c = 0; c < 3; ++c)
+    {
+        const Eigen::VectorXf spd = basis * daylight.weightsAt(ccts[c], 0.0f);
+        captures.push_back(render(priors.reflectance, spd, truth, exposures[c], grid.step));
+    }
+
+    css::jiang::JiangEstimator estimator(priors);
+
+    // Joint recovery: CSS, illuminants and exposures relative to the first capture.
+    const auto joint = estimator.solveJoint(captures);
+    const float cssErr = (joint.css - normalized(truth)).cwiseAbs().maxCoeff();
+    std::cout << "solveJoint: CSS error " << cssErr << ", RMS " << joint.rmsError << "\n";
+    if (cssErr > 1e-3f || joint.captures.size() != 3)
+    {
+        std::cerr << "solveJoint did not recover the CSS\n";
+        return 1;
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        const auto& capture = joint.captures[static_cast<size_t>(c)];
+        if (std::abs(capture.estimatedCct - ccts[c]) > 1.0f ||
+            std::abs(capture.exposure - exposures[c] / exposures[0]) > 1e-3f)
+        {
+            std::cerr << "Capture " << c << ": CCT " << capture.estimatedCct << ", exposure " << capture.exposure
+                      << " (expected " << ccts[c] << ", " << exposures[c] / exposures[0] << ")\n";
+            return 1;
+        }
+    }
+
+    // The batch solver's factorized search matches the estimator, with and
+    // without automatic lambda selection.
+    std::normal_distribution<float> noise(0.0f, 1e-3f);
+    std::vector<Eigen::Vector3f> noisy = captures[1];
+    for (auto& p : noisy)
+    {
+        p += Eigen::Vector3f(noise(rng), noise(rng), noise(rng));
+    }
+    for (auto selection : {css::tikhonov::LambdaSelection::Fixed, css::tikhonov::LambdaSelection::GCV})
+    {
+        css::jiang::SearchOptions options;
+        options.regularization = selection;
+        options.lambda = 1e-4f;
+        const auto single = estimator.solve(noisy, options);
+        const auto batch = css::jiang::JiangBatchSolver(estimator, options).solve(noisy);
+        if (batch.estimatedCct != single.estimatedCct || (batch.css - single.css).cwiseAbs().maxCoeff() > 1e-4f ||
+            (batch.lambda - single.lambda).cwiseAbs().maxCoeff() > 1e-3f * single.lambda.maxCoeff())
+        {
+            std::cerr << "JiangBatchSolver::solve differs from JiangEstimator::solve (CCT " << batch.estimatedCct
+                      << " vs " << single.estimatedCct << ")\n";
+            return 1;
+        }
+    }
+
+    // Bootstrap bands do not depend on the number of threads.
+    std::vector<Eigen::Vector3f> sigma(24, Eigen::Vector3f::Constant(2e-3f));
+    css::jiang::BootstrapOptions boot;
+    boot.resamples = 64;
+    const css::jiang::JiangBatchSolver solver(estimator);
+    boot.threads = 1;
+    const auto serial = solver.bootstrap(noisy, sigma, boot);
+    boot.threads = 0;
+    const auto pooled = solver.bootstrap(noisy, sigma, boot);
+    bool same = serial.cct == pooled.cct && serial.mean == pooled.mean && serial.stddev == pooled.stddev &&
+                serial.bands.size() == pooled.bands.size();
+    for (size_t p = 0; same && p < serial.bands.size(); ++p)
+    {
+        same = serial.bands[p] == pooled.bands[p];
+    }
+    if (!same)
+    {
+        std::cerr << "Bootstrap differs between 1 and " << css::parallel::sharedPool().concurrency() << " threads\n";
+        return 1;
+    }
+
+    std::cout << "Jiang estimator test passed\n";
+    return 0;
+}
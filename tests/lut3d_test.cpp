@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "css/lut3d.hpp"
+
+int main()
+{
+    using css::kernel::Isa;
+
+    // decodeReference inverts encodeReference on every curve.
+    for (const char* name : {"srgb", "rec709", "pq", "hlg", "gamma:2.6"})
+    {
+        const auto tf = css::transfer::parseTransfer(name);
+        const double top = css::transfer::decodeReference(tf, 1.0);
+        for (int i = 0; i <= 1000; ++i)
+        {
+            const double linear = top * std::pow(10.0, -6.0 * i / 1000.0);
+            const double back = css::transfer::decodeReference(tf, css::transfer::encodeReference(tf, linear));
+            if (std::abs(back - linear) > 1e-7 * std::max(linear, 1e-3))
+            {
+                std::cerr << name << ": decode does not invert encode at " << linear << "\n";
+                return 1;
+            }
+        }
+    }
+
+    std::mt19937 rng(48);
+    std::uniform_real_distribution<float> uni(-0.05f, 1.05f);
+    const size_t n = 3000 + 13; // ragged tail for every vector width
+    std::vector<float> in(3 * n);
+    for (float& v : in) v = uni(rng);
+    in[0] = std::nanf("");
+
+    // Tetrahedral interpolation is exact for affine maps, so a linear-shaper
+    // LUT of one must reproduce it everywhere inside the cube.
+    const Eigen::Matrix3f affine = (Eigen::Matrix3f() << 0.9f, 0.2f, -0.1f, 0.05f, 0.7f, 0.25f, -0.2f, 0.1f, 1.1f).finished();
+    const Eigen::Vector3f offset(0.01f, -0.02f, 0.03f);
+    const css::lut::Lut3D exact = css::lut::bake([&](const Eigen::Vector3f& bgr) -> Eigen::Vector3f { return affine * bgr + offset; },
+                                                 17, css::transfer::TransferFunction{css::transfer::Curve::Linear});
+
+    css::profile::Profile prof;
+    prof.colorMatrix << 1.7f, -0.5f, -0.2f,
+                        -0.3f, 1.5f, -0.2f,
+                        0.05f, -0.45f, 1.4f;
+    prof.whiteBalance = Eigen::Vector3f(2.0f, 1.0f, 1.6f);
+    css::lut::BakeOptions options;
+    const css::lut::Lut3D baked = css::lut::bake(prof, options);
+    options.matrixInShaper = false;
+    const css::lut::Lut3D portable = css::lut::bake(prof, options);
+    const css::kernel::ColorTransform direct = css::kernel::makeTransform(prof, options.encoding);
+
+    const Isa best = css::kernel::detectIsa();
+    std::vector<float> scalar(3 * n);
+    css::lut::applyRow(baked, in.data(), scalar.data(), n, Isa::Scalar);
+    for (Isa isa = Isa::Scalar; isa <= best; isa = static_cast<Isa>(static_cast<int>(isa) + 1))
+    {
+        std::vector<float> out(3 * n);
+        css::lut::applyRow(exact, in.data(), out.data(), n, isa);
+        double maxErr = 0.0;
+        for (size_t i = 1; i < n; ++i)
+        {
+            Eigen::Vector3f p(in[3 * i], in[3 * i + 1], in[3 * i + 2]);
+            p = p.cwiseMax(0.0f).cwiseMin(1.0f);
+            const Eigen::Vector3f expected = affine * p + offset;
+            for (int c = 0; c < 3; ++c)
+                maxErr = std::max(maxErr, static_cast<double>(std::abs(out[3 * i + c] - expected[c])));
+        }
+        if (maxErr > 2e-6 || std::isnan(out[0]) || std::isnan(out[1]) || std::isnan(out[2]))
+        {
+            std::cerr << css::kernel::isaName(isa) << ": affine LUT off by " << maxErr << "\n";
+            return 1;
+        }
+
+        // Every ISA agrees with the scalar lookup. With the matrix in the
+        // shaper the grid holds only the curve, and 8-bit output stays within
+        // a code of the direct transform; with the matrix in the grid, clipped
+        // channels make the error local, but it stays small on average.
+        css::lut::applyRow(baked, in.data(), out.data(), n, isa);
+        for (size_t k = 0; k < out.size(); ++k)
+        {
+            if (std::abs(out[k] - scalar[k]) > 1e-5f)
+            {
+                std::cerr << css::kernel::isaName(isa) << ": LUT differs from the scalar path at " << k << "\n";
+                return 1;
+            }
+        }
+        std::vector<std::uint8_t> viaLut(3 * n), viaMatrix(3 * n);
+        css::lut::applyRow(baked, in.data(), viaLut.data(), n, isa);
+        css::kernel::applyRow(direct, in.data() + 3, viaMatrix.data() + 3, n - 1, isa);
+        int worst = 0;
+        for (size_t k = 3; k < viaLut.size(); ++k)
+        {
+            worst = std::max(worst, std::abs(static_cast<int>(viaLut[k]) - static_cast<int>(viaMatrix[k])));
+        }
+        css::lut::applyRow(portable, in.data(), viaLut.data(), n, isa);
+        double mean = 0.0;
+        for (size_t k = 3; k < viaLut.size(); ++k)
+        {
+            mean += std::abs(static_cast<int>(viaLut[k]) - static_cast<int>(viaMatrix[k]));
+        }
+        mean /= static_cast<double>(viaLut.size() - 3);
+        if (worst > 1 || mean > 1.0)
+        {
+            std::cerr << css::kernel::isaName(isa) << ": 33^3 sRGB LUT off by " << worst
+                      << " 8-bit codes (" << mean << " on average without the shaper matrix)\n";
+            return 1;
+        }
+    }
+
+    // .cube: header, a 4096-point shaper and 33^3 entries.
+    const std::string path = "lut3d_test.cube";
+    css::lut::writeCube(portable, path);
+    std::ifstream cube(path);
+    std::string line;
+    size_t entries = 0;
+    bool sized = false;
+    while (std::getline(cube, line))
+    {
+        float r, g, b;
+        if (std::sscanf(line.c_str(), "%f %f %f", &r, &g, &b) == 3) ++entries;
+        if (line == "LUT_3D_SIZE 33") sized = true;
+    }
+    cube.close();
+    std::remove(path.c_str());
+    if (!sized || entries != 4096 + 33 * 33 * 33)
+    {
+        std::cerr << ".cube file has " << entries << " entries\n";
+        return 1;
+    }
+
+    std::cout << "3D LUT test passed\n";
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "css/mapped_file.hpp"
+#include "css/priors.hpp"
+
+namespace
+{
+    bool throws(const std::function<void()>& f)
+    {
+        try
+        {
+            f();
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main()
+{
+    namespace fs = std::filesystem;
+
+    // Uneven shapes so a mixed-up offset or stride shows.
+    css::priors::CameraPriors priors;
+    priors.grid = css::spectral::SpectralGrid::range(380.0f, 780.0f, 5.0f);
+    const int n = priors.grid.count;
+    priors.basisR = Eigen::MatrixXf::Random(n, 3);
+    priors.basisG = Eigen::MatrixXf::Random(n, 4);
+    priors.basisB = Eigen::MatrixXf::Random(n, 5);
+    priors.reflectance = Eigen::MatrixXf::Random(n, 24).cwiseAbs();
+
+    const std::string path = "priors_binary_test.cspri";
+    css::priors::savePriorsBinary(path, priors);
+    if (!css::priors::isPriorsBinary(path))
+    {
+        std::cerr << "Saved file lacks the binary priors magic\n";
+        return 1;
+    }
+
+    {
+        const css::priors::MappedPriors mapped(path);
+        if (mapped.basisR() != priors.basisR || mapped.basisG() != priors.basisG ||
+            mapped.basisB() != priors.basisB || mapped.reflectance() != priors.reflectance)
+        {
+            std::cerr << "Mapped matrices differ from the saved priors\n";
+            return 1;
+        }
+        if (mapped.grid() != priors.grid)
+        {
+            std::cerr << "Mapped grid differs from the saved priors\n";
+            return 1;
+        }
+
+        // The header hash is FNV-1a 64 of the column-major payload.
+        std::vector<unsigned char> payload;
+        for (const Eigen::MatrixXf* m : {&priors.basisR, &priors.basisG, &priors.basisB, &priors.reflectance})
+        {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(m->data());
+            payload.insert(payload.end(), bytes, bytes + m->size() * sizeof(float));
+        }
+        if (mapped.contentHash() != css::io::fnv1a64(payload.data(), payload.size()))
+        {
+            std::cerr << "Content hash does not match the payload\n";
+            return 1;
+        }
+
+        // The view references the mapping itself.
+        const css::priors::PriorsView view(mapped);
+        if (view.basisG.data() != mapped.basisG().data() || view.grid != priors.grid)
+        {
+            std::cerr << "PriorsView copied the mapped priors\n";
+            return 1;
+        }
+    }
+
+    // A flipped payload byte fails the hash (but opens when not verifying).
+    const std::string corrupt = "priors_binary_test_corrupt.cspri";
+    fs::copy_file(path, corrupt, fs::copy_options::overwrite_existing);
+    {
+        std::fstream f(corrupt, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(64 + 100);
+        const char c = static_cast<char>(f.get());
+        f.seekp(64 + 100);
+        f.put(static_cast<char>(c ^ 0x10));
+    }
+    const bool flippedThrows = throws([&] { css::priors::MappedPriors p(corrupt); });
+    const bool flippedOpensUnverified = !throws([&] { css::priors::MappedPriors p(corrupt, false); });
+
+    // A file from a host of the other byte order (swapped mark) is rejected.
+    fs::copy_file(path, corrupt, fs::copy_options::overwrite_existing);
+    {
+        std::fstream f(corrupt, std::ios::in | std::ios::out | std::ios::binary);
+        char mark[4];
+        f.seekg(40); // byte-order mark, after magic and eight 32-bit fields
+        f.read(mark, sizeof(mark));
+        std::swap(mark[0], mark[3]);
+        std::swap(mark[1], mark[2]);
+        f.seekp(40);
+        f.write(mark, sizeof(mark));
+    }
+    const bool swappedThrows = throws([&] { css::priors::MappedPriors p(corrupt, false); });
+
+    // A truncated payload is rejected from the header alone.
+    fs::copy_file(path, corrupt, fs::copy_options::overwrite_existing);
+    fs::resize_file(corrupt, fs::file_size(path) - sizeof(float));
+    const bool truncatedThrows = throws([&] { css::priors::MappedPriors p(corrupt, false); });
+    fs::resize_file(corrupt, 32);
+    const bool headerTruncatedThrows = throws([&] { css::priors::MappedPriors p(corrupt, false); });
+
+    std::remove(path.c_str());
+    std::remove(corrupt.c_str());
+    if (!flippedThrows || !flippedOpensUnverified)
+    {
+        std::cerr << "Flipped payload byte: hash check did not behave as expected\n";
+        return 1;
+    }
+    if (!swappedThrows)
+    {
+        std::cerr << "Priors file with the other byte order was accepted\n";
+        return 1;
+    }
+    if (!truncatedThrows || !headerTruncatedThrows)
+    {
+        std::cerr << "Truncated priors file was accepted\n";
+        return 1;
+    }
+
+    std::cout << "Binary priors test passed\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "css/demosaic.hpp"
+#include "css/pipeline.hpp"
+
+int main()
+{
+    css::profile::Profile prof;
+    prof.colorMatrix << 1.7f, -0.5f, -0.2f,
+                        -0.3f, 1.5f, -0.2f,
+                        0.05f, -0.45f, 1.4f;
+    prof.whiteBalance = Eigen::Vector3f(2.0f, 1.0f, 1.6f);
+
+    // 12-bit RGGB mosaic over smooth gradients plus noise, sized so edge
+    // tiles are ragged in both directions.
+    css::io::RawMosaic mosaic;
+    mosaic.data.create(203, 301, CV_16UC1);
+    mosaic.bayerCode = cv::COLOR_BayerBG2BGR;
+    mosaic.black = 64.0f;
+    mosaic.whiteLevel = 4095.0f - 64.0f;
+    std::mt19937 rng(46);
+    std::uniform_int_distribution<int> noise(-40, 40);
+    for (int y = 0; y < mosaic.data.rows; ++y)
+    {
+        for (int x = 0; x < mosaic.data.cols; ++x)
+        {
+            const double v = 64.0 + 1600.0 * (1.0 + std::sin(0.05 * x + 0.02 * y * ((x + y) % 3)));
+            mosaic.data.at<std::uint16_t>(y, x) = static_cast<std::uint16_t>(std::clamp(v + noise(rng), 0.0, 4095.0));
+        }
+    }
+
+    // Full-frame reference: the steps of io::loadDngAsLinearRgb, then applyProfile.
+    cv::Mat linear = css::demosaic::demosaicImage(mosaic.data, css::demosaic::cfaFromBayerCode(mosaic.bayerCode),
+                                                  css::demosaic::Method::MalvarHeCutler, mosaic.black,
+                                                  1.0f / mosaic.whiteLevel);
+    cv::threshold(linear, linear, 1.0, 1.0, cv::THRESH_TRUNC);
+
+    const std::string path = "raw_render_test.tif";
+    for (bool fixedPoint : {false, true})
+    {
+        css::pipeline::ApplyOptions options;
+        options.depth = fixedPoint ? CV_8U : CV_16U;
+        options.tileBytes = 64 * 64 * 14; // 64-pixel tiles: many per image
+        const cv::Mat expected = css::pipeline::applyProfile(linear, prof, options);
+
+        css::pipeline::renderMosaicToTiff(mosaic, prof, path, options, fixedPoint);
+        const cv::Mat rendered = cv::imread(path, cv::IMREAD_UNCHANGED);
+        std::remove(path.c_str());
+
+        if (rendered.type() != expected.type() || rendered.size() != expected.size())
+        {
+            std::cerr << "Tiled TIFF has the wrong size or type\n";
+            return 1;
+        }
+
+        // Float rounding differs only in summation order; fixed point is
+        // within one 8-bit code.
+        cv::Mat diff;
+        cv::absdiff(rendered, expected, diff);
+        double maxDiff = 0.0;
+        cv::minMaxLoc(diff.reshape(1), nullptr, &maxDiff);
+        if (maxDiff > 1.0)
+        {
+            std::cerr << (fixedPoint ? "fixed-point" : "float") << " tiles differ from the full-frame path by "
+                      << maxDiff << " codes\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Raw render test passed\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include <Eigen/Dense>
+
+#include "css/illuminant.hpp"
+#include "css/render.hpp"
+
+int main()
+{
+    using css::spectral::SpectralGrid;
+
+    const SpectralGrid grid = SpectralGrid::standard();
+
+    // Smooth Gaussian CSS peaking at 600 / 540 / 460nm.
+    Eigen::MatrixXf cssCurves(grid.count, 3);
+    const float peaks[3] = {600.0f, 540.0f, 460.0f};
+    for (int i = 0; i < grid.count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            float t = (grid.wavelength(i) - peaks[c]) / 40.0f;
+            cssCurves(i, c) = std::exp(-0.5f * t * t);
+        }
+    }
+
+    auto cie = css::illuminant::cieStandardSet(grid);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    const int n = 5000; // spans several column blocks
+    Eigen::MatrixXf refl(grid.count, n);
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < grid.count; ++i)
+        {
+            refl(i, j) = uni(rng);
+        }
+    }
+
+    css::render::SpectralRenderer renderer(cssCurves, cie.spectra, grid);
+    Eigen::MatrixXf rgb = renderer.render(refl);
+
+    // Reference: explicit triple product per illuminant / reflectance / channel.
+    float maxErr = 0.0f;
+    for (Eigen::Index l = 0; l < cie.spectra.cols(); ++l)
+    {
+        for (int j = 0; j < n; j += 97)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                double sum = 0.0;
+                for (int i = 0; i < grid.count; ++i)
+                {
+                    sum += static_cast<double>(cssCurves(i, c)) * cie.spectra(i, l) * refl(i, j) * grid.step;
+                }
+                float err = static_cast<float>(std::abs(rgb(3 * l + c, j) - sum) / std::max(1.0, std::abs(sum)));
+                maxErr = std::max(maxErr, err);
+            }
+        }
+    }
+    if (maxErr > 1e-4f)
+    {
+        std::cerr << "Blocked render differs from the triple product: " << maxErr << "\n";
+        return 1;
+    }
+
+    // Normalized rendering: a perfect reflector has G = 1 under every illuminant.
+    css::render::SpectralRenderer normalized(cssCurves, cie.spectra, grid, true);
+    Eigen::MatrixXf white = normalized.render(Eigen::MatrixXf::Ones(grid.count, 1));
+    for (int l = 0; l < normalized.numIlluminants(); ++l)
+    {
+        if (std::abs(white(3 * l + 1, 0) - 1.0f) > 1e-5f)
+        {
+            std::cerr << "White is not normalized under illuminant " << l << "\n";
+            return 1;
+        }
+    }
+
+    // Streaming from a 5nm CSV gives the same RGB as rendering the resampled block.
+    const std::string path = "render_test_spectra.csv";
+    const SpectralGrid fine = SpectralGrid::range(380.0f, 780.0f, 5.0f);
+    {
+        std::ofstream out(path);
+        out << "name";
+        for (int i = 0; i < fine.count; ++i) out << "," << fine.wavelength(i);
+        out << "\n";
+        for (int j = 0; j < 300; ++j)
+        {
+            out << "s" << j;
+            for (int i = 0; i < fine.count; ++i)
+            {
+                out << "," << 0.5f + 0.4f * std::sin(0.01f * (j + 1) * fine.wavelength(i));
+            }
+            out << "\n";
+        }
+    }
+
+    std::vector<std::string> names;
+    Eigen::MatrixXf all = css::render::loadReflectanceCsv(path, grid, &names);
+    Eigen::MatrixXf expected = renderer.render(all);
+
+    css::render::ReflectanceReader reader(path, grid);
+    Eigen::Index col = 0;
+    float streamErr = 0.0f;
+    size_t count = css::render::renderStream(reader, renderer,
+        [&](const std::vector<std::string>& blockNames, const Eigen::MatrixXf& block) {
+            for (Eigen::Index j = 0; j < block.cols(); ++j, ++col)
+            {
+                if (blockNames[j] != names[col]) streamErr = 1e9f;
+                streamErr = std::max(streamErr, (block.col(j) - expected.col(col)).cwiseAbs().maxCoeff());
+            }
+        },
+        64);
+    std::remove(path.c_str());
+
+    if (count != 300 || names.size() != 300 || streamErr > 1e-4f)
+    {
+        std::cerr << "Streamed render mismatch: count " << count << ", err " << streamErr << "\n";
+        return 1;
+    }
+
+    std::cout << "Render test passed (max rel err " << maxErr << ")\n";
+    return 0;
+}
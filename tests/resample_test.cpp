@@ -0,0 +1,94 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <Eigen/Core>
+
+#include "css/resample.hpp"
+
+int main()
+{
+    using css::spectral::ResampleMethod;
+    using css::spectral::SpectralGrid;
+
+    // Sprague interpolation is exact for quartics wherever its six-point
+    // window (p[i-2] .. p[i+3]) stays inside the source samples.
+    const SpectralGrid coarse = SpectralGrid::standard();
+    const SpectralGrid fine = SpectralGrid::range(400.0f, 720.0f, 1.0f);
+    auto quartic = [](float nm) {
+        const double x = (nm - 560.0) / 160.0;
+        return static_cast<float>(1.0 + 0.5 * x - 2.0 * x * x + 0.7 * x * x * x + 1.1 * x * x * x * x);
+    };
+
+    Eigen::VectorXf samples(coarse.count);
+    for (int i = 0; i < coarse.count; ++i)
+    {
+        samples[i] = quartic(coarse.wavelength(i));
+    }
+    const Eigen::MatrixXf sprague = css::spectral::resample(samples, coarse, fine, ResampleMethod::Sprague);
+    const float interiorFirst = coarse.wavelength(2);
+    const float interiorLast = coarse.wavelength(coarse.count - 3);
+    for (int i = 0; i < fine.count; ++i)
+    {
+        const float nm = fine.wavelength(i);
+        if (nm < interiorFirst || nm > interiorLast)
+            continue;
+        if (std::abs(sprague(i, 0) - quartic(nm)) > 1e-5f)
+        {
+            std::cerr << "Sprague misses the quartic at " << nm << "nm: " << sprague(i, 0) << " vs " << quartic(nm)
+                      << "\n";
+            return 1;
+        }
+    }
+
+    // Rebinning 1nm -> 10nm keeps the integral of the (linear) spectrum over
+    // the bins it covers: 390-770nm bins span [385, 775].
+    const SpectralGrid source = SpectralGrid::range(380.0f, 780.0f, 1.0f);
+    const SpectralGrid binned = SpectralGrid::range(390.0f, 770.0f, 10.0f);
+    std::mt19937 rng(33);
+    std::uniform_real_distribution<float> uni(0.0f, 2.0f);
+    Eigen::MatrixXf spiky(source.count, 3);
+    for (int i = 0; i < spiky.size(); ++i)
+    {
+        spiky.data()[i] = uni(rng);
+    }
+    const Eigen::MatrixXf rebinned = css::spectral::resample(spiky, source, binned, ResampleMethod::Rebin);
+    const int first = static_cast<int>(std::lround(385.0f - source.start));
+    const int last = static_cast<int>(std::lround(775.0f - source.start));
+    for (int c = 0; c < spiky.cols(); ++c)
+    {
+        // Trapezoid rule over [385, 775] at the source step.
+        double integral = 0.0;
+        for (int i = first; i < last; ++i)
+        {
+            integral += 0.5 * (spiky(i, c) + spiky(i + 1, c)) * source.step;
+        }
+        const double rebinnedIntegral = rebinned.col(c).cast<double>().sum() * binned.step;
+        if (std::abs(rebinnedIntegral - integral) > 1e-4 * integral)
+        {
+            std::cerr << "Rebinning changes the integral: " << rebinnedIntegral << " vs " << integral << "\n";
+            return 1;
+        }
+    }
+
+    // Equal grids: the interpolating operators are the identity and the
+    // helper copies through (an explicit Rebin still averages over each bin).
+    for (ResampleMethod method : {ResampleMethod::Auto, ResampleMethod::Linear, ResampleMethod::Sprague})
+    {
+        const css::spectral::Resampler same(coarse, coarse, method);
+        if (!same.matrix().isIdentity(1e-6f))
+        {
+            std::cerr << "Resampler on equal grids is not the identity (method " << static_cast<int>(method)
+                      << ")\n";
+            return 1;
+        }
+    }
+    if (css::spectral::resample(spiky, source, source) != spiky)
+    {
+        std::cerr << "resample() on equal grids changed the spectra\n";
+        return 1;
+    }
+
+    std::cout << "Resample test passed\n";
+    return 0;
+}
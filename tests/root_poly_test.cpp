@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "css/calib.hpp"
+#include "css/color_kernel.hpp"
+#include "css/profile.hpp"
+
+namespace
+{
+    using css::profile::Model;
+
+    // profile::rootTerms in double.
+    Eigen::Matrix<double, css::profile::kMaxRootTerms, 1> termsDouble(const Eigen::Vector3d& rgb, Model model)
+    {
+        Eigen::Matrix<double, css::profile::kMaxRootTerms, 1> t = Eigen::Matrix<double, css::profile::kMaxRootTerms, 1>::Zero();
+        const double r = std::max(rgb[0], 0.0), g = std::max(rgb[1], 0.0), b = std::max(rgb[2], 0.0);
+        t[0] = std::sqrt(r * g);
+        t[1] = std::sqrt(g * b);
+        t[2] = std::sqrt(r * b);
+        if (model == Model::RootPoly3)
+        {
+            t[3] = std::cbrt(r * g * g);
+            t[4] = std::cbrt(g * b * b);
+            t[5] = std::cbrt(r * b * b);
+            t[6] = std::cbrt(g * r * r);
+            t[7] = std::cbrt(b * g * g);
+            t[8] = std::cbrt(b * r * r);
+            t[9] = std::cbrt(r * g * b);
+        }
+        return t;
+    }
+
+    Eigen::Vector3d evaluate(const css::profile::Profile& prof, const Eigen::Vector3d& camera)
+    {
+        const Eigen::Vector3d c = camera.cwiseProduct(prof.whiteBalance.cast<double>());
+        return prof.colorMatrix.cast<double>() * c + prof.rootMatrix.cast<double>() * termsDouble(c, prof.model);
+    }
+} // namespace
+
+int main()
+{
+    using css::kernel::Isa;
+
+    // A camera that a 3x3 cannot invert: the target holds cross terms.
+    css::profile::Profile truth;
+    truth.model = Model::RootPoly3;
+    truth.colorMatrix << 1.4f, -0.3f, -0.1f,
+                         -0.2f, 1.3f, -0.1f,
+                         0.0f, -0.3f, 1.2f;
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<float> coef(-0.25f, 0.25f);
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < css::profile::kMaxRootTerms; ++c)
+            truth.rootMatrix(r, c) = coef(rng);
+
+    std::uniform_real_distribution<float> patch(0.02f, 1.0f);
+    std::vector<Eigen::Vector3f> measured, reference;
+    for (int i = 0; i < 60; ++i)
+    {
+        const Eigen::Vector3f c(patch(rng), patch(rng), patch(rng));
+        measured.push_back(c);
+        reference.push_back(evaluate(truth, c.cast<double>()).cast<float>());
+    }
+
+    // Each order fits better; the 3x13 fit recovers the model.
+    float previous = 1e30f;
+    for (Model model : {Model::Linear, Model::RootPoly2, Model::RootPoly3})
+    {
+        const auto res = css::calib::solveColorMatrix(measured, reference, false, 1e-7f, model);
+        std::cout << css::profile::modelName(model) << " rms " << res.rmsError << "\n";
+        if (res.model != model || !(res.rmsError < previous))
+        {
+            std::cerr << css::profile::modelName(model) << " does not improve the fit\n";
+            return 1;
+        }
+        previous = res.rmsError;
+        if (model == Model::RootPoly3 && (res.rmsError > 1e-4f || (res.rootMatrix - truth.rootMatrix).norm() > 1e-2f))
+        {
+            std::cerr << "rp3 fit misses the generating model\n";
+            return 1;
+        }
+    }
+
+    // Profiles keep the model through save / load.
+    truth.whiteBalance = Eigen::Vector3f(1.9f, 1.0f, 1.5f);
+    const char* path = "root_poly_test_profile.txt";
+    css::profile::saveProfile(path, truth);
+    const auto loaded = css::profile::loadProfile(path);
+    std::remove(path);
+    if (loaded.model != truth.model || (loaded.rootMatrix - truth.rootMatrix).norm() > 1e-5f)
+    {
+        std::cerr << "Root-polynomial coefficients lost in the profile file\n";
+        return 1;
+    }
+
+    // Kernels, per order and ISA, against the double-precision model.
+    std::uniform_real_distribution<float> uni(-0.05f, 0.6f);
+    const size_t n = 2000 + 13;
+    std::vector<float> in(3 * n);
+    for (float& v : in) v = uni(rng);
+
+    const Isa best = css::kernel::detectIsa();
+    for (Model model : {Model::RootPoly2, Model::RootPoly3})
+    {
+        css::profile::Profile prof = truth;
+        prof.model = model;
+        if (model == Model::RootPoly2)
+            prof.rootMatrix.rightCols(css::profile::kMaxRootTerms - 3).setZero();
+
+        for (const char* name : {"linear", "srgb"})
+        {
+            const auto tf = css::transfer::parseTransfer(name);
+            const auto t = css::kernel::makeTransform(prof, tf);
+
+            std::vector<double> expected(3 * n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Eigen::Vector3d tgt = evaluate(prof, Eigen::Vector3d(in[3 * i + 2], in[3 * i + 1], in[3 * i]));
+                for (int c = 0; c < 3; ++c)
+                    expected[3 * i + c] = css::transfer::encodeReference(tf, tgt[2 - c]);
+            }
+
+            for (Isa isa : {Isa::Scalar, Isa::SSE42, Isa::AVX2, Isa::AVX512})
+            {
+                if (isa > best)
+                    continue;
+
+                std::vector<float> full(3 * n);
+                css::kernel::applyRow(t, in.data(), full.data(), n, isa);
+                double maxErr = 0.0;
+                for (size_t i = 0; i < 3 * n; ++i)
+                    maxErr = std::max(maxErr, std::abs(full[i] - expected[i]) / std::max(1.0, std::abs(expected[i])));
+                if (maxErr > 4e-6)
+                {
+                    std::cerr << css::kernel::isaName(isa) << " " << css::profile::modelName(model) << " " << name
+                              << " error " << maxErr << "\n";
+                    return 1;
+                }
+
+                for (size_t count = 0; count <= 40; ++count)
+                {
+                    std::vector<float> part(in.begin(), in.begin() + 3 * count);
+                    css::kernel::applyRow(t, part.data(), part.data(), count, isa);
+                    if (!std::equal(part.begin(), part.end(), full.begin()))
+                    {
+                        std::cerr << css::kernel::isaName(isa) << " " << css::profile::modelName(model)
+                                  << ": row of " << count << " differs from the full-row result\n";
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Root-polynomial test passed\n";
+    return 0;
+}
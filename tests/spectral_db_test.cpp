@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "css/spectral_db.hpp"
+
+namespace
+{
+    bool throws(const std::function<void()>& f)
+    {
+        try
+        {
+            f();
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main()
+{
+    using css::spectral::Dataset;
+    using css::spectral::DatasetKind;
+    using css::spectral::SpectralDatabase;
+    using css::spectral::SpectralGrid;
+
+    // Three datasets on two grids; item names out of order so the sorted index matters.
+    Dataset cameras;
+    cameras.name = "cameras";
+    cameras.kind = DatasetKind::Sensitivity;
+    cameras.channels = 3;
+    cameras.items = {"Sony A7", "Canon 5D", "Nikon D850", "Fuji X-T3"};
+    cameras.data = Eigen::MatrixXf::Random(cameras.grid.count, 12);
+
+    Dataset patches;
+    patches.name = "patches";
+    patches.kind = DatasetKind::Reflectance;
+    patches.grid = SpectralGrid::range(380.0f, 780.0f, 5.0f);
+    for (int i = 0; i < 30; ++i)
+    {
+        patches.items.push_back("patch " + std::to_string(29 - i));
+    }
+    patches.data = Eigen::MatrixXf::Random(patches.grid.count, 30).cwiseAbs();
+
+    Dataset lamps;
+    lamps.name = "lamps";
+    lamps.kind = DatasetKind::Illuminant;
+    lamps.items = {"F11", "A"};
+    lamps.data = Eigen::MatrixXf::Random(lamps.grid.count, 2).cwiseAbs();
+
+    const std::vector<Dataset> datasets = {cameras, patches, lamps};
+    const std::string path = "spectral_db_test.csdb";
+    css::spectral::saveSpectralDatabase(path, datasets);
+
+    {
+        const SpectralDatabase db(path, true);
+        if (db.size() != datasets.size())
+        {
+            std::cerr << "Expected " << datasets.size() << " datasets, got " << db.size() << "\n";
+            return 1;
+        }
+        for (size_t d = 0; d < datasets.size(); ++d)
+        {
+            const Dataset& ds = datasets[d];
+            const auto view = db.dataset(ds.name);
+            if (view.kind() != ds.kind || view.grid() != ds.grid || view.channels() != ds.channels ||
+                view.size() != static_cast<Eigen::Index>(ds.items.size()) || view.matrix() != ds.data)
+            {
+                std::cerr << "Dataset " << ds.name << " did not round-trip\n";
+                return 1;
+            }
+            for (size_t i = 0; i < ds.items.size(); ++i)
+            {
+                const auto index = static_cast<Eigen::Index>(i);
+                if (view.itemName(index) != ds.items[i] || view.find(ds.items[i]) != index ||
+                    view.item(index) != ds.data.middleCols(index * ds.channels, ds.channels))
+                {
+                    std::cerr << "Item " << ds.items[i] << " of " << ds.name << " did not round-trip\n";
+                    return 1;
+                }
+            }
+            if (view.find("missing") != -1 || view.find("") != -1)
+            {
+                std::cerr << "find() matched an absent item in " << ds.name << "\n";
+                return 1;
+            }
+        }
+
+        SpectralGrid grid;
+        if (db.camera("Nikon D850", &grid) != cameras.data.middleCols(6, 3) || grid != cameras.grid ||
+            !throws([&] { db.camera("F11"); }))
+        {
+            std::cerr << "camera() lookup failed\n";
+            return 1;
+        }
+        if (db.first(DatasetKind::Illuminant).name() != "lamps" || db.hasDataset("missing"))
+        {
+            std::cerr << "Dataset lookup by kind or name failed\n";
+            return 1;
+        }
+    }
+
+    // Duplicate dataset or item names are rejected on save.
+    Dataset twin = lamps;
+    Dataset dupItems = lamps;
+    dupItems.name = "dup";
+    dupItems.items = {"A", "A"};
+    if (!throws([&] { css::spectral::saveSpectralDatabase(path, {cameras, twin, lamps}); }) ||
+        !throws([&] { css::spectral::saveSpectralDatabase(path, {dupItems}); }))
+    {
+        std::cerr << "Duplicate names were accepted\n";
+        return 1;
+    }
+
+    // An out-of-range sorted id is caught on open, without hashing the file.
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint64_t sortedOffset = 0;
+        f.seekg(64 + 120); // first directory entry, sortedOffset
+        f.read(reinterpret_cast<char*>(&sortedOffset), sizeof(sortedOffset));
+        const std::uint32_t bad = 1000;
+        f.seekp(static_cast<std::streamoff>(sortedOffset));
+        f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+    }
+    const bool corruptThrows = throws([&] { SpectralDatabase db(path); });
+    std::remove(path.c_str());
+    if (!corruptThrows)
+    {
+        std::cerr << "Corrupt sorted index was accepted\n";
+        return 1;
+    }
+
+    std::cout << "Spectral database test passed\n";
+    return 0;
+}
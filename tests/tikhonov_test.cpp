@@ -0,0 +1,102 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <Eigen/Dense>
+
+#include "css/tikhonov.hpp"
+
+int main()
+{
+    using css::tikhonov::LambdaSelection;
+    using css::tikhonov::TikhonovPath;
+
+    // Ill-conditioned 24 x 6 system: columns are nearly collinear smooth bumps.
+    const int n = 24;
+    const int k = 6;
+    Eigen::MatrixXf A(n, k);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < k; ++j)
+        {
+            float t = static_cast<float>(i) / (n - 1) - 0.5f - 0.02f * j;
+            A(i, j) = std::exp(-t * t / 0.08f);
+        }
+    }
+
+    Eigen::VectorXf xTrue(k);
+    xTrue << 1.0f, 0.5f, -0.3f, 0.8f, 0.2f, -0.6f;
+
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 1e-3f);
+    Eigen::VectorXf b = A * xTrue;
+    for (int i = 0; i < n; ++i)
+    {
+        b[i] += noise(rng);
+    }
+
+    TikhonovPath path(A);
+    auto proj = path.project(b);
+
+    // Path solution must match the normal equations at a fixed lambda.
+    const float lambda = 1e-3f;
+    Eigen::MatrixXf AtA = A.transpose() * A;
+    AtA.diagonal().array() += lambda;
+    Eigen::VectorXf xRef = AtA.ldlt().solve(A.transpose() * b);
+    Eigen::VectorXf xPath = path.solve(proj, lambda);
+    if ((xPath - xRef).norm() > 1e-3f * xRef.norm())
+    {
+        std::cerr << "Path solve differs from normal equations: " << (xPath - xRef).norm() << std::endl;
+        return 1;
+    }
+
+    float rRef = (A * xRef - b).squaredNorm();
+    if (std::abs(path.residual(proj, lambda) - rRef) > 1e-3f * rRef + 1e-7f)
+    {
+        std::cerr << "Closed-form residual mismatch: " << path.residual(proj, lambda) << " vs " << rRef << std::endl;
+        return 1;
+    }
+
+    // Automatic selection must pick a positive lambda with a finite GCV score.
+    for (LambdaSelection method : {LambdaSelection::GCV, LambdaSelection::LCurve})
+    {
+        float chosen = path.selectLambda(proj, method);
+        if (!(chosen > 0.0f) || !std::isfinite(path.gcv(proj, chosen)))
+        {
+            std::cerr << "Invalid automatic lambda: " << chosen << std::endl;
+            return 1;
+        }
+    }
+
+    float gcvLambda = path.selectLambda(proj, LambdaSelection::GCV);
+    const float s0 = path.singularValues()[0];
+    for (float t : {1e-8f, 1e-4f, 1.0f})
+    {
+        if (path.gcv(proj, gcvLambda) > path.gcv(proj, t * s0 * s0) * 1.0001f)
+        {
+            std::cerr << "GCV selection is not a minimum (lambda " << gcvLambda << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    // The path built from the normal equations alone scores and solves alike.
+    const Eigen::MatrixXd Ad = A.cast<double>();
+    const Eigen::VectorXd bd = b.cast<double>();
+    TikhonovPath::Projection normalProj;
+    const TikhonovPath normal = TikhonovPath::fromNormalEquations(Ad.transpose() * Ad, Ad.transpose() * bd,
+                                                                  bd.squaredNorm(), n, normalProj);
+    for (float t : {1e-6f, 1e-4f, 1e-2f})
+    {
+        const float l = t * s0 * s0;
+        const float g = path.gcv(proj, l);
+        if (std::abs(normal.gcv(normalProj, l) - g) > 1e-2f * g ||
+            (normal.solve(normalProj, l) - path.solve(proj, l)).norm() > 1e-2f * xRef.norm())
+        {
+            std::cerr << "Normal-equation path differs at lambda " << l << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "tikhonov_test passed\n";
+    return 0;
+}